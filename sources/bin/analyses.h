@@ -0,0 +1,25 @@
+#ifndef ANALYSES_H
+#define ANALYSES_H
+
+#include <TString.h>
+
+// Analyses of a single experimental series. Each of them is the body of
+// the corresponding executable (e.g. run_attenuation() for ./attenuation)
+// and can be also called in batch mode by ./sfbatch. Functions return 0
+// on success.
+
+int run_data(int seriesNo, TString outdir, TString dbase);
+int run_attenuation(int seriesNo, TString outdir, TString dbase);
+int run_timeres(int seriesNo, TString outdir, TString dbase);
+int run_tconst(int seriesNo, TString outdir, TString dbase);
+int run_lightout(int seriesNo, TString outdir, TString dbase);
+int run_energyres(int seriesNo, TString outdir, TString dbase);
+int run_posres(int seriesNo, TString outdir, TString dbase);
+int run_model(int seriesNo, TString outdir, TString dbase);
+int run_energyreco(int seriesNo, TString outdir, TString dbase);
+int run_posreco(int seriesNo, TString outdir, TString dbase);
+int run_peakfin(int seriesNo, TString outdir, TString dbase);
+int run_stability(int seriesNo, TString outdir, TString dbase);
+int run_temp(int seriesNo, TString outdir, TString dbase);
+
+#endif /* ANALYSES_H */
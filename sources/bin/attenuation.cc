@@ -10,6 +10,8 @@
 
 #include "SFAttenuation.hh"
 #include "SFData.hh"
+#include "SFResultsSink.hh"
+#include "analyses.h"
 #include "common_options.h"
 
 //#include <DistributionContext.h>
@@ -20,22 +22,8 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
-int main(int argc, char** argv)
+int run_attenuation(int seriesNo, TString outdir, TString dbase)
 {
-    TString outdir;
-    TString dbase;
-    int     seriesNo = -1;
-
-    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
-    if (ret != 0) exit(ret);
-
-    if (argc < 2)
-    {
-        std::cout << "to run type: ./attenuation seriesNo";
-        std::cout << "-out path/to/output -db database" << std::endl;
-        return 1;
-    }
-
     SFData* data;
     try
     {
@@ -398,53 +386,56 @@ int main(int argc, char** argv)
 
     //----- writing results to the data base
     TString table = "ATTENUATION_LENGTH";
-    TString query = Form("INSERT OR REPLACE INTO %s (SERIES_ID, RESULTS_FILE, ATT_CH0, "
-                         "ATT_CH0_ERR, CHI2NDF_CH0, ATT_CH1, ATT_CH1_ERR, CHI2NDF_CH1, "
-                         "ATT_COMB, ATT_COMB_ERR, CHI2NDF_COMB, ATT_COMB_POL3, ATT_COMB_POL3_ERR, "
-                         "CHI2NDF_POL3, ATT_SIM, ATT_SIM_ERR, CHI2NDF_SIM) VALUES "
-                         "(%i, '%s', %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, "
-                         "%f, %f, %f)", table.Data(), seriesNo, fname_full.Data(), 
-                         results[0]->GetValue(SFResultTypeNum::kLambda),
-                         results[0]->GetUncertainty(SFResultTypeNum::kLambda), 
-                         results[0]->GetValue(SFResultTypeNum::kChi2NDF),
-                         results[1]->GetValue(SFResultTypeNum::kLambda),
-                         results[1]->GetUncertainty(SFResultTypeNum::kLambda),
-                         results[1]->GetValue(SFResultTypeNum::kChi2NDF),
-                         results[2]->GetValue(SFResultTypeNum::kLambda),
-                         results[2]->GetUncertainty(SFResultTypeNum::kLambda),
-                         results[2]->GetValue(SFResultTypeNum::kChi2NDF),
-                         results[3]->GetValue(SFResultTypeNum::kLambda),
-                         results[3]->GetValue(SFResultTypeNum::kLambda),
-                         results[3]->GetValue(SFResultTypeNum::kChi2NDF),
-                         results[4]->GetValue(SFResultTypeNum::kLambda),
-                         results[4]->GetUncertainty(SFResultTypeNum::kLambda),
-                         results[4]->GetValue(SFResultTypeNum::kChi2NDF));
-     
-
-    const int max_tries = 20;
-    int       i_try     = max_tries;
-    float     wait      = 0;
-    bool      stat      = false;
-
-    srand(time(NULL));
-
-    do
+    std::vector<std::pair<TString, double>> values = {
+        {"ATT_CH0", results[0]->GetValue(SFResultTypeNum::kLambda)},
+        {"ATT_CH0_ERR", results[0]->GetUncertainty(SFResultTypeNum::kLambda)},
+        {"CHI2NDF_CH0", results[0]->GetValue(SFResultTypeNum::kChi2NDF)},
+        {"ATT_CH1", results[1]->GetValue(SFResultTypeNum::kLambda)},
+        {"ATT_CH1_ERR", results[1]->GetUncertainty(SFResultTypeNum::kLambda)},
+        {"CHI2NDF_CH1", results[1]->GetValue(SFResultTypeNum::kChi2NDF)},
+        {"ATT_COMB", results[2]->GetValue(SFResultTypeNum::kLambda)},
+        {"ATT_COMB_ERR", results[2]->GetUncertainty(SFResultTypeNum::kLambda)},
+        {"CHI2NDF_COMB", results[2]->GetValue(SFResultTypeNum::kChi2NDF)},
+        {"ATT_COMB_POL3", results[3]->GetValue(SFResultTypeNum::kLambda)},
+        {"ATT_COMB_POL3_ERR", results[3]->GetValue(SFResultTypeNum::kLambda)},
+        {"CHI2NDF_POL3", results[3]->GetValue(SFResultTypeNum::kChi2NDF)},
+        {"ATT_SIM", results[4]->GetValue(SFResultTypeNum::kLambda)},
+        {"ATT_SIM_ERR", results[4]->GetUncertainty(SFResultTypeNum::kLambda)},
+        {"CHI2NDF_SIM", results[4]->GetValue(SFResultTypeNum::kChi2NDF)}};
+
+    std::cout << "----- attenuation writing..." << std::endl;
+    SFResultsSink* sink = SFResultsSink::Open(dbname_full);
+    bool           stat = (sink != nullptr) && sink->Save(table, seriesNo, fname_full, values);
+
+    if (!stat)
     {
-        std::cout << "----- attenuation writing, try number " << (max_tries - i_try) + 1
+        std::cerr << "##### Error in attenuation.cc! Results not saved in the data base!"
                   << std::endl;
-        stat = SFTools::SaveResultsDB(dbname_full, table, query, seriesNo);
-
-        if (stat) break;
-
-        --i_try;
-        wait = rand() % 10 + 1;
-        std::cout << "----- attenuation writing, database locked..." << std::endl;
-        std::cout << "----- waiting " << wait << " s" << std::endl;
-        sleep(wait);
-    } while (i_try > 0);
+    }
 
     delete data;
     delete att;
 
     return 0;
 }
+
+#ifndef SF_BATCH
+int main(int argc, char** argv)
+{
+    TString outdir;
+    TString dbase;
+    int     seriesNo = -1;
+
+    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
+    if (ret != 0) exit(ret);
+
+    if (argc < 2)
+    {
+        std::cout << "to run type: ./attenuation seriesNo";
+        std::cout << "-out path/to/output -db database" << std::endl;
+        return 1;
+    }
+
+    return run_attenuation(seriesNo, outdir, dbase);
+}
+#endif /* SF_BATCH */
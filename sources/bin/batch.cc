@@ -0,0 +1,350 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *               batch.cc                *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#include "SFFitParamStore.hh"
+#include "SFHistCache.hh"
+#include "SFPeakFinder.hh"
+#include "SFPrefetcher.hh"
+#include "SFSeriesContext.hh"
+#include "SFTools.hh"
+#include "analyses.h"
+#include "common_options.h"
+
+#include <TObjArray.h>
+#include <TObjString.h>
+#include <TROOT.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <map>
+#include <utility>
+#include <vector>
+
+typedef int (*AnalysisFun)(int seriesNo, TString outdir, TString dbase);
+
+// analyses available in batch mode, in the order in which they are executed
+static const std::vector<std::pair<TString, AnalysisFun>> gAnalyses = {
+    {"data", run_data},
+    {"attenuation", run_attenuation},
+    {"timeres", run_timeres},
+    {"tconst", run_tconst},
+    {"lightout", run_lightout},
+    {"energyres", run_energyres},
+    {"posres", run_posres},
+    {"model", run_model},
+    {"energyreco", run_energyreco},
+    {"posreco", run_posreco},
+    {"peakfin", run_peakfin},
+    {"stability", run_stability},
+    {"temp", run_temp}};
+
+// parses list of series, e.g. "1,3,10-15"
+bool parse_series(TString list, std::vector<int>& series)
+{
+    TObjArray* tokens = list.Tokenize(",");
+    bool       stat   = true;
+
+    for (int i = 0; i < tokens->GetEntries(); i++)
+    {
+        TString token = ((TObjString*)tokens->At(i))->GetString();
+        int     dash  = token.Index("-");
+
+        if (dash > 0)
+        {
+            TString first = token(0, dash);
+            TString last  = token(dash + 1, token.Length() - dash - 1);
+
+            if (!first.IsDigit() || !last.IsDigit() || first.Atoi() > last.Atoi())
+            {
+                std::cerr << "##### Error in batch.cc! Incorrect range of series: " << token
+                          << std::endl;
+                stat = false;
+                break;
+            }
+
+            for (int s = first.Atoi(); s <= last.Atoi(); s++)
+                series.push_back(s);
+        }
+        else
+        {
+            if (!token.IsDigit())
+            {
+                std::cerr << "##### Error in batch.cc! Incorrect series number: " << token
+                          << std::endl;
+                stat = false;
+                break;
+            }
+
+            series.push_back(token.Atoi());
+        }
+    }
+
+    delete tokens;
+
+    return stat && !series.empty();
+}
+
+// parses list of analyses, e.g. "attenuation,energyres"; analyses are
+// returned in the order in which they are executed
+bool parse_analyses(TString list, std::vector<std::pair<TString, AnalysisFun>>& analyses)
+{
+    if (list == "all")
+    {
+        analyses = gAnalyses;
+        return true;
+    }
+
+    TObjArray* tokens = list.Tokenize(",");
+    bool       stat   = true;
+
+    for (int i = 0; i < tokens->GetEntries(); i++)
+    {
+        TString token = ((TObjString*)tokens->At(i))->GetString();
+        bool    found = false;
+
+        for (auto& ana : gAnalyses)
+        {
+            if (ana.first == token)
+            {
+                found = true;
+                break;
+            }
+        }
+
+        if (!found)
+        {
+            std::cerr << "##### Error in batch.cc! Unknown analysis: " << token << std::endl;
+            stat = false;
+        }
+    }
+
+    for (auto& ana : gAnalyses)
+    {
+        for (int i = 0; i < tokens->GetEntries(); i++)
+        {
+            if (((TObjString*)tokens->At(i))->GetString() == ana.first)
+            {
+                analyses.push_back(ana);
+                break;
+            }
+        }
+    }
+
+    delete tokens;
+
+    return stat && !analyses.empty();
+}
+
+// runs all requested analyses of a single series; the context of the series
+// is kept for all of them, so that data base entries, files, spectra and fits
+// are shared between the analyses. Returns number of failed analyses.
+int run_series(int seriesNo, const std::vector<std::pair<TString, AnalysisFun>>& analyses,
+               TString outdir, TString dbase)
+{
+    SFSeriesContext* context = nullptr;
+
+    try
+    {
+        context = SFSeriesContext::Acquire(seriesNo);
+    }
+    catch (const char* message)
+    {
+        std::cerr << message << std::endl;
+        std::cerr << "##### Exception in batch.cc! Series " << seriesNo << " skipped!"
+                  << std::endl;
+        return analyses.size();
+    }
+
+    int nfailed = 0;
+
+    for (auto& ana : analyses)
+    {
+        std::cout << "\n----- batch: series " << seriesNo << ", analysis " << ana.first
+                  << std::endl;
+
+        int ret = ana.second(seriesNo, outdir, dbase);
+
+        if (ret != 0)
+        {
+            std::cerr << "##### Error in batch.cc! Analysis " << ana.first << " of series "
+                      << seriesNo << " failed!" << std::endl;
+            nfailed++;
+        }
+
+        // fitted parameters are written once per analysis, so that they are
+        // not lost if one of the next analyses aborts
+        SFFitParamStore::Flush();
+
+        // canvases have the same names in all series, they are already saved
+        gROOT->GetListOfCanvases()->Delete();
+    }
+
+    context->Release();
+
+    return nfailed;
+}
+
+int main(int argc, char** argv)
+{
+    gROOT->SetBatch(true);
+
+    TString path = std::string("./");
+
+    CmdLineOption cmd_outdir("Output directory", "-out", "Output directory (string), default: ./", path);
+
+    CmdLineOption cmd_dbase("Database", "-db", "Data base name (string), default: ScintFibRes.db", "ScintFibRes.db");
+
+    CmdLineOption cmd_threads("Threads", "-threads", "Number of threads per series (int), 0 - all available, default: 1", "1");
+
+    CmdLineOption cmd_jobs("Jobs", "-jobs", "Number of series processed simultaneously (int), default: 1", "1");
+
+    CmdLineOption cmd_series("Series", "-series", "List of series (string), e.g. 1,3,10-15", "");
+
+    CmdLineOption cmd_ana("Analyses", "-ana", "List of analyses (string), default: data,attenuation,timeres,tconst,lightout,energyres; all - all analyses", "data,attenuation,timeres,tconst,lightout,energyres");
+
+    CmdLineOption cmd_peakfit("Peak fit", "-peakfit", "Method of the 511 keV peak fit (string): formula or compiled, default: formula", "formula");
+
+    CmdLineOption cmd_histcache("Histogram cache", "-histcache", "Histogram cache (string): on, off or clear - remove cached histograms before running, default: on", "on");
+
+    CmdLineOption cmd_prefetch("Prefetch", "-prefetch", "Number of measurements read in the background ahead of the analyzed one (int), 0 - no prefetching, default: 1", "1");
+
+    CmdLineConfig::instance()->ReadCmdLine(argc, argv);
+
+    TString outdir = CmdLineOption::GetStringValue("Output directory");
+    TString dbase  = CmdLineOption::GetStringValue("Database");
+    int     njobs  = TString(CmdLineOption::GetStringValue("Jobs")).Atoi();
+
+    std::vector<int>                             series;
+    std::vector<std::pair<TString, AnalysisFun>> analyses;
+
+    if (!parse_series(CmdLineOption::GetStringValue("Series"), series) ||
+        !parse_analyses(CmdLineOption::GetStringValue("Analyses"), analyses))
+    {
+        std::cout << "to run type: ./sfbatch -series 1,3,10-15 ";
+        std::cout << "-ana attenuation,energyres -jobs 4 -threads 2 ";
+        std::cout << "-out path/to/output -db database" << std::endl;
+        return 1;
+    }
+
+    TString peakfit = CmdLineOption::GetStringValue("Peak fit");
+
+    if (peakfit == "compiled")
+        SFPeakFinder::SetDefaultFitMode(SFPeakFitMode::kCompiled);
+    else if (peakfit != "formula")
+    {
+        std::cerr << "##### Error in batch.cc! Unknown method of the peak fit: " << peakfit
+                  << std::endl;
+        return 1;
+    }
+
+    TString histcache = CmdLineOption::GetStringValue("Histogram cache");
+
+    if (histcache == "off")
+        SFHistCache::SetEnabled(false);
+    else if (histcache == "clear")
+        SFHistCache::Invalidate();
+    else if (histcache != "on")
+    {
+        std::cerr << "##### Error in batch.cc! Unknown histogram cache mode: " << histcache
+                  << std::endl;
+        return 1;
+    }
+
+    SFPrefetcher::SetDepth(TString(CmdLineOption::GetStringValue("Prefetch")).Atoi());
+    SFTools::SetNThreads(TString(CmdLineOption::GetStringValue("Threads")).Atoi());
+
+    int ret = prepare_output_directory(outdir);
+    if (ret != 0) return ret;
+
+    int nfailed = 0;
+
+    //----- single job - all series processed one after another in this process
+    if (njobs <= 1)
+    {
+        for (auto s : series)
+        {
+            if (run_series(s, analyses, outdir, dbase) != 0) nfailed++;
+        }
+    }
+    //----- many jobs - each series processed in a child process; libraries and
+    //----- ROOT are initialized only once, here, and inherited by the children
+    else
+    {
+        std::map<pid_t, int> running;
+        size_t               next = 0;
+
+        while (next < series.size() || !running.empty())
+        {
+            while (next < series.size() && (int)running.size() < njobs)
+            {
+                std::cout.flush();
+                std::cerr.flush();
+                fflush(nullptr);
+
+                pid_t pid = fork();
+
+                if (pid == 0)
+                {
+                    int nf = run_series(series[next], analyses, outdir, dbase);
+                    exit(nf == 0 ? 0 : 1);
+                }
+                else if (pid < 0)
+                {
+                    // series is never processed in the main process: connections to
+                    // the data bases opened here would be inherited by the next jobs
+                    if (running.empty())
+                    {
+                        std::cerr << "##### Error in batch.cc! Could not start job for series "
+                                  << series[next] << ", batch aborted!" << std::endl;
+                        return 1;
+                    }
+
+                    std::cout << "##### Warning in batch.cc! Could not start job for series "
+                              << series[next] << ", retrying when a running job finishes."
+                              << std::endl;
+                    break;
+                }
+
+                running[pid] = series[next];
+                next++;
+            }
+
+            if (running.empty()) continue;
+
+            int   status = 0;
+            pid_t pid    = wait(&status);
+
+            if (pid < 0)
+            {
+                std::cerr << "##### Error in batch.cc! Lost track of running jobs!" << std::endl;
+                return 1;
+            }
+
+            if (running.count(pid) == 0) continue;
+
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            {
+                std::cerr << "##### Error in batch.cc! Processing of series " << running[pid]
+                          << " failed!" << std::endl;
+                nfailed++;
+            }
+
+            running.erase(pid);
+        }
+    }
+
+    std::cout << "\n----- batch: processed " << series.size() << " series, " << nfailed
+              << " with errors" << std::endl;
+
+    return nfailed == 0 ? 0 : 1;
+}
@@ -1,12 +1,31 @@
 #ifndef COMMON_OPTIONS_H
 #define COMMON_OPTIONS_H
 
+#include "SFTools.hh"
+
 #include <CmdLineConfig.hh>
 #include <iostream>
 #include <sys/stat.h>
 
-int parse_common_options(int argc, char** argv, TString& outdir,
-                         TString& dbase, Int_t& seriesno)
+inline int prepare_output_directory(TString outdir)
+{
+    if (!gSystem->ChangeDirectory(outdir))
+    {
+        std::cout << "Creating new directory... " << std::endl;
+        std::cout << outdir << std::endl;
+        int stat = mkdir(outdir, 0777);
+        if (stat == -1)
+        {
+            std::cerr << "##### Error in prepare_output_directory()! Unable to create new direcotry!" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+inline int parse_common_options(int argc, char** argv, TString& outdir,
+                                TString& dbase, Int_t& seriesno)
 {
     TString path = std::string("./");
 
@@ -14,6 +33,8 @@ int parse_common_options(int argc, char** argv, TString& outdir,
 
     CmdLineOption cmd_dbase("Database", "-db", "Data base name (string), default: ScintFibRes.db", "ScintFibRes.db");
 
+    CmdLineOption cmd_threads("Threads", "-threads", "Number of threads (int), 0 - all available, default: 1", "1");
+
     CmdLineArg serno("SeriesNo", "series number", CmdLineArg::kInt);
 
     CmdLineConfig::instance()->ReadCmdLine(argc, argv);
@@ -22,19 +43,9 @@ int parse_common_options(int argc, char** argv, TString& outdir,
     dbase    = CmdLineOption::GetStringValue("Database");
     seriesno = serno.GetIntValue();
 
-    if (!gSystem->ChangeDirectory(outdir))
-    {
-        std::cout << "Creating new directory... " << std::endl;
-        std::cout << outdir << std::endl;
-        int stat = mkdir(outdir, 0777);
-        if (stat == -1)
-        {
-            std::cerr << "##### Error in parse_common_options()! Unable to create new direcotry!" << std::endl;
-            return 1;
-        }
-    }
+    SFTools::SetNThreads(TString(CmdLineOption::GetStringValue("Threads")).Atoi());
 
-    return 0;
+    return prepare_output_directory(outdir);
 }
 
 #endif /* COMMON_OPTIONS_H */
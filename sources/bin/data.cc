@@ -10,6 +10,8 @@
 
 #include "SFData.hh"
 #include "SFDrawCommands.hh"
+#include "SFResultsSink.hh"
+#include "analyses.h"
 #include "common_options.h"
 
 // #include <DistributionContext.h>
@@ -26,25 +28,53 @@
 
 const double ampMax = 660;
 
-int main(int argc, char** argv)
-{
+// maximal number of bins on each axis of correlation spectra drawn on canvases
+const int corrViewBins = 500;
 
-    gROOT->SetBatch(true);
+// converts compact correlation histograms to TH2D for drawing on canvases,
+// rebinned so that each axis has at most corrViewBins bins
+std::vector<TH2D*> corr_views(const std::vector<SFCorrHist*>& hists)
+{
+    std::vector<TH2D*> views;
 
-    TString outdir;
-    TString dbase;
-    int     seriesNo = -1;
+    for (auto h : hists)
+    {
+        int   ngroupx = (h->GetNbinsX() + corrViewBins - 1) / corrViewBins;
+        int   ngroupy = (h->GetNbinsY() + corrViewBins - 1) / corrViewBins;
+        TH2D* view    = h->ToTH2(ngroupx, ngroupy);
+        view->SetDirectory(nullptr);
+        views.push_back(view);
+    }
 
-    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
-    if (ret != 0) exit(ret);
+    return views;
+}
 
-    if (argc < 2)
+// writes correlation histograms in full resolution to the current directory,
+// with titles and settings of their views drawn on canvases, and deletes them;
+// only one full resolution TH2D exists at a time
+void write_corr(std::vector<SFCorrHist*>& hists, const std::vector<TH2D*>& views)
+{
+    for (size_t i = 0; i < hists.size(); i++)
     {
-        std::cout << "to run type: ./data seriesNo ";
-        std::cout << "-out path/to/output -db database" << std::endl;
-        return 1;
+        TH2D* h = hists[i]->ToTH2();
+        h->SetDirectory(nullptr);
+        h->SetTitle(views[i]->GetTitle());
+        h->GetXaxis()->SetTitle(views[i]->GetXaxis()->GetTitle());
+        h->GetYaxis()->SetTitle(views[i]->GetYaxis()->GetTitle());
+        h->SetStats(!views[i]->TestBit(TH1::kNoStats));
+        h->Write();
+        delete h;
+        delete hists[i];
     }
 
+    hists.clear();
+}
+
+int run_data(int seriesNo, TString outdir, TString dbase)
+{
+
+    gROOT->SetBatch(true);
+
     SFData* data;
 
     try
@@ -160,12 +190,76 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    //----- booking all histograms; each measurement is read only once
+    int reqAmpCh0     = -1;
+    int reqAmpCh1     = -1;
+    int reqChargeCh0  = -1;
+    int reqChargeCh1  = -1;
+    int reqCorrPE     = -1;
+    int reqT0Ch0      = -1;
+    int reqT0Ch1      = -1;
+    int reqTOTCh0     = -1;
+    int reqTOTCh1     = -1;
+    int reqBLCh0      = -1;
+    int reqBLCh1      = -1;
+    int reqBLCh2      = -1;
+    int reqBLSigmaCh0 = -1;
+    int reqBLSigmaCh1 = -1;
+    int reqBLSigmaCh2 = -1;
+    int reqCorrAmp    = -1;
+    int reqCorrT0     = -1;
+    int reqAmpPECh0   = -1;
+    int reqAmpPECh1   = -1;
+    int reqChargeCh2  = -1;
+
+    if (testBench == "PMI")
+    {
+        reqChargeCh0 = data->BookSpectra(0, SFSelectionType::kPMICharge, cutCh0);
+        reqChargeCh1 = data->BookSpectra(1, SFSelectionType::kPMICharge, cutCh1);
+        reqCorrPE    = data->BookCorrHistograms(SFSelectionType::kPMIChargeCorrelation, cutCh0Ch1);
+        reqT0Ch0     = data->BookSpectra(0, SFSelectionType::kPMIT0, cutCh0);
+        reqT0Ch1     = data->BookSpectra(1, SFSelectionType::kPMIT0, cutCh1);
+        reqCorrT0    = data->BookCorrHistograms(SFSelectionType::kPMIT0Correlation, cutCh0Ch1);
+    }
+    else
+    {
+        reqAmpCh0     = data->BookSpectra(0, SFSelectionType::kAmplitude, cutCh0A);
+        reqAmpCh1     = data->BookSpectra(1, SFSelectionType::kAmplitude, cutCh1A);
+        reqChargeCh0  = data->BookSpectra(0, SFSelectionType::kPE, cutCh0);
+        reqChargeCh1  = data->BookSpectra(1, SFSelectionType::kPE, cutCh1);
+        reqCorrPE     = data->BookCorrHistograms(SFSelectionType::kPECorrelation, cutCh0Ch1);
+        reqT0Ch0      = data->BookSpectra(0, SFSelectionType::kT0, cutCh0);
+        reqT0Ch1      = data->BookSpectra(1, SFSelectionType::kT0, cutCh1);
+        reqTOTCh0     = data->BookSpectra(0, SFSelectionType::kTOT, cutCh0);
+        reqTOTCh1     = data->BookSpectra(1, SFSelectionType::kTOT, cutCh1);
+        reqBLCh0      = data->BookSpectra(0, SFSelectionType::kBL, cutBLCh0);
+        reqBLCh1      = data->BookSpectra(1, SFSelectionType::kBL, cutBLCh1);
+        reqBLCh2      = data->BookSpectra(2, SFSelectionType::kBL, cutBLCh2);
+        reqBLSigmaCh0 = data->BookSpectra(0, SFSelectionType::kBLSigma, cutBLCh0);
+        reqBLSigmaCh1 = data->BookSpectra(1, SFSelectionType::kBLSigma, cutBLCh1);
+        reqBLSigmaCh2 = data->BookSpectra(2, SFSelectionType::kBLSigma, cutBLCh2);
+        reqCorrAmp    = data->BookCorrHistograms(SFSelectionType::kAmplitudeCorrelation, cutCh0Ch1);
+        reqCorrT0     = data->BookCorrHistograms(SFSelectionType::kT0Correlation, cutCh0Ch1);
+        reqAmpPECh0   = data->BookCorrHistograms(SFSelectionType::kAmpPECorrelation, cutCh0, 0);
+        reqAmpPECh1   = data->BookCorrHistograms(SFSelectionType::kAmpPECorrelation, cutCh1, 1);
+    }
+
+    if (collimator.Contains("Electronic"))
+        reqChargeCh2 = data->BookSpectra(2, SFSelectionType::kCharge, cutCh2);
+
+    if (!data->FillBookedHistograms())
+    {
+        std::cerr << "##### Error in data.cc!" << std::endl;
+        std::cerr << "Couldn't fill requested histograms!" << std::endl;
+        return 1;
+    }
+
     /*********/ //----- Amplitude spectra -----//
     
     if(testBench != "PMI")
     {
-        std::vector<TH1D*> hAmpCh0 = data->GetSpectra(0, SFSelectionType::kAmplitude, cutCh0A);
-        std::vector<TH1D*> hAmpCh1 = data->GetSpectra(1, SFSelectionType::kAmplitude, cutCh1A);
+        std::vector<TH1D*> hAmpCh0 = data->GetBookedHistograms(reqAmpCh0);
+        std::vector<TH1D*> hAmpCh1 = data->GetBookedHistograms(reqAmpCh1);
 
         TCanvas* can_ampl = new TCanvas("data_ampl", "data_ampl", 2000, 1200);
         can_ampl->DivideSquare(npoints);
@@ -227,19 +321,8 @@ int main(int argc, char** argv)
     
     /*********/ //----- Charge spectra -----//
 
-    std::vector<TH1D*> hChargeCh0;
-    std::vector<TH1D*> hChargeCh1; 
-    
-    if(testBench == "PMI")
-    {
-        hChargeCh0 = data->GetSpectra(0, SFSelectionType::kPMICharge, cutCh0);
-        hChargeCh1 = data->GetSpectra(1, SFSelectionType::kPMICharge, cutCh1);
-    }
-    else 
-    {
-        hChargeCh0 = data->GetSpectra(0, SFSelectionType::kPE, cutCh0);
-        hChargeCh1 = data->GetSpectra(1, SFSelectionType::kPE, cutCh1);
-    }
+    std::vector<TH1D*> hChargeCh0 = data->GetBookedHistograms(reqChargeCh0);
+    std::vector<TH1D*> hChargeCh1 = data->GetBookedHistograms(reqChargeCh1);
 
     TCanvas* can_charge = new TCanvas("data_charge", "data_charge", 2000, 1200);
     can_charge->DivideSquare(npoints);
@@ -303,12 +386,8 @@ int main(int argc, char** argv)
 
     /*********/ //----- Charge correlation spectra -----//
 
-    std::vector<TH2D*> hCorrPE;
-    
-    if (testBench == "PMI")
-        hCorrPE = data->GetCorrHistograms(SFSelectionType::kPMIChargeCorrelation, cutCh0Ch1);
-    else
-        hCorrPE = data->GetCorrHistograms(SFSelectionType::kPECorrelation, cutCh0Ch1);
+    std::vector<SFCorrHist*> corrPE  = data->GetBookedCorrHistograms(reqCorrPE);
+    std::vector<TH2D*>       hCorrPE = corr_views(corrPE);
  
     TCanvas* can_charge_corr = new TCanvas("data_charge_corr", "data_charge_corr", 2000, 1200);
     can_charge_corr->DivideSquare(npoints);
@@ -344,8 +423,7 @@ int main(int argc, char** argv)
         
      file->cd(dirName);
         
-     for (auto h : hCorrPE)
-         h->Write();
+     write_corr(corrPE, hCorrPE);
     
      for (auto h : hCorrPE)
          delete h;
@@ -354,19 +432,8 @@ int main(int argc, char** argv)
 
     /*********/ //----- T0 spectra -----//
 
-    std::vector<TH1D*> hT0Ch0; 
-    std::vector<TH1D*> hT0Ch1; 
-
-    if (testBench == "PMI")
-    {
-        hT0Ch0 = data->GetSpectra(0, SFSelectionType::kPMIT0, cutCh0);
-        hT0Ch1 = data->GetSpectra(1, SFSelectionType::kPMIT0, cutCh1);
-    }
-    else
-    {
-        hT0Ch0 = data->GetSpectra(0, SFSelectionType::kT0, cutCh0);
-        hT0Ch1 = data->GetSpectra(1, SFSelectionType::kT0, cutCh1);
-    }
+    std::vector<TH1D*> hT0Ch0 = data->GetBookedHistograms(reqT0Ch0);
+    std::vector<TH1D*> hT0Ch1 = data->GetBookedHistograms(reqT0Ch1);
     
     TCanvas* can_t0 = new TCanvas("data_t0", "data_t0", 2000, 1200);
     can_t0->DivideSquare(npoints);
@@ -436,8 +503,8 @@ int main(int argc, char** argv)
 
     if(testBench != "PMI")
     {
-        std::vector<TH1D*> hTOTCh0 = data->GetSpectra(0, SFSelectionType::kTOT, cutCh0);
-        std::vector<TH1D*> hTOTCh1 = data->GetSpectra(1, SFSelectionType::kTOT, cutCh1);
+        std::vector<TH1D*> hTOTCh0 = data->GetBookedHistograms(reqTOTCh0);
+        std::vector<TH1D*> hTOTCh1 = data->GetBookedHistograms(reqTOTCh1);
 
         TCanvas* can_tot = new TCanvas("data_tot", "data_tot", 2000, 1200);
         can_tot->DivideSquare(npoints);
@@ -503,9 +570,9 @@ int main(int argc, char** argv)
 
     if(testBench != "PMI")
     {
-        std::vector<TH1D*> hBLCh0 = data->GetSpectra(0, SFSelectionType::kBL, cutBLCh0);
-        std::vector<TH1D*> hBLCh1 = data->GetSpectra(1, SFSelectionType::kBL, cutBLCh1);
-        std::vector<TH1D*> hBLCh2 = data->GetSpectra(2, SFSelectionType::kBL, cutBLCh2);
+        std::vector<TH1D*> hBLCh0 = data->GetBookedHistograms(reqBLCh0);
+        std::vector<TH1D*> hBLCh1 = data->GetBookedHistograms(reqBLCh1);
+        std::vector<TH1D*> hBLCh2 = data->GetBookedHistograms(reqBLCh2);
 
         TCanvas* can_bl_ch0 = new TCanvas("data_bl_ch0", "can_bl_ch0", 2000, 1200);
         can_bl_ch0->DivideSquare(npoints);
@@ -572,9 +639,9 @@ int main(int argc, char** argv)
 
     if(testBench != "PMI")
     {
-        std::vector<TH1D*> hBLSigmaCh0 = data->GetSpectra(0, SFSelectionType::kBLSigma, cutBLCh0);
-        std::vector<TH1D*> hBLSigmaCh1 = data->GetSpectra(1, SFSelectionType::kBLSigma, cutBLCh1);
-        std::vector<TH1D*> hBLSigmaCh2 = data->GetSpectra(2, SFSelectionType::kBLSigma, cutBLCh2);
+        std::vector<TH1D*> hBLSigmaCh0 = data->GetBookedHistograms(reqBLSigmaCh0);
+        std::vector<TH1D*> hBLSigmaCh1 = data->GetBookedHistograms(reqBLSigmaCh1);
+        std::vector<TH1D*> hBLSigmaCh2 = data->GetBookedHistograms(reqBLSigmaCh2);
 
         TCanvas* can_bls_ch0 = new TCanvas("data_bls_ch0", "data_bls_ch0", 2000, 1200);
         can_bls_ch0->DivideSquare(npoints);
@@ -641,7 +708,8 @@ int main(int argc, char** argv)
 
     if(testBench != "PMI")
     {
-        std::vector<TH2D*> hCorrAmp = data->GetCorrHistograms(SFSelectionType::kAmplitudeCorrelation, cutCh0Ch1);
+        std::vector<SFCorrHist*> corrAmp  = data->GetBookedCorrHistograms(reqCorrAmp);
+        std::vector<TH2D*>       hCorrAmp = corr_views(corrAmp);
 
         TCanvas* can_ampl_corr = new TCanvas("data_ampl_corr", "data_ampl_corr", 2000, 1200);
         can_ampl_corr->DivideSquare(npoints);
@@ -668,8 +736,7 @@ int main(int argc, char** argv)
         
         file->cd(dirName);
         
-        for (auto h : hCorrAmp)
-            h->Write();
+        write_corr(corrAmp, hCorrAmp);
         
         for (auto h : hCorrAmp)
             delete h;
@@ -679,12 +746,8 @@ int main(int argc, char** argv)
     
     /*********/ //----- T0 correlation spectra -----//
 
-    std::vector<TH2D*> hCorrT0;
-    
-    if (testBench == "PMI")
-        hCorrT0 = data->GetCorrHistograms(SFSelectionType::kPMIT0Correlation, cutCh0Ch1);
-    else
-        hCorrT0 = data->GetCorrHistograms(SFSelectionType::kT0Correlation, cutCh0Ch1);
+    std::vector<SFCorrHist*> corrT0  = data->GetBookedCorrHistograms(reqCorrT0);
+    std::vector<TH2D*>       hCorrT0 = corr_views(corrT0);
 
     TCanvas* can_t0_corr = new TCanvas("data_t0_corr", "data_t0_corr", 2000, 1200);
     can_t0_corr->DivideSquare(npoints);
@@ -721,8 +784,7 @@ int main(int argc, char** argv)
         
     file->cd(dirName);
         
-    for (auto h : hCorrT0)
-        h->Write();
+    write_corr(corrT0, hCorrT0);
        
     for (auto h : hCorrT0)
         delete h;
@@ -733,7 +795,8 @@ int main(int argc, char** argv)
 
     if(testBench != "PMI")
     {
-        std::vector<TH2D*> hAmpPECh0 = data->GetCorrHistograms(SFSelectionType::kAmpPECorrelation, cutCh0, 0);
+        std::vector<SFCorrHist*> corrAmpPECh0 = data->GetBookedCorrHistograms(reqAmpPECh0);
+        std::vector<TH2D*>       hAmpPECh0    = corr_views(corrAmpPECh0);
 
         TCanvas* can_amp_pe_ch0 = new TCanvas("data_amp_pe_ch0", "data_amp_pe_ch0", 2000, 1200);
         can_amp_pe_ch0->DivideSquare(npoints);
@@ -763,8 +826,7 @@ int main(int argc, char** argv)
         
         file->cd(dirName);
         
-        for (auto h : hAmpPECh0)
-            h->Write();
+        write_corr(corrAmpPECh0, hAmpPECh0);
         
         for (auto h : hAmpPECh0)
             delete h;
@@ -773,8 +835,8 @@ int main(int argc, char** argv)
         
         /*********/
 
-        std::vector<TH2D*> hAmpPECh1 =
-            data->GetCorrHistograms(SFSelectionType::kAmpPECorrelation, cutCh1, 1);
+        std::vector<SFCorrHist*> corrAmpPECh1 = data->GetBookedCorrHistograms(reqAmpPECh1);
+        std::vector<TH2D*>       hAmpPECh1    = corr_views(corrAmpPECh1);
 
         TCanvas* can_amp_pe_ch1 = new TCanvas("data_amp_pe_ch1", "data_amp_pe_ch1", 2000, 1200);
         can_amp_pe_ch1->DivideSquare(npoints);
@@ -805,8 +867,7 @@ int main(int argc, char** argv)
         
         file->cd(dirName);
         
-        for (auto h : hAmpPECh1)
-            h->Write();
+        write_corr(corrAmpPECh1, hAmpPECh1);
         
         for (auto h : hAmpPECh1)
             delete h;
@@ -820,7 +881,7 @@ int main(int argc, char** argv)
     {
         /*********/
 
-        std::vector<TH1D*> hChargeCh2 = data->GetSpectra(2, SFSelectionType::kCharge, cutCh2);
+        std::vector<TH1D*> hChargeCh2 = data->GetBookedHistograms(reqChargeCh2);
         TCanvas*           can_ref    = new TCanvas("data_ref", "data_ref", 2000, 1200);
         can_ref->DivideSquare(npoints);
 
@@ -858,7 +919,8 @@ int main(int argc, char** argv)
 
         /*********/
 
-        std::vector<TH2D*> hChargeCh0Ch2 = data->GetRefCorrHistograms(0);
+        std::vector<SFCorrHist*> corrChargeCh0Ch2 = data->GetRefCorrHistograms(0);
+        std::vector<TH2D*>       hChargeCh0Ch2    = corr_views(corrChargeCh0Ch2);
         TCanvas*           can_ref_ch0   = new TCanvas("data_ref_ch0", "data_ref_ch0", 2000, 1200);
         can_ref_ch0->DivideSquare(npoints);
 
@@ -889,8 +951,7 @@ int main(int argc, char** argv)
         
         file->cd(dirName);
         
-        for (auto h : hChargeCh0Ch2)
-            h->Write();
+        write_corr(corrChargeCh0Ch2, hChargeCh0Ch2);
         
         for (auto h : hChargeCh0Ch2)
             delete h;
@@ -899,7 +960,8 @@ int main(int argc, char** argv)
 
         /*********/
 
-        std::vector<TH2D*> hChargeCh1Ch2 = data->GetRefCorrHistograms(1);
+        std::vector<SFCorrHist*> corrChargeCh1Ch2 = data->GetRefCorrHistograms(1);
+        std::vector<TH2D*>       hChargeCh1Ch2    = corr_views(corrChargeCh1Ch2);
         TCanvas*           can_ref_ch1   = new TCanvas("data_ref_ch1", "data_ref_ch1", 2000, 1200);
         can_ref_ch1->DivideSquare(npoints);
 
@@ -928,8 +990,7 @@ int main(int argc, char** argv)
         
         file->cd(dirName);
         
-        for (auto h : hChargeCh1Ch2)
-            h->Write();
+        write_corr(corrChargeCh1Ch2, hChargeCh1Ch2);
         
         for (auto h : hChargeCh1Ch2)
             delete h;
@@ -1077,19 +1138,30 @@ int main(int argc, char** argv)
         else 
             ID = SFTools::GetMeasurementID(seriesNo, 50.0);
 
-        hSigAvCh0[0] = data->GetSignalAverage(
-            0, ID, Form("ch_0.fPE>%f && ch_0.fPE<%f", PE[0] - 0.5, PE[0] + 0.5), 20, true);
-        hSigAvCh0[1] = data->GetSignalAverage(
-            0, ID, Form("ch_0.fPE>%f && ch_0.fPE<%f", PE[1] - 0.5, PE[1] + 0.5), 20, true);
-        hSigAvCh0[2] = data->GetSignalAverage(
-            0, ID, Form("ch_0.fPE>%f && ch_0.fPE<%f", PE[2] - 0.5, PE[2] + 0.5), 20, true);
+        // all averaged signals are built in a single scan of the measurement
+        std::vector<SFSignalRequest> requests(2 * nsigav);
 
-        hSigAvCh1[0] = data->GetSignalAverage(
-            1, ID, Form("ch_1.fPE>%f && ch_1.fPE<%f", PE[0] - 0.5, PE[0] + 0.5), 20, true);
-        hSigAvCh1[1] = data->GetSignalAverage(
-            1, ID, Form("ch_1.fPE>%f && ch_1.fPE<%f", PE[1] - 0.5, PE[1] + 0.5), 20, true);
-        hSigAvCh1[2] = data->GetSignalAverage(
-            1, ID, Form("ch_1.fPE>%f && ch_1.fPE<%f", PE[2] - 0.5, PE[2] + 0.5), 20, true);
+        for (int i = 0; i < nsigav; i++)
+        {
+            for (int ch = 0; ch < 2; ch++)
+            {
+                SFSignalRequest& request = requests[ch * nsigav + i];
+
+                request.fCh     = ch;
+                request.fCut    = Form("ch_%i.fPE>%f && ch_%i.fPE<%f", ch, PE[i] - 0.5, ch,
+                                       PE[i] + 0.5);
+                request.fNumber = 20;
+                request.fBL     = true;
+            }
+        }
+
+        data->GetSignalAverages(ID, requests);
+
+        for (int i = 0; i < nsigav; i++)
+        {
+            hSigAvCh0[i] = requests[i].fSignal;
+            hSigAvCh1[i] = requests[nsigav + i].fSignal;
+        }
         
         TCanvas* can_sigav = new TCanvas("data_sigav", "data_sigav", 1800, 800);
         can_sigav->Divide(3, 2);
@@ -1174,31 +1246,42 @@ int main(int argc, char** argv)
 
     //----- writing results to the data base
     TString table = "DATA";
-    TString query = Form("INSERT OR REPLACE INTO %s (SERIES_ID, RESULTS_FILE) VALUES (%i, '%s')",
-                         table.Data(), seriesNo, fname_full.Data());
 
-    const int max_tries = 20;
-    int       i_try     = max_tries;
-    float     wait      = 0;
-    bool      stat      = false;
+    std::cout << "----- data writing..." << std::endl;
+    SFResultsSink* sink = SFResultsSink::Open(dbname_full);
+    bool           stat = (sink != nullptr) && sink->Save(table, seriesNo, fname_full, {});
 
-    srand(time(NULL));
-
-    do
+    if (!stat)
     {
-        std::cout << "----- data writing, try number " << (max_tries - i_try) + 1 << std::endl;
-        stat = SFTools::SaveResultsDB(dbname_full, table, query, seriesNo);
-
-        if (stat) break;
-
-        --i_try;
-        wait = rand() % 10 + 1;
-        std::cout << "----- data writing, database locked..." << std::endl;
-        std::cout << "----- waiting " << wait << " s" << std::endl;
-        sleep(wait);
-    } while (i_try > 0);
+        std::cerr << "##### Error in data.cc! Results not saved in the data base!"
+                  << std::endl;
+    }
 
     delete data;
 
     return 0;
 }
+
+#ifndef SF_BATCH
+int main(int argc, char** argv)
+{
+
+    gROOT->SetBatch(true);
+
+    TString outdir;
+    TString dbase;
+    int     seriesNo = -1;
+
+    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
+    if (ret != 0) exit(ret);
+
+    if (argc < 2)
+    {
+        std::cout << "to run type: ./data seriesNo ";
+        std::cout << "-out path/to/output -db database" << std::endl;
+        return 1;
+    }
+
+    return run_data(seriesNo, outdir, dbase);
+}
+#endif /* SF_BATCH */
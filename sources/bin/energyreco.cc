@@ -10,6 +10,9 @@
 
 #include "SFData.hh"
 #include "SFEnergyReco.hh"
+#include "SFResultsSink.hh"
+#include "SFSeriesContext.hh"
+#include "analyses.h"
 #include "common_options.h"
 
 #include <TPave.h>
@@ -24,27 +27,14 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
-int main(int argc, char** argv)
+int run_energyreco(int seriesNo, TString outdir, TString dbase)
 {
-
-    TString outdir;
-    TString dbase;
-    int     seriesNo = -1;
-
-    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
-    if (ret != 0) exit(ret);
-
-    if (argc < 2)
-    {
-        std::cout << "to run type: ./energyreco seriesNo";
-        std::cout << "-out path/to/output -db database" << std::endl;
-        return 1;
-    }
-
-    SFData* data;
+    SFSeriesContext* context = nullptr;
+    SFData*          data    = nullptr;
     try
     {
-        data = new SFData(seriesNo);
+        context = SFSeriesContext::Acquire(seriesNo);
+        data    = context->GetData();
     }
     catch (const char* message)
     {
@@ -70,7 +60,7 @@ int main(int argc, char** argv)
     SFEnergyReco* reco = nullptr;
     try
     {
-        reco = new SFEnergyReco(seriesNo);
+        reco = new SFEnergyReco(context);
     }
     catch (const char* message)
     {
@@ -435,39 +425,29 @@ int main(int argc, char** argv)
 
     //-----writing results to the data base
     TString table = "ENERGY_RECONSTRUCTION";
-    TString query = Form("INSERT OR REPLACE INTO %s (SERIES_ID, RESULTS_FILE, ALPHA_EXP, "
-                         "ALPHA_EXP_ERR, ALPHA_CORR, ALPHA_CORR_ERR, ERES_EXP, ERES_EXP_ERR, "
-                         "ERES_CORR, ERES_CORR_ERR, ERES_ALL, ERES_ALL_ERR, ERES_CORR_ALL, "
-                         "ERES_CORR_ALL_ERR) VALUES (%i, '%s', %f, %f, %f, %f, %f, %f, %f, %f, " 
-                         "%f, %f, %f, %f)", table.Data(), seriesNo, fname_full.Data(),
-                         results[0]->GetValue(SFResultTypeNum::kAlpha),
-                         results[0]->GetUncertainty(SFResultTypeNum::kAlpha),
-                         results[1]->GetValue(SFResultTypeNum::kAlpha),
-                         results[1]->GetUncertainty(SFResultTypeNum::kAlpha),
-                         results[0]->GetValue(SFResultTypeNum::kEnergyRes),
-                         results[0]->GetUncertainty(SFResultTypeNum::kEnergyRes),
-                         results[1]->GetValue(SFResultTypeNum::kEnergyRes),
-                         results[1]->GetUncertainty(SFResultTypeNum::kEnergyRes),
-                         eres_all, eres_all_err, eres_corr_all, eres_corr_all_err);
-    
-    const int max_tries = 20;
-    int       i_try     = max_tries;
-    float     wait      = 0;
-    bool      stat      = false;
-    
-    do
+    std::vector<std::pair<TString, double>> values = {
+        {"ALPHA_EXP", results[0]->GetValue(SFResultTypeNum::kAlpha)},
+        {"ALPHA_EXP_ERR", results[0]->GetUncertainty(SFResultTypeNum::kAlpha)},
+        {"ALPHA_CORR", results[1]->GetValue(SFResultTypeNum::kAlpha)},
+        {"ALPHA_CORR_ERR", results[1]->GetUncertainty(SFResultTypeNum::kAlpha)},
+        {"ERES_EXP", results[0]->GetValue(SFResultTypeNum::kEnergyRes)},
+        {"ERES_EXP_ERR", results[0]->GetUncertainty(SFResultTypeNum::kEnergyRes)},
+        {"ERES_CORR", results[1]->GetValue(SFResultTypeNum::kEnergyRes)},
+        {"ERES_CORR_ERR", results[1]->GetUncertainty(SFResultTypeNum::kEnergyRes)},
+        {"ERES_ALL", eres_all},
+        {"ERES_ALL_ERR", eres_all_err},
+        {"ERES_CORR_ALL", eres_corr_all},
+        {"ERES_CORR_ALL_ERR", eres_corr_all_err}};
+
+    std::cout << "----- enres writing..." << std::endl;
+    SFResultsSink* sink = SFResultsSink::Open(dbname_full);
+    bool           stat = (sink != nullptr) && sink->Save(table, seriesNo, fname_full, values);
+
+    if (!stat)
     {
-        std::cout << "----- enres writing, try number " << (max_tries - i_try) + 1 << std::endl;
-        stat = SFTools::SaveResultsDB(dbname_full, table, query, seriesNo);
-        
-        if (stat) break;
-        
-        --i_try;
-        wait = rand() % 10 + 1;
-        std::cout << "----- enres writing, database locked..." << std::endl;
-        std::cout << "----- waiting " << wait << " s" << std::endl;
-        sleep(wait);
-    } while (i_try > 0);
+        std::cerr << "##### Error in energyreco.cc! Results not saved in the data base!"
+                  << std::endl;
+    }
     
     for (auto h : hEnReco)
         delete h;
@@ -475,8 +455,30 @@ int main(int argc, char** argv)
     for (auto h : hEnRecoCorr)
         delete h;
     
-    delete data;
     delete reco;
+    context->Release();
     
     return 0;
 }
+
+#ifndef SF_BATCH
+int main(int argc, char** argv)
+{
+
+    TString outdir;
+    TString dbase;
+    int     seriesNo = -1;
+
+    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
+    if (ret != 0) exit(ret);
+
+    if (argc < 2)
+    {
+        std::cout << "to run type: ./energyreco seriesNo";
+        std::cout << "-out path/to/output -db database" << std::endl;
+        return 1;
+    }
+
+    return run_energyreco(seriesNo, outdir, dbase);
+}
+#endif /* SF_BATCH */
@@ -9,6 +9,8 @@
 // *****************************************
 
 #include "SFEnergyRes.hh"
+#include "SFResultsSink.hh"
+#include "analyses.h"
 #include "common_options.h"
 
 #include <TCanvas.h>
@@ -20,23 +22,8 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
-int main(int argc, char** argv)
+int run_energyres(int seriesNo, TString outdir, TString dbase)
 {
-
-    TString outdir;
-    TString dbase;
-    int     seriesNo = -1;
-
-    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
-    if (ret != 0) exit(ret);
-
-    if (argc < 2)
-    {
-        std::cout << "to run type: ./energyres seriesNo ";
-        std::cout << "-out path/to/output -db database" << std::endl;
-        return 1;
-    }
-
     //----- accessing results of energy resolution analysis
     SFData* data;
     try
@@ -252,40 +239,48 @@ int main(int argc, char** argv)
 
     //----- writing results to the data base
     TString table = "ENERGY_RESOLUTION";
-    TString query = Form("INSERT OR REPLACE INTO %s (SERIES_ID, RESULTS_FILE, ENRES_AV, "
-                         "ENRES_AV_ERR, ENRES_CH0, ENRES_CH0_ERR, ENRES_CH1, ENRES_CH1_ERR) "
-                         "VALUES (%i, '%s', %f, %f, %f, %f, %f, %f)",
-                         table.Data(), seriesNo, fname_full.Data(),
-                         results[2]->GetValue(SFResultTypeNum::kEnergyRes),
-                         results[2]->GetUncertainty(SFResultTypeNum::kEnergyRes),
-                         results[0]->GetValue(SFResultTypeNum::kEnergyRes),
-                         results[0]->GetUncertainty(SFResultTypeNum::kEnergyRes),
-                         results[1]->GetValue(SFResultTypeNum::kEnergyRes),
-                         results[1]->GetUncertainty(SFResultTypeNum::kEnergyRes));
-
-    const int max_tries = 20;
-    int       i_try     = max_tries;
-    float     wait      = 0;
-    bool      stat      = false;
-
-    srand(time(NULL));
-
-    do
+    std::vector<std::pair<TString, double>> values = {
+        {"ENRES_AV", results[2]->GetValue(SFResultTypeNum::kEnergyRes)},
+        {"ENRES_AV_ERR", results[2]->GetUncertainty(SFResultTypeNum::kEnergyRes)},
+        {"ENRES_CH0", results[0]->GetValue(SFResultTypeNum::kEnergyRes)},
+        {"ENRES_CH0_ERR", results[0]->GetUncertainty(SFResultTypeNum::kEnergyRes)},
+        {"ENRES_CH1", results[1]->GetValue(SFResultTypeNum::kEnergyRes)},
+        {"ENRES_CH1_ERR", results[1]->GetUncertainty(SFResultTypeNum::kEnergyRes)}};
+
+    std::cout << "----- energyres writing..." << std::endl;
+    SFResultsSink* sink = SFResultsSink::Open(dbname_full);
+    bool           stat = (sink != nullptr) && sink->Save(table, seriesNo, fname_full, values);
+
+    if (!stat)
     {
-        std::cout << "----- energyres writing, try number " << (max_tries - i_try) + 1 << std::endl;
-        stat = SFTools::SaveResultsDB(dbname_full, table, query, seriesNo);
-
-        if (stat) break;
-
-        --i_try;
-        wait = rand() % 10 + 1;
-        std::cout << "----- energyres writing, database locked..." << std::endl;
-        std::cout << "----- waiting " << wait << " s" << std::endl;
-        sleep(wait);
-    } while (i_try > 0);
+        std::cerr << "##### Error in energyres.cc! Results not saved in the data base!"
+                  << std::endl;
+    }
 
     delete data;
     delete enres;
 
     return 0;
 }
+
+#ifndef SF_BATCH
+int main(int argc, char** argv)
+{
+
+    TString outdir;
+    TString dbase;
+    int     seriesNo = -1;
+
+    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
+    if (ret != 0) exit(ret);
+
+    if (argc < 2)
+    {
+        std::cout << "to run type: ./energyres seriesNo ";
+        std::cout << "-out path/to/output -db database" << std::endl;
+        return 1;
+    }
+
+    return run_energyres(seriesNo, outdir, dbase);
+}
+#endif /* SF_BATCH */
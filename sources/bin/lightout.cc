@@ -12,7 +12,9 @@
 
 #include "SFData.hh"
 #include "SFLightOutput.hh"
+#include "SFResultsSink.hh"
 #include "SFTools.hh"
+#include "analyses.h"
 #include "common_options.h"
 
 #include <TCanvas.h>
@@ -24,23 +26,8 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
-int main(int argc, char** argv)
+int run_lightout(int seriesNo, TString outdir, TString dbase)
 {
-
-    TString outdir;
-    TString dbase;
-    int     seriesNo = -1;
-
-    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
-    if (ret != 0) exit(ret);
-
-    if (argc < 2)
-    {
-        std::cout << "to run type: ./lightout seriesNo";
-        std::cout << "-out path/to/output -db database" << std::endl;
-        return 1;
-    }
-
     SFData* data;
 
     try
@@ -289,48 +276,54 @@ int main(int argc, char** argv)
 
     //----- writing results to the data base
     TString table = "LIGHT_OUTPUT";
-    TString query = Form(
-        "INSERT OR REPLACE INTO %s (SERIES_ID, RESULTS_FILE, "
-        "LOUT, LOUT_ERR, LOUT_CH0, LOUT_CH0_ERR, LOUT_CH1, LOUT_CH1_ERR, "
-        "LCOL, LCOL_ERR, LCOL_CH0, LCOL_CH0_ERR, LCOL_CH1, LCOL_CH1_ERR) "
-        "VALUES (%i, '%s', %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f)",
-        table.Data(), seriesNo, fname_full.Data(), 
-        LOresults[2]->GetValue(SFResultTypeNum::kLight),
-        LOresults[2]->GetUncertainty(SFResultTypeNum::kLight),
-        LOresults[0]->GetValue(SFResultTypeNum::kLight),
-        LOresults[0]->GetUncertainty(SFResultTypeNum::kLight),
-        LOresults[1]->GetValue(SFResultTypeNum::kLight),
-        LOresults[1]->GetUncertainty(SFResultTypeNum::kLight),
-        LCresults[2]->GetValue(SFResultTypeNum::kLight), 
-        LCresults[2]->GetUncertainty(SFResultTypeNum::kLight),
-        LCresults[0]->GetValue(SFResultTypeNum::kLight),
-        LCresults[0]->GetUncertainty(SFResultTypeNum::kLight),
-        LCresults[1]->GetValue(SFResultTypeNum::kLight),
-        LCresults[1]->GetUncertainty(SFResultTypeNum::kLight));
-
-    const int max_tries = 20;
-    int       i_try     = max_tries;
-    float     wait      = 0;
-    bool      stat      = false;
-
-    srand(time(NULL));
-
-    do
+    std::vector<std::pair<TString, double>> values = {
+        {"LOUT", LOresults[2]->GetValue(SFResultTypeNum::kLight)},
+        {"LOUT_ERR", LOresults[2]->GetUncertainty(SFResultTypeNum::kLight)},
+        {"LOUT_CH0", LOresults[0]->GetValue(SFResultTypeNum::kLight)},
+        {"LOUT_CH0_ERR", LOresults[0]->GetUncertainty(SFResultTypeNum::kLight)},
+        {"LOUT_CH1", LOresults[1]->GetValue(SFResultTypeNum::kLight)},
+        {"LOUT_CH1_ERR", LOresults[1]->GetUncertainty(SFResultTypeNum::kLight)},
+        {"LCOL", LCresults[2]->GetValue(SFResultTypeNum::kLight)},
+        {"LCOL_ERR", LCresults[2]->GetUncertainty(SFResultTypeNum::kLight)},
+        {"LCOL_CH0", LCresults[0]->GetValue(SFResultTypeNum::kLight)},
+        {"LCOL_CH0_ERR", LCresults[0]->GetUncertainty(SFResultTypeNum::kLight)},
+        {"LCOL_CH1", LCresults[1]->GetValue(SFResultTypeNum::kLight)},
+        {"LCOL_CH1_ERR", LCresults[1]->GetUncertainty(SFResultTypeNum::kLight)}};
+
+    std::cout << "----- lightout writing..." << std::endl;
+    SFResultsSink* sink = SFResultsSink::Open(dbname_full);
+    bool           stat = (sink != nullptr) && sink->Save(table, seriesNo, fname_full, values);
+
+    if (!stat)
     {
-        std::cout << "----- lightout writing, try number " << (max_tries - i_try) + 1 << std::endl;
-        stat = SFTools::SaveResultsDB(dbname_full, table, query, seriesNo);
-
-        if (stat) break;
-
-        --i_try;
-        wait = rand() % 10 + 1;
-        std::cout << "----- lightout writing, database locked..." << std::endl;
-        std::cout << "----- waiting " << wait << " s" << std::endl;
-        sleep(wait);
-    } while (i_try > 0);
+        std::cerr << "##### Error in lightout.cc! Results not saved in the data base!"
+                  << std::endl;
+    }
 
     delete data;
     delete lout;
 
     return 0;
 }
+
+#ifndef SF_BATCH
+int main(int argc, char** argv)
+{
+
+    TString outdir;
+    TString dbase;
+    int     seriesNo = -1;
+
+    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
+    if (ret != 0) exit(ret);
+
+    if (argc < 2)
+    {
+        std::cout << "to run type: ./lightout seriesNo";
+        std::cout << "-out path/to/output -db database" << std::endl;
+        return 1;
+    }
+
+    return run_lightout(seriesNo, outdir, dbase);
+}
+#endif /* SF_BATCH */
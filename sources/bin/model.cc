@@ -10,6 +10,8 @@
 
 #include "SFData.hh"
 #include "SFAttenuationModel.hh"
+#include "SFResultsSink.hh"
+#include "analyses.h"
 #include "common_options.h"
 
 #include <TCanvas.h>
@@ -19,23 +21,8 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
-int main(int argc, char** argv)
+int run_model(int seriesNo, TString outdir, TString dbase)
 {
-
-    TString outdir;
-    TString dbase;
-    int     seriesNo = -1;
-
-    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
-    if (ret != 0) exit(ret);
-
-    if (argc < 2)
-    {
-        std::cout << "to run type: ./model seriesNo";
-        std::cout << "-out path/to/output -db database" << std::endl;
-        return 1;
-    }
-
     SFData* data;
     try
     {
@@ -210,43 +197,53 @@ int main(int argc, char** argv)
 
     //-----writing results to the data base
     TString table = "ATTENUATION_MODEL";
-    TString query = Form("INSERT OR REPLACE INTO %s (SERIES_ID, RESULTS_FILE, S0, S0_ERR, "
-                           "LAMBDA, LAMBDA_ERR, ETAR, ETAR_ERR, ETAL, ETAL_ERR, KSI, KSI_ERR, CHI2NDF) "
-                           "VALUES (%i, '%s', %f, %f, %f, %f, %f, %f, %f, %f, %f, %f, %f)",
-                           table.Data(), seriesNo, fname_full.Data(),
-                           results->GetValue(SFResultTypeNum::kS0),
-                           results->GetUncertainty(SFResultTypeNum::kS0),
-                           results->GetValue(SFResultTypeNum::kLambda),
-                           results->GetUncertainty(SFResultTypeNum::kLambda),
-                           results->GetValue(SFResultTypeNum::kEtaR),
-                           results->GetUncertainty(SFResultTypeNum::kEtaR),
-                           results->GetValue(SFResultTypeNum::kEtaL),
-                           results->GetUncertainty(SFResultTypeNum::kEtaL),
-                           results->GetValue(SFResultTypeNum::kKsi),
-                           results->GetUncertainty(SFResultTypeNum::kKsi),
-                           results->GetValue(SFResultTypeNum::kChi2NDF));
-    
-    const int max_tries = 20;
-    int       i_try     = max_tries;
-    float     wait      = 0;
-    bool      stat      = false;
-    
-    do
+    std::vector<std::pair<TString, double>> values = {
+        {"S0", results->GetValue(SFResultTypeNum::kS0)},
+        {"S0_ERR", results->GetUncertainty(SFResultTypeNum::kS0)},
+        {"LAMBDA", results->GetValue(SFResultTypeNum::kLambda)},
+        {"LAMBDA_ERR", results->GetUncertainty(SFResultTypeNum::kLambda)},
+        {"ETAR", results->GetValue(SFResultTypeNum::kEtaR)},
+        {"ETAR_ERR", results->GetUncertainty(SFResultTypeNum::kEtaR)},
+        {"ETAL", results->GetValue(SFResultTypeNum::kEtaL)},
+        {"ETAL_ERR", results->GetUncertainty(SFResultTypeNum::kEtaL)},
+        {"KSI", results->GetValue(SFResultTypeNum::kKsi)},
+        {"KSI_ERR", results->GetUncertainty(SFResultTypeNum::kKsi)},
+        {"CHI2NDF", results->GetValue(SFResultTypeNum::kChi2NDF)}};
+
+    std::cout << "----- model writing..." << std::endl;
+    SFResultsSink* sink = SFResultsSink::Open(dbname_full);
+    bool           stat = (sink != nullptr) && sink->Save(table, seriesNo, fname_full, values);
+
+    if (!stat)
     {
-        std::cout << "----- model writing, try number " << (max_tries - i_try) + 1 << std::endl;
-        stat = SFTools::SaveResultsDB(dbname_full, table, query, seriesNo);
-        
-        if (stat) break;
-        
-        --i_try;
-        wait = rand() % 10 + 1;
-        std::cout << "----- model writing, database locked..." << std::endl;
-        std::cout << "----- waiting " << wait << " s" << std::endl;
-        sleep(wait);
-    } while (i_try > 0);
+        std::cerr << "##### Error in model.cc! Results not saved in the data base!"
+                  << std::endl;
+    }
     
     delete data;
     delete model;
     
     return 0;
 }
+
+#ifndef SF_BATCH
+int main(int argc, char** argv)
+{
+
+    TString outdir;
+    TString dbase;
+    int     seriesNo = -1;
+
+    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
+    if (ret != 0) exit(ret);
+
+    if (argc < 2)
+    {
+        std::cout << "to run type: ./model seriesNo";
+        std::cout << "-out path/to/output -db database" << std::endl;
+        return 1;
+    }
+
+    return run_model(seriesNo, outdir, dbase);
+}
+#endif /* SF_BATCH */
@@ -11,6 +11,8 @@
 #include "SFAttenuation.hh"
 #include "SFData.hh"
 #include "SFPeakFinder.hh"
+#include "SFResultsSink.hh"
+#include "analyses.h"
 #include "common_options.h"
 
 // #include <DistributionContext.h>
@@ -21,23 +23,8 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
-int main(int argc, char** argv)
+int run_peakfin(int seriesNo, TString outdir, TString dbase)
 {
-
-    TString outdir;
-    TString dbase;
-    int     seriesNo = -1;
-
-    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
-    if (ret != 0) exit(ret);
-
-    if (argc < 2)
-    {
-        std::cout << "to run type: ./posres seriesNo";
-        std::cout << "-out path/to/output -db database" << std::endl;
-        return 1;
-    }
-
     SFData* data;
     try
     {
@@ -322,32 +309,41 @@ int main(int argc, char** argv)
 
     //----- writing results to the data base
     TString table = "PEAK_FINDER";
-    TString query = Form("INSERT OR REPLACE INTO %s (SERIES_ID, RESULTS_FILE) VALUES(%i, '%s')",
-                         table.Data(), seriesNo, fname_full.Data());
-
-    const int max_tries = 20;
-    int       i_try     = max_tries;
-    float     wait      = 0;
-    bool      stat      = false;
 
-    srand(time(NULL));
+    std::cout << "----- peakfin writing..." << std::endl;
+    SFResultsSink* sink = SFResultsSink::Open(dbname_full);
+    bool           stat = (sink != nullptr) && sink->Save(table, seriesNo, fname_full, {});
 
-    do
+    if (!stat)
     {
-        std::cout << "----- peakfin writing, try number " << (max_tries - i_try) + 1 << std::endl;
-        stat = SFTools::SaveResultsDB(dbname_full, table, query, seriesNo);
-
-        if (stat) break;
-
-        --i_try;
-        wait = rand() % 10 + 1;
-        std::cout << "----- peakfin writing, database locked..." << std::endl;
-        std::cout << "----- waiting " << wait << " s" << std::endl;
-        sleep(wait);
-    } while (i_try > 0);
+        std::cerr << "##### Error in peakfin.cc! Results not saved in the data base!"
+                  << std::endl;
+    }
 
     delete data;
     // delete att;
 
     return 0;
 }
+
+#ifndef SF_BATCH
+int main(int argc, char** argv)
+{
+
+    TString outdir;
+    TString dbase;
+    int     seriesNo = -1;
+
+    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
+    if (ret != 0) exit(ret);
+
+    if (argc < 2)
+    {
+        std::cout << "to run type: ./posres seriesNo";
+        std::cout << "-out path/to/output -db database" << std::endl;
+        return 1;
+    }
+
+    return run_peakfin(seriesNo, outdir, dbase);
+}
+#endif /* SF_BATCH */
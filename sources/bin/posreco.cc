@@ -10,6 +10,9 @@
 
 #include "SFData.hh"
 #include "SFPositionReco.hh"
+#include "SFResultsSink.hh"
+#include "SFSeriesContext.hh"
+#include "analyses.h"
 #include "common_options.h"
 
 #include <TCanvas.h>
@@ -21,27 +24,14 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
-int main(int argc, char** argv)
+int run_posreco(int seriesNo, TString outdir, TString dbase)
 {
-
-    TString outdir;
-    TString dbase;
-    int     seriesNo = -1;
-
-    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
-    if (ret != 0) exit(ret);
-
-    if (argc < 2)
-    {
-        std::cout << "to run type: ./reco seriesNo";
-        std::cout << "-out path/to/output -db database" << std::endl;
-        return 1;
-    }
-
-    SFData* data;
+    SFSeriesContext* context = nullptr;
+    SFData*          data    = nullptr;
     try
     {
-        data = new SFData(seriesNo);
+        context = SFSeriesContext::Acquire(seriesNo);
+        data    = context->GetData();
     }
     catch (const char* message)
     {
@@ -69,7 +59,7 @@ int main(int argc, char** argv)
     SFPositionReco* reco;
     try
     {
-        reco = new SFPositionReco(seriesNo);
+        reco = new SFPositionReco(context);
     }
     catch (const char* message)
     {
@@ -468,51 +458,60 @@ int main(int argc, char** argv)
 
     //-----writing results to the data base
     TString table = "POSITION_RECONSTRUCTION";
-    TString query = Form("INSERT OR REPLACE INTO %s (SERIES_ID, RESULTS_FILE, A_COEFF, "
-                         "A_COEFF_ERR, B_COEFF, MLR_SLOPE, MLR_SLOPE_ERR, MLR_OFFSET, " 
-                         "MLR_OFFSET_ERR, MLR_SLOPE_EXP, MLR_SLOPE_EXP_ERR, MLR_OFFSET_EXP, "
-                         "MLR_OFFSET_EXP_ERR, POSITION_RES, POSITION_RES_ERR, POSITION_RES_ALL, "
-                         "POSITION_RES_ALL_ERR) VALUES (%i, '%s', %f, %f, %f, %f, %f, %f, %f, %f, "
-                         "%f, %f, %f, %f,%f, %f, %f)", table.Data(), seriesNo, fname_full.Data(),
-                         results[1]->GetValue(SFResultTypeNum::kACoeff),
-                         results[1]->GetUncertainty(SFResultTypeNum::kACoeff),
-                         results[1]->GetValue(SFResultTypeNum::kBCoeff),
-                         results[1]->GetValue(SFResultTypeNum::kMLRSlope),
-                         results[1]->GetUncertainty(SFResultTypeNum::kMLRSlope),
-                         results[1]->GetValue(SFResultTypeNum::kMLROffset),
-                         results[1]->GetUncertainty(SFResultTypeNum::kMLROffset),
-                         results[0]->GetValue(SFResultTypeNum::kMLRSlope),
-                         results[0]->GetUncertainty(SFResultTypeNum::kMLRSlope),
-                         results[0]->GetValue(SFResultTypeNum::kMLROffset),
-                         results[0]->GetUncertainty(SFResultTypeNum::kMLROffset),
-                         results[1]->GetValue(SFResultTypeNum::kPositionRes),
-                         results[1]->GetUncertainty(SFResultTypeNum::kPositionRes),
-                         fwhm_corr_all, fwhm_corr_all_err);
-    
-    const int max_tries = 20;
-    int       i_try     = max_tries;
-    float     wait      = 0;
-    bool      stat      = false;
-    
-    do
+    std::vector<std::pair<TString, double>> values = {
+        {"A_COEFF", results[1]->GetValue(SFResultTypeNum::kACoeff)},
+        {"A_COEFF_ERR", results[1]->GetUncertainty(SFResultTypeNum::kACoeff)},
+        {"B_COEFF", results[1]->GetValue(SFResultTypeNum::kBCoeff)},
+        {"MLR_SLOPE", results[1]->GetValue(SFResultTypeNum::kMLRSlope)},
+        {"MLR_SLOPE_ERR", results[1]->GetUncertainty(SFResultTypeNum::kMLRSlope)},
+        {"MLR_OFFSET", results[1]->GetValue(SFResultTypeNum::kMLROffset)},
+        {"MLR_OFFSET_ERR", results[1]->GetUncertainty(SFResultTypeNum::kMLROffset)},
+        {"MLR_SLOPE_EXP", results[0]->GetValue(SFResultTypeNum::kMLRSlope)},
+        {"MLR_SLOPE_EXP_ERR", results[0]->GetUncertainty(SFResultTypeNum::kMLRSlope)},
+        {"MLR_OFFSET_EXP", results[0]->GetValue(SFResultTypeNum::kMLROffset)},
+        {"MLR_OFFSET_EXP_ERR", results[0]->GetUncertainty(SFResultTypeNum::kMLROffset)},
+        {"POSITION_RES", results[1]->GetValue(SFResultTypeNum::kPositionRes)},
+        {"POSITION_RES_ERR", results[1]->GetUncertainty(SFResultTypeNum::kPositionRes)},
+        {"POSITION_RES_ALL", fwhm_corr_all},
+        {"POSITION_RES_ALL_ERR", fwhm_corr_all_err}};
+
+    std::cout << "----- posreco writing..." << std::endl;
+    SFResultsSink* sink = SFResultsSink::Open(dbname_full);
+    bool           stat = (sink != nullptr) && sink->Save(table, seriesNo, fname_full, values);
+
+    if (!stat)
     {
-        std::cout << "----- posreco writing, try number " << (max_tries - i_try) + 1 << std::endl;
-        stat = SFTools::SaveResultsDB(dbname_full, table, query, seriesNo);
-        
-        if (stat) break;
-        
-        --i_try;
-        wait = rand() % 10 + 1;
-        std::cout << "----- posreco writing, database locked..." << std::endl;
-        std::cout << "----- waiting " << wait << " s" << std::endl;
-        sleep(wait);
-    } while (i_try > 0);
+        std::cerr << "##### Error in posreco.cc! Results not saved in the data base!"
+                  << std::endl;
+    }
     
     for (auto h : hPosDistCorr)
         delete h;
     
-    delete data;
     delete reco;
+    context->Release();
     
     return 0;
 }
+
+#ifndef SF_BATCH
+int main(int argc, char** argv)
+{
+
+    TString outdir;
+    TString dbase;
+    int     seriesNo = -1;
+
+    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
+    if (ret != 0) exit(ret);
+
+    if (argc < 2)
+    {
+        std::cout << "to run type: ./reco seriesNo";
+        std::cout << "-out path/to/output -db database" << std::endl;
+        return 1;
+    }
+
+    return run_posreco(seriesNo, outdir, dbase);
+}
+#endif /* SF_BATCH */
@@ -10,6 +10,8 @@
 
 #include "SFData.hh"
 #include "SFPositionRes.hh"
+#include "SFResultsSink.hh"
+#include "analyses.h"
 #include "common_options.h"
 
 #include <TCanvas.h>
@@ -22,23 +24,8 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
-int main(int argc, char** argv)
+int run_posres(int seriesNo, TString outdir, TString dbase)
 {
-
-    TString outdir;
-    TString dbase;
-    int     seriesNo = -1;
-
-    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
-    if (ret != 0) exit(ret);
-
-    if (argc < 2)
-    {
-        std::cout << "to run type: ./posres seriesNo";
-        std::cout << "-out path/to/output -db database" << std::endl;
-        return 1;
-    }
-
     SFData* data;
     try
     {
@@ -488,38 +475,25 @@ int main(int argc, char** argv)
 
     //----- writing results to the data base
     TString table = "POSITION_RESOLUTION";
-    TString query = Form("INSERT OR REPLACE INTO %s (SERIES_ID, RESULTS_FILE, POSITION_RES_POL3, "
-                    "POSITION_RES_POL3_ERR, POSITION_RES_POL3_ALL, POSITION_RES_POL3_ALL_ERR, "
-                    "POSITION_RES_POL1, POSITION_RES_POL1_ERR, POSITION_RES_POL1_ALL, "
-                    "POSITION_RES_POL1_ALL_ERR) VALUES(%i, '%s', %f, %f, %f, %f, %f, %f, %f, %f)", 
-                    table.Data(), seriesNo, fname_full.Data(), 
-                    results[1]->GetValue(SFResultTypeNum::kPositionRes),
-                    results[1]->GetUncertainty(SFResultTypeNum::kPositionRes),
-                    fwhm_all_pol3, fwhm_all_pol3_err,
-                    results[0]->GetValue(SFResultTypeNum::kPositionRes),
-                    results[0]->GetUncertainty(SFResultTypeNum::kPositionRes),
-                    fwhm_all_pol1, fwhm_all_pol1_err);
-
-    const int max_tries = 20;
-    int       i_try     = max_tries;
-    float     wait      = 0;
-    bool      stat      = false;
-
-    srand(time(NULL));
-
-    do
+    std::vector<std::pair<TString, double>> values = {
+        {"POSITION_RES_POL3", results[1]->GetValue(SFResultTypeNum::kPositionRes)},
+        {"POSITION_RES_POL3_ERR", results[1]->GetUncertainty(SFResultTypeNum::kPositionRes)},
+        {"POSITION_RES_POL3_ALL", fwhm_all_pol3},
+        {"POSITION_RES_POL3_ALL_ERR", fwhm_all_pol3_err},
+        {"POSITION_RES_POL1", results[0]->GetValue(SFResultTypeNum::kPositionRes)},
+        {"POSITION_RES_POL1_ERR", results[0]->GetUncertainty(SFResultTypeNum::kPositionRes)},
+        {"POSITION_RES_POL1_ALL", fwhm_all_pol1},
+        {"POSITION_RES_POL1_ALL_ERR", fwhm_all_pol1_err}};
+
+    std::cout << "----- posres writing..." << std::endl;
+    SFResultsSink* sink = SFResultsSink::Open(dbname_full);
+    bool           stat = (sink != nullptr) && sink->Save(table, seriesNo, fname_full, values);
+
+    if (!stat)
     {
-        std::cout << "----- posres writing, try number " << (max_tries - i_try) + 1 << std::endl;
-        stat = SFTools::SaveResultsDB(dbname_full, table, query, seriesNo);
-
-        if (stat) break;
-
-        --i_try;
-        wait = rand() % 10 + 1;
-        std::cout << "----- posres writing, database locked..." << std::endl;
-        std::cout << "----- waiting " << wait << " s" << std::endl;
-        sleep(wait);
-    } while (i_try > 0);
+        std::cerr << "##### Error in posres.cc! Results not saved in the data base!"
+                  << std::endl;
+    }
 
     for (auto h : hPosRecoPol3)
         delete h;
@@ -527,9 +501,6 @@ int main(int argc, char** argv)
     for (auto h : hPosRecoPol1)
         delete h;
     
-    for (auto h : spec)
-        delete h;
-    
     for (auto pf : peakFinAv)
         delete pf;
     
@@ -538,3 +509,25 @@ int main(int argc, char** argv)
 
     return 0;
 }
+
+#ifndef SF_BATCH
+int main(int argc, char** argv)
+{
+
+    TString outdir;
+    TString dbase;
+    int     seriesNo = -1;
+
+    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
+    if (ret != 0) exit(ret);
+
+    if (argc < 2)
+    {
+        std::cout << "to run type: ./posres seriesNo";
+        std::cout << "-out path/to/output -db database" << std::endl;
+        return 1;
+    }
+
+    return run_posres(seriesNo, outdir, dbase);
+}
+#endif /* SF_BATCH */
@@ -9,8 +9,10 @@
 // *****************************************
 
 #include "SFData.hh"
+#include "SFResultsSink.hh"
 #include "SFStabilityMon.hh"
 #include "SFTools.hh"
+#include "analyses.h"
 #include "common_options.h"
 
 #include <TCanvas.h>
@@ -21,22 +23,8 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
-int main(int argc, char** argv)
+int run_stability(int seriesNo, TString outdir, TString dbase)
 {
-    TString outdir;
-    TString dbase;
-    int     seriesNo = -1;
-
-    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
-    if (ret != 0) exit(ret);
-
-    if (argc < 2)
-    {
-        std::cout << "to run type: ./stability seriesNo";
-        std::cout << "-out path/to/output -db database" << std::endl;
-        return 1;
-    }
-
     SFData* data;
     try
     {
@@ -254,38 +242,45 @@ int main(int argc, char** argv)
 
     //----- writing results to the data base
     TString table = "STABILITY_MON";
-    TString query = Form("INSERT OR REPLACE INTO %s (SERIES_ID, RESULTS_FILE, CH0_MEAN, "
-                         "CH0_STDDEV, CH1_MEAN, CH1_STDDEV) VALUES (%i, '%s', %f, %f, %f, "
-                         "%f)",
-                         table.Data(), seriesNo, fname_full.Data(),
-                         results[0]->GetValue(SFResultTypeNum::kAveragePeakPos),
-                         results[0]->GetUncertainty(SFResultTypeNum::kAveragePeakPos),
-                         results[1]->GetValue(SFResultTypeNum::kAveragePeakPos),
-                         results[1]->GetUncertainty(SFResultTypeNum::kAveragePeakPos));
-
-    const int max_tries = 20;
-    int       i_try     = max_tries;
-    float     wait      = 0;
-    bool      stat      = false;
-
-    srand(time(NULL));
-
-    do
-    {
-        std::cout << "----- stability writing, try number " << (max_tries - i_try) + 1 << std::endl;
-        stat = SFTools::SaveResultsDB(dbname_full, table, query, seriesNo);
+    std::vector<std::pair<TString, double>> values = {
+        {"CH0_MEAN", results[0]->GetValue(SFResultTypeNum::kAveragePeakPos)},
+        {"CH0_STDDEV", results[0]->GetUncertainty(SFResultTypeNum::kAveragePeakPos)},
+        {"CH1_MEAN", results[1]->GetValue(SFResultTypeNum::kAveragePeakPos)},
+        {"CH1_STDDEV", results[1]->GetUncertainty(SFResultTypeNum::kAveragePeakPos)}};
 
-        if (stat) break;
+    std::cout << "----- stability writing..." << std::endl;
+    SFResultsSink* sink = SFResultsSink::Open(dbname_full);
+    bool           stat = (sink != nullptr) && sink->Save(table, seriesNo, fname_full, values);
 
-        --i_try;
-        wait = rand() % 10 + 1;
-        std::cout << "----- stability writing, database locked..." << std::endl;
-        std::cout << "----- waiting " << wait << " s" << std::endl;
-        sleep(wait);
-    } while (i_try > 0);
+    if (!stat)
+    {
+        std::cerr << "##### Error in stability.cc! Results not saved in the data base!"
+                  << std::endl;
+    }
 
     delete data;
     delete stab;
 
     return 0;
 }
+
+#ifndef SF_BATCH
+int main(int argc, char** argv)
+{
+    TString outdir;
+    TString dbase;
+    int     seriesNo = -1;
+
+    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
+    if (ret != 0) exit(ret);
+
+    if (argc < 2)
+    {
+        std::cout << "to run type: ./stability seriesNo";
+        std::cout << "-out path/to/output -db database" << std::endl;
+        return 1;
+    }
+
+    return run_stability(seriesNo, outdir, dbase);
+}
+#endif /* SF_BATCH */
@@ -9,31 +9,18 @@
 // *****************************************
 
 #include "SFFitResults.hh"
+#include "SFResultsSink.hh"
 #include "SFTimeConst.hh"
 #include "TCanvas.h"
 #include "TLatex.h"
 #include "TLegend.h"
+#include "analyses.h"
 #include "common_options.h"
 #include <sys/stat.h>
 #include <sys/types.h>
 
-int main(int argc, char** argv)
+int run_tconst(int seriesNo, TString outdir, TString dbase)
 {
-
-    TString outdir;
-    TString dbase;
-    int     seriesNo = -1;
-
-    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
-    if (ret != 0) exit(ret);
-
-    if (argc < 2)
-    {
-        std::cout << "to run type: ./tconst seriesNo";
-        std::cout << "-out path/to/output -db database" << std::endl;
-        return 1;
-    }
-
     SFData* data;
     try
     {
@@ -207,40 +194,48 @@ int main(int argc, char** argv)
 
     //----- writing results to the data base
     TString table = "TIME_CONSTANTS";
-    TString query =
-        Form("INSERT OR REPLACE INTO %s (SERIES_ID, RESULTS_FILE, FAST_DEC, FAST_DEC_ERR, "
-             "SLOW_DEC, SLOW_DEC_ERR, IFAST, ISLOW) VALUES (%i, '%s', %f, %f, %f, %f, %f, %f)",
-             table.Data(), seriesNo, fname_full.Data(),
-             results->GetValue(SFResultTypeNum::kFastDecay),
-             results->GetUncertainty(SFResultTypeNum::kFastDecay),
-             results->GetValue(SFResultTypeNum::kSlowDecay),
-             results->GetUncertainty(SFResultTypeNum::kSlowDecay),
-             results->GetValue(SFResultTypeNum::kIFast),
-             results->GetValue(SFResultTypeNum::kISlow));
-
-    const int max_tries = 20;
-    int       i_try     = max_tries;
-    float     wait      = 0;
-    bool      stat      = false;
-
-    srand(time(NULL));
-
-    do
+    std::vector<std::pair<TString, double>> values = {
+        {"FAST_DEC", results->GetValue(SFResultTypeNum::kFastDecay)},
+        {"FAST_DEC_ERR", results->GetUncertainty(SFResultTypeNum::kFastDecay)},
+        {"SLOW_DEC", results->GetValue(SFResultTypeNum::kSlowDecay)},
+        {"SLOW_DEC_ERR", results->GetUncertainty(SFResultTypeNum::kSlowDecay)},
+        {"IFAST", results->GetValue(SFResultTypeNum::kIFast)},
+        {"ISLOW", results->GetValue(SFResultTypeNum::kISlow)}};
+
+    std::cout << "----- tconst writing..." << std::endl;
+    SFResultsSink* sink = SFResultsSink::Open(dbname_full);
+    bool           stat = (sink != nullptr) && sink->Save(table, seriesNo, fname_full, values);
+
+    if (!stat)
     {
-        std::cout << "----- tconst writing, try number " << (max_tries - i_try) + 1 << std::endl;
-        stat = SFTools::SaveResultsDB(dbname_full, table, query, seriesNo);
-
-        if (stat) break;
-
-        --i_try;
-        wait = rand() % 10 + 1;
-        std::cout << "----- tconst writing, database locked..." << std::endl;
-        std::cout << "----- waiting " << wait << " s" << std::endl;
-        sleep(wait);
-    } while (i_try > 0);
+        std::cerr << "##### Error in tconst.cc! Results not saved in the data base!"
+                  << std::endl;
+    }
 
     delete tconst;
     delete data;
 
     return 0;
 }
+
+#ifndef SF_BATCH
+int main(int argc, char** argv)
+{
+
+    TString outdir;
+    TString dbase;
+    int     seriesNo = -1;
+
+    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
+    if (ret != 0) exit(ret);
+
+    if (argc < 2)
+    {
+        std::cout << "to run type: ./tconst seriesNo";
+        std::cout << "-out path/to/output -db database" << std::endl;
+        return 1;
+    }
+
+    return run_tconst(seriesNo, outdir, dbase);
+}
+#endif /* SF_BATCH */
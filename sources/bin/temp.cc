@@ -8,33 +8,20 @@
 // *                                       *
 // *****************************************
 
+#include "SFResultsSink.hh"
 #include "SFTemperature.hh"
 #include "TCanvas.h"
 #include "TFile.h"
 #include "TLatex.h"
 #include "TLegend.h"
 #include "TLine.h"
+#include "analyses.h"
 #include "common_options.h"
 #include <sys/stat.h>
 #include <sys/types.h>
 
-int main(int argc, char** argv)
+int run_temp(int seriesNo, TString outdir, TString dbase)
 {
-
-    TString outdir;
-    TString dbase;
-    int     seriesNo = -1;
-
-    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
-    if (ret != 0) exit(ret);
-
-    if (argc < 2)
-    {
-        std::cout << "to run type: ./temp seriesNo ";
-        std::cout << "-out path/to/output -db database" << std::endl;
-        return 1;
-    }
-
     SFData* data;
 
     try
@@ -187,43 +174,53 @@ int main(int argc, char** argv)
 
     //----- writing results to the data base
     TString table = "TEMPERATURE";
-    query = Form("INSERT OR REPLACE INTO %s (SERIES_ID, RESULTS_FILE, OUT_ID, OUT_TEMP, OUT_ERR, "
-                 "REF_ID, REF_TEMP, REF_ERR, CH0_ID, CH0_TEMP, CH0_ERR, CH1_ID, CH1_TEMP, CH1_ERR) "
-                 "VALUES (%i, '%s', '%s', %f, %f, '%s', %f, %f, '%s', %f, %f, '%s', %f, %f)",
-                 table.Data(), seriesNo, fname_full.Data(),
-                 sensorIDs[0].Data(),
-                 results[0]->GetValue(SFResultTypeNum::kTemp),
-                 results[0]->GetUncertainty(SFResultTypeNum::kTemp),
-                 sensorIDs[1].Data(),
-                 results[1]->GetValue(SFResultTypeNum::kTemp),
-                 results[1]->GetUncertainty(SFResultTypeNum::kTemp),
-                 sensorIDs[2].Data(),
-                 results[2]->GetValue(SFResultTypeNum::kTemp),
-                 results[2]->GetUncertainty(SFResultTypeNum::kTemp),
-                 sensorIDs[3].Data(),
-                 results[3]->GetValue(SFResultTypeNum::kTemp),
-                 results[3]->GetUncertainty(SFResultTypeNum::kTemp));
-
-    const int max_tries = 20;
-    int       i_try     = max_tries;
-    float     wait      = 0;
-    bool      stat      = false;
-
-    srand(time(NULL));
-
-    do
+    std::vector<std::pair<TString, double>> values = {
+        {"OUT_TEMP", results[0]->GetValue(SFResultTypeNum::kTemp)},
+        {"OUT_ERR", results[0]->GetUncertainty(SFResultTypeNum::kTemp)},
+        {"REF_TEMP", results[1]->GetValue(SFResultTypeNum::kTemp)},
+        {"REF_ERR", results[1]->GetUncertainty(SFResultTypeNum::kTemp)},
+        {"CH0_TEMP", results[2]->GetValue(SFResultTypeNum::kTemp)},
+        {"CH0_ERR", results[2]->GetUncertainty(SFResultTypeNum::kTemp)},
+        {"CH1_TEMP", results[3]->GetValue(SFResultTypeNum::kTemp)},
+        {"CH1_ERR", results[3]->GetUncertainty(SFResultTypeNum::kTemp)}};
+    std::vector<std::pair<TString, TString>> text = {
+        {"OUT_ID", sensorIDs[0]},
+        {"REF_ID", sensorIDs[1]},
+        {"CH0_ID", sensorIDs[2]},
+        {"CH1_ID", sensorIDs[3]}};
+
+    std::cout << "----- temp writing..." << std::endl;
+    SFResultsSink* sink = SFResultsSink::Open(dbname_full);
+    bool           stat =
+        (sink != nullptr) && sink->Save(table, seriesNo, fname_full, values, text);
+
+    if (!stat)
     {
-        std::cout << "----- temp writing, try number " << (max_tries - i_try) + 1 << std::endl;
-        stat = SFTools::SaveResultsDB(dbname_full, table, query, seriesNo);
+        std::cerr << "##### Error in temp.cc! Results not saved in the data base!"
+                  << std::endl;
+    }
+
+    return 0;
+}
 
-        if (stat) break;
+#ifndef SF_BATCH
+int main(int argc, char** argv)
+{
 
-        --i_try;
-        wait = rand() % 10 + 1;
-        std::cout << "----- temp writing, database locked..." << std::endl;
-        std::cout << "----- waiting " << wait << " s" << std::endl;
-        sleep(wait);
-    } while (i_try > 0);
+    TString outdir;
+    TString dbase;
+    int     seriesNo = -1;
 
-    return 0;
+    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
+    if (ret != 0) exit(ret);
+
+    if (argc < 2)
+    {
+        std::cout << "to run type: ./temp seriesNo ";
+        std::cout << "-out path/to/output -db database" << std::endl;
+        return 1;
+    }
+
+    return run_temp(seriesNo, outdir, dbase);
 }
+#endif /* SF_BATCH */
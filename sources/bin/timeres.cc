@@ -8,7 +8,9 @@
 // *                                       *
 // *****************************************
 
+#include "SFResultsSink.hh"
 #include "SFTimingRes.hh"
+#include "analyses.h"
 #include "common_options.h"
 
 #include <TCanvas.h>
@@ -21,23 +23,8 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
-int main(int argc, char** argv)
+int run_timeres(int seriesNo, TString outdir, TString dbase)
 {
-
-    TString outdir;
-    TString dbase;
-    int     seriesNo = -1;
-
-    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
-    if (ret != 0) exit(ret);
-
-    if (argc < 2)
-    {
-        std::cout << "to run type: ./timeres seriesNo";
-        std::cout << "-out path/to/output -db database" << std::endl;
-        return 1;
-    }
-
     SFData* data;
     try
     {
@@ -445,38 +432,46 @@ int main(int argc, char** argv)
 
     //----- writing results to the data base
     TString table = "TIMING_RESOLUTION";
-    TString query =
-        Form("INSERT OR REPLACE INTO %s (SERIES_ID, RESULTS_FILE, TIMERES, TIMERES_ERR, "
-             "TIMERES_ECUT, TIMERES_ECUT_ERR) VALUES(%i, '%s', %f, %f, %f, %f)",
-             table.Data(), seriesNo, fname_full.Data(), 
-             results[0]->GetValue(SFResultTypeNum::kTimeRes),
-             results[0]->GetUncertainty(SFResultTypeNum::kTimeRes),
-             results[1]->GetValue(SFResultTypeNum::kTimeRes),
-             results[1]->GetUncertainty(SFResultTypeNum::kTimeRes));
-
-    const int max_tries = 20;
-    int       i_try     = max_tries;
-    float     wait      = 0;
-    bool      stat      = false;
-
-    srand(time(NULL));
-
-    do
-    {
-        std::cout << "----- timeres writing, try number " << (max_tries - i_try) + 1 << std::endl;
-        stat = SFTools::SaveResultsDB(dbname_full, table, query, seriesNo);
+    std::vector<std::pair<TString, double>> values = {
+        {"TIMERES", results[0]->GetValue(SFResultTypeNum::kTimeRes)},
+        {"TIMERES_ERR", results[0]->GetUncertainty(SFResultTypeNum::kTimeRes)},
+        {"TIMERES_ECUT", results[1]->GetValue(SFResultTypeNum::kTimeRes)},
+        {"TIMERES_ECUT_ERR", results[1]->GetUncertainty(SFResultTypeNum::kTimeRes)}};
 
-        if (stat) break;
+    std::cout << "----- timeres writing..." << std::endl;
+    SFResultsSink* sink = SFResultsSink::Open(dbname_full);
+    bool           stat = (sink != nullptr) && sink->Save(table, seriesNo, fname_full, values);
 
-        --i_try;
-        wait = rand() % 10 + 1;
-        std::cout << "----- timeres writing, database locked..." << std::endl;
-        std::cout << "----- waiting " << wait << " s" << std::endl;
-        sleep(wait);
-    } while (i_try > 0);
+    if (!stat)
+    {
+        std::cerr << "##### Error in timeres.cc! Results not saved in the data base!"
+                  << std::endl;
+    }
 
     delete timeres;
     delete data;
 
     return 0;
 }
+
+#ifndef SF_BATCH
+int main(int argc, char** argv)
+{
+
+    TString outdir;
+    TString dbase;
+    int     seriesNo = -1;
+
+    int ret = parse_common_options(argc, argv, outdir, dbase, seriesNo);
+    if (ret != 0) exit(ret);
+
+    if (argc < 2)
+    {
+        std::cout << "to run type: ./timeres seriesNo";
+        std::cout << "-out path/to/output -db database" << std::endl;
+        return 1;
+    }
+
+    return run_timeres(seriesNo, outdir, dbase);
+}
+#endif /* SF_BATCH */
@@ -8,6 +8,7 @@
 #pragma link C++ class SFPeakFinder+;
 #pragma link C++ class SFFitResults+;
 #pragma link C++ class SFData+;
+#pragma link C++ struct SFHistRequest+;
 #pragma link C++ class SFAttenuation+;
 #pragma link C++ class SFTimingRes+;
 #pragma link C++ class SFEnergyRes+;
@@ -20,5 +21,19 @@
 #pragma link C++ class SFEnergyReco+;
 #pragma link C++ class SFPositionReco+;
 #pragma link C++ class SFResults+;
+#pragma link C++ class SFCut+;
+#pragma link C++ class SFSeriesContext+;
+#pragma link C++ class SFWaveformReader+;
+#pragma link C++ class SFEventCache+;
+#pragma link C++ class SFRecoKernel+;
+#pragma link C++ class SFFitParamStore+;
+#pragma link C++ class SFResultsSink+;
+#pragma link C++ class SFFilePool+;
+#pragma link C++ class SFDecayFitter+;
+#pragma link C++ class SFPeakFitter+;
+#pragma link C++ class SFHistCache+;
+#pragma link C++ class SFCorrHist+;
+#pragma link C++ class SFAachenReader+;
+#pragma link C++ class SFPrefetcher+;
 
 #endif
@@ -0,0 +1,66 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *          SFAachenReader.hh            *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#ifndef __SFAachenReader_H_
+#define __SFAachenReader_H_ 1
+
+#include "DDSignal.hh"
+
+#include <TBranch.h>
+#include <TFile.h>
+#include <TObject.h>
+#include <TString.h>
+#include <TTree.h>
+#include <TVectorT.h>
+
+#include <iostream>
+
+/// Class providing access to the data recorded with the Aachen test bench
+/// (DesktopDigitizer6-based): parameters of signals (tree_ft in results.root)
+/// and their waveforms (wavetree in waves.root). Both files of the measurement
+/// are opened once and kept open until the reader is deleted. Only branches
+/// of the selected channel are read, through TTreeCache, so that entries read
+/// in order are fetched in large blocks. Signal and waveform objects are
+/// allocated once and reused for all entries.
+
+class SFAachenReader : public TObject
+{
+
+  private:
+    TString          fDirectory; ///< Directory of the measurement
+    int              fChannel;   ///< Channel whose branches are read, -1 if not set
+    TFile*           fFile;      //! File with parameters of signals (results.root)
+    TFile*           fWaveFile;  //! File with waveforms (waves.root)
+    TTree*           fTree;      //! Tree with parameters of signals
+    TTree*           fWaveTree;  //! Tree with waveforms
+    DDSignal*        fSignal;    //! Signal of the current entry
+    TVectorT<float>* fVoltages;  //! Waveform of the current entry
+
+    bool SelectBranch(TTree* tree, TString bname, void* address);
+
+  public:
+    SFAachenReader(TString directory);
+    ~SFAachenReader();
+
+    bool                   SetChannel(int ch);
+    DDSignal*              GetSignal(Long64_t entry);
+    const TVectorT<float>* GetWaveform(Long64_t entry);
+
+    /// Returns number of entries (recorded events).
+    Long64_t GetEntries(void) { return fTree->GetEntries(); };
+    /// Returns channel whose branches are read.
+    int GetChannel(void) { return fChannel; };
+
+    void Print(void);
+
+    ClassDef(SFAachenReader, 1)
+};
+
+#endif /* __SFAachenReader_H_ */
@@ -14,6 +14,7 @@
 #include "SFData.hh"
 #include "SFPeakFinder.hh"
 #include "SFResults.hh"
+#include "SFSeriesContext.hh"
 
 #include <TF1.h>
 #include <TGraphErrors.h>
@@ -70,8 +71,10 @@ class SFAttenuation : public TObject
 {
 
   private:
-    int     fSeriesNo; ///< Number of experimental series to be analyzed
-    SFData* fData;     ///< SFData object of the analyzed series
+    int              fSeriesNo; ///< Number of experimental series to be analyzed
+    SFSeriesContext* fContext;  ///< Shared context of the analyzed series
+    bool             fRetained; ///< Flag indicating whether fContext is retained by this object
+    SFData*          fData;     ///< SFData object of the analyzed series (owned by fContext)
 
     std::vector<TH1D*> fRatios;     ///< Vector containing histograms of ln(M_LR) distributions
     std::vector<TH1D*> fSpectraCh0; ///< Vector containing charge spectra from channel 0
@@ -91,8 +94,11 @@ class SFAttenuation : public TObject
     SFResults* fResultsCombPol3; ///< Results of combined channels analysis (fitting pol3)
     SFResults* fResultsExpSim;   ///< Results of simultaneous fitting of exponential model
 
+    bool Init(void);
+
   public:
     SFAttenuation(int seriesNo);
+    SFAttenuation(SFSeriesContext* context, bool retain = true);
     ~SFAttenuation();
 
     bool AttCombinedCh(void);
@@ -13,7 +13,9 @@
 
 #include "SFAttenuation.hh"
 #include "SFData.hh"
+#include "SFRecoKernel.hh"
 #include "SFResults.hh"
+#include "SFSeriesContext.hh"
 
 #include <Fit/BinData.h>
 #include <Fit/Chi2FCN.h>
@@ -69,8 +71,10 @@ class SFAttenuationModel : public TObject
 {
 
   private:
-    int     fSeriesNo; ///< Number of experimental series
-    SFData* fData;     ///< SFData object of the experimental series
+    int              fSeriesNo; ///< Number of experimental series
+    SFSeriesContext* fContext;  ///< Shared context of the experimental series
+    bool             fRetained; ///< Flag indicating whether fContext is retained by this object
+    SFData*          fData;     ///< SFData object of the experimental series (owned by fContext)
 
     TGraphErrors* fMAttCh0Graph;     ///< Experimental attenuation curve ch0
     TGraphErrors* fMAttCh1Graph;     ///< Experimental attenuation curve ch1
@@ -84,16 +88,27 @@ class SFAttenuationModel : public TObject
     
     SFResults*            fResults;       ///< Analysis results
     ROOT::Fit::FitResult* fFitterResults; ///< Fitting results
+    SFRecoKernel*         fKernel;        ///< Uncertainty evaluator bound to the fit results
+
+    bool Init(void);
 
   public:
     SFAttenuationModel(int seriesNo);
+    SFAttenuationModel(SFSeriesContext* context, bool retain = true);
     ~SFAttenuationModel();
 
-    double CalculateUncertainty(std::vector<double> params, TString side);
+    double CalculateUncertainty(const std::vector<double>& params, TString side);
+    void   CalculateUncertainty(double SL, double SR, double sigmaSL, double sigmaSR,
+                                double& PlErr, double& PrErr);
     bool   FitModel(void);
 
     /// Returns results of the analysis.
     SFResults* GetResults(void) { return fResults; };
+    /// Returns covariance matrix of the fitted model parameters.
+    TMatrixD GetCovMatrix(void) { return fCovMatrix; };
+    /// Returns reconstruction kernel bound to the fit results (owned by this
+    /// object). Available after FitModel() has been called.
+    SFRecoKernel* GetRecoKernel(void) { return fKernel; };
 
     void Print(void);
 
@@ -0,0 +1,89 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *            SFCorrHist.hh              *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#ifndef __SFCorrHist_H_
+#define __SFCorrHist_H_ 1
+
+#include <TH2D.h>
+#include <TNamed.h>
+#include <TString.h>
+
+#include <functional>
+#include <iostream>
+#include <map>
+#include <vector>
+
+/// Compact 2D histogram used for correlation spectra. Bin contents are
+/// stored as floats. As long as only a small fraction of bins is filled,
+/// which is the case for most correlation spectra, only the filled bins
+/// are stored; storage is switched to a dense array of all bins when it
+/// becomes smaller than the sparse one. Histogram can be rebinned in place
+/// and is converted to TH2D only when it is needed, e.g. to be drawn or
+/// written (see ToTH2()). Bins are numbered like in TH2, including
+/// underflow and overflow bins, and statistics are accumulated like by
+/// TH2::Fill(), so that converted histogram is identical to the TH2D
+/// filled with the same data.
+
+class SFCorrHist : public TNamed
+{
+
+  private:
+    int    fNbinsX; ///< Number of bins on X axis
+    double fXmin;   ///< Lower edge of X axis
+    double fXmax;   ///< Upper edge of X axis
+    int    fNbinsY; ///< Number of bins on Y axis
+    double fYmin;   ///< Lower edge of Y axis
+    double fYmax;   ///< Upper edge of Y axis
+
+    double fEntries; ///< Number of entries
+    double fTsumw;   ///< Sum of weights
+    double fTsumw2;  ///< Sum of squares of weights
+    double fTsumwx;  ///< Sum of weight*x
+    double fTsumwx2; ///< Sum of weight*x*x
+    double fTsumwy;  ///< Sum of weight*y
+    double fTsumwy2; ///< Sum of weight*y*y
+    double fTsumwxy; ///< Sum of weight*x*y
+
+    std::map<int, float> fSparse; ///< Contents of filled bins, accessed by global bin number
+    std::vector<float>   fDense;  ///< Contents of all bins, empty if storage is sparse
+
+    int  FindBin(double x, double xmin, double xmax, int nbins) const;
+    void SwitchToDense(void);
+    void ForEachBin(const std::function<void(int bin, float content)>& fun) const;
+    bool GetGroupedAxes(int ngroupx, int ngroupy, int& nbinsx, double& xmax, int& nbinsy,
+                        double& ymax) const;
+
+  public:
+    SFCorrHist();
+    SFCorrHist(TString name, TString title, int nbinsx, double xmin, double xmax,
+               int nbinsy, double ymin, double ymax);
+    ~SFCorrHist();
+
+    void   Fill(double x, double y, double w = 1.);
+    double GetBinContent(int binx, int biny) const;
+    void   Rebin(int ngroupx, int ngroupy);
+    TH2D*  ToTH2(int ngroupx = 1, int ngroupy = 1) const;
+
+    /// Returns number of bins on X axis.
+    int GetNbinsX(void) const { return fNbinsX; };
+    /// Returns number of bins on Y axis.
+    int GetNbinsY(void) const { return fNbinsY; };
+    /// Returns number of entries.
+    double GetEntries(void) const { return fEntries; };
+    /// Returns true if only filled bins are stored.
+    bool IsSparse(void) const { return fDense.empty(); };
+
+    size_t GetMemorySize(void) const;
+    void   Print(void);
+
+    ClassDef(SFCorrHist, 1)
+};
+
+#endif /* __SFCorrHist_H_ */
@@ -0,0 +1,101 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *               SFCut.hh                *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#ifndef __SFCut_H_
+#define __SFCut_H_ 1
+
+#include <TObject.h>
+#include <TString.h>
+
+#include <iostream>
+#include <vector>
+
+struct SFSignal;
+
+/// \file
+/// Enumeration representing operations of the compiled cut.
+
+/// Enumeration representing operations of the compiled cut.
+/// Operations are stored in reverse Polish notation.
+
+enum class SFCutOp
+{
+    kNumber,    ///< pushes constant on the stack
+    kField,     ///< pushes value of the signal field on the stack
+    kNeg,       ///< unary minus
+    kNot,       ///< logical negation
+    kAdd,       ///< addition
+    kSub,       ///< subtraction
+    kMul,       ///< multiplication
+    kDiv,       ///< division
+    kLess,      ///< comparison: <
+    kGreater,   ///< comparison: >
+    kLessEq,    ///< comparison: <=
+    kGreaterEq, ///< comparison: >=
+    kEqual,     ///< comparison: ==
+    kNotEqual,  ///< comparison: !=
+    kAnd,       ///< logical and: &&
+    kOr,        ///< logical or: ||
+    kLog,       ///< natural logarithm
+    kLog10,     ///< decimal logarithm
+    kSqrt,      ///< square root
+    kExp,       ///< exponential function
+    kAbs        ///< absolute value
+};
+
+/// Class representing a compiled logic cut for SFSignal objects. The cut
+/// string is parsed only once, when the cut is set, and stored as a flat
+/// list of operations. Checking whether a signal fulfills the cut costs
+/// then only a few arithmetic operations and comparisons.
+///
+/// Accepted syntax is the same as returned by SFDrawCommands::GetCut(), i.e.:
+/// - signal fields: fAmp, fCharge, fPE, fT0, fTOT, fBL, fBL_sigma, fPileUp and fVeto,
+///   optionally with prefix, e.g. "ch_0.fPE" or "SDDSamples.data.signal_r.fPE";
+///   fields of the right signal are selected with the "signal_r" prefix
+/// - PMI fields: qdc_l, qdc_r (mapped on fCharge) and time_l, time_r (mapped on fT0)
+/// - module number: "module", e.g. "SDDSamples.data.module==0"
+/// - arithmetic operators: +, -, *, /
+/// - functions: log, log10, sqrt, exp and abs
+/// - comparisons: <, >, <=, >=, == and !=
+/// - logic operators: &&, || and !
+/// - parentheses
+///
+/// Empty cut is always fulfilled.
+
+class SFCut : public TObject
+{
+
+  private:
+    TString              fCut;    ///< Cut string
+    std::vector<SFCutOp> fOps;    ///< Compiled cut (reverse Polish notation)
+    std::vector<double>  fValues; ///< Constants or field codes of the operations
+    int                  fDepth;  ///< Required depth of the evaluation stack
+
+    double GetField(int code, const SFSignal* sigL, const SFSignal* sigR, int module) const;
+
+  public:
+    SFCut();
+    SFCut(TString cut);
+    ~SFCut();
+
+    bool SetCut(TString cut);
+    bool Evaluate(const SFSignal* sig, int module = 0) const;
+    bool Evaluate(const SFSignal* sigL, const SFSignal* sigR, int module) const;
+    void Print(void);
+
+    /// Returns cut string.
+    TString GetCut(void) { return fCut; };
+    /// Returns number of operations in the compiled cut.
+    int GetNops(void) { return fOps.size(); };
+
+    ClassDef(SFCut, 1)
+};
+
+#endif /* __SFCut_H_ */
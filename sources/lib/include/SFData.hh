@@ -14,8 +14,14 @@
 #include "DDSignal.hh"
 #include "SCategoryManager.h"
 #include "SDDSamples.h"
+#include "SFAachenReader.hh"
+#include "SFCorrHist.hh"
+#include "SFCut.hh"
 #include "SFDrawCommands.hh"
+#include "SFEventCache.hh"
+#include "SFPrefetcher.hh"
 #include "SFTools.hh"
+#include "SFWaveformReader.hh"
 #include "SFibersCal.h"
 #include "SFibersRaw.h"
 #include "SLoop.h"
@@ -27,12 +33,15 @@
 #include <TProfile.h>
 #include <TString.h>
 #include <TTree.h>
+#include <TTreeFormula.h>
+#include <TTreeFormulaManager.h>
 #include <TVectorT.h>
 
 #include <assert.h>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <sqlite3.h>
 #include <stdlib.h>
 #include <string>
@@ -45,7 +54,9 @@
 
 /// Structure representing recorded signal. It allows to convert
 /// DDSignal and SDDSignal type obcjects into universal type for
-/// the purpuse of the analysis. 
+/// the purpuse of the analysis. Signals are filled in place, with
+/// SFData::ConvertSignal() or SFEventCache::GetSignal(), so that
+/// a single object can be reused for all events.
 
 struct SFSignal
 {
@@ -72,6 +83,36 @@ struct SFSignal
     }
 };
 
+/// Structure representing a request for histograms booked in SFData
+/// for the single-pass filling. One histogram per measurement is
+/// created for each request when SFData::FillBookedHistograms() is called.
+
+struct SFHistRequest
+{
+    int                  fCh      = -1;                   ///< Channel number (-1 if not applicable)
+    SFSelectionType      fSelType = SFSelectionType::kPE; ///< Selection type (see SFDrawCommands)
+    TString              fCut     = "";                   ///< Cut (syntax like for TTree::Draw())
+    std::vector<double>  fCustomNum;                      ///< Numbers for custom selections
+    bool                 fChName  = false;                ///< Flag indicating whether channel
+                                                          ///< number is part of the name
+    bool                 fCorr    = false;                ///< Flag indicating 2D histogram
+    std::vector<TNamed*> fHists;                          ///< Filled histograms, one per
+                                                          ///< measurement (TH1D or SFCorrHist)
+};
+
+/// Structure representing a request for an averaged signal. Many requests,
+/// e.g. for different channels and PE windows, are filled in a single scan
+/// of the measurement with SFData::GetSignalAverages().
+
+struct SFSignalRequest
+{
+    int       fCh     = 0;       ///< Channel number
+    TString   fCut    = "";      ///< Cut (syntax explained in SFCut class)
+    int       fNumber = 0;       ///< Number of signals to be averaged
+    bool      fBL     = true;    ///< Flag for base line subtraction
+    TProfile* fSignal = nullptr; ///< Averaged signal
+};
+
 /// Class to access experiemntal data. Information about an experimental
 /// series and all measurements is loaded from the SQLite3 data base.
 /// Subsequently requested data is accessed from ROOT files and binary
@@ -80,6 +121,10 @@ struct SFSignal
 /// type. All possible selections for histograms are defined in SFDrawCommands
 /// class. Single signals and averaged signals are also possible to access.
 /// Cutting functionality based on ROOT's TTree for all has been implemented.
+/// Histograms drawn from the ROOT files are stored in SFHistCache and reused
+/// by subsequent calls, also in other processes. When data of a measurement
+/// is accessed, files of the next measurements are read in the background
+/// (see SFPrefetcher).
 
 class SFData : public TObject
 {
@@ -99,9 +144,10 @@ class SFData : public TObject
     TString  fLogFile;       ///< Name of measurment log file
     TString  fTempFile;      ///< Name of temperature log file
     TString  fDAQ;           ///< DAQ
-    sqlite3* fDB;            ///< SQLite3 data base
+    sqlite3* fDB;            ///< SQLite3 data base, connection shared by all SFData objects
 
-    std::vector<TFile*>  fFiles;     ///< Vector containing ROOT files with experimental data
+    std::vector<TString> fFiles;     ///< Vector containing names of ROOT files with
+                                     ///< experimental data (opened via SFFilePool)
     std::vector<TString> fNames;     ///< Vector containing names of measurements
     std::vector<double>  fPositions; ///< Vector containing positions of radioactive source [mm]
     std::vector<int>     fMeasureID; ///< Vector containing IDs of measurements
@@ -111,15 +157,21 @@ class SFData : public TObject
     std::vector<int> fStop;          ///< Vector containing stopping times of measurements 
                                      ///< (in UNIX time)
 
-    int gUnique = 0.;                ///< Unique flag to identify temporary histograms
+    std::vector<SFHistRequest> fRequests; ///< Histograms booked for the single-pass filling
 
-    SFSignal* ConvertSignal(DDSignal* sig);
-    SFSignal* ConvertSignal(SDDSignal* sig);
-    bool      InterpretCut(SFSignal* sig, TString cut);
-    TProfile* GetSignalAverageKrakow(int ch, int ID, TString cut, int number, bool bl);
-    TProfile* GetSignalAverageAachen(int ch, int ID, TString cut, int number);
-    TH1D*     GetSignalKrakow(int ch, int ID, TString cut, int number, bool bl);
-    TH1D*     GetSignalAachen(int ch, int ID, TString cut, int number);
+    std::map<TString, std::vector<int>> fSignalIndex;   ///< Events with signals fulfilling cuts
+    std::map<int, SFEventCache*>        fEventCache;    ///< Event caches of measurements
+    std::map<int, SFAachenReader*>      fAachenReaders; ///< Readers of Aachen measurements
+
+    TProfile*        GetSignalAverageKrakow(int ch, int ID, TString cut, int number, bool bl);
+    TProfile*        GetSignalAverageAachen(int ch, int ID, TString cut, int number);
+    bool             GetSignalAveragesKrakow(int ID, std::vector<SFSignalRequest>& requests);
+    TH1D*            GetSignalKrakow(int ch, int ID, TString cut, int number, bool bl);
+    TH1D*            GetSignalAachen(int ch, int ID, TString cut, int number);
+    std::vector<int> GetSignalIndexKrakow(int ch, int ID, TString cut);
+    bool             FillRequests(std::vector<SFHistRequest>& requests, int index = -1);
+    TFile*           AcquireFile(int index);
+    void             Prefetch(int index, TString fname, TString alternative = "");
 
   public:
     SFData();
@@ -129,22 +181,40 @@ class SFData : public TObject
     bool               OpenFiles(void);
     bool               OpenDataBase(TString name);
     bool               SetDetails(int seriesNo);
-    SLoop*             GetTree(int ID);
+    SLoop*             GetTree(int ID, const std::vector<TString>& branches = {});
+    SFEventCache*      GetEventCache(int ID);
+    SFAachenReader*    GetAachenReader(int ID);
     TH1D*              GetSpectrum(int ch, SFSelectionType sel_type, TString cut, int ID);
     TH1D*              GetCustomHistogram(SFSelectionType sel_type, TString cut, int ID,
                                           std::vector<double> customNum = {});
     TH1D*              GetCustomHistogram(int ch, SFSelectionType sel_type, TString cut, int ID,
                                           std::vector<double> customNum);
-    TH2D*              GetCorrHistogram(SFSelectionType sel_type, TString cut, int ID, int ch = -1);
-    TH2D*              GetRefCorrHistogram(int ID, int ch);
+    SFCorrHist*        GetCorrHistogram(SFSelectionType sel_type, TString cut, int ID,
+                                        int ch = -1);
+    SFCorrHist*        GetRefCorrHistogram(int ID, int ch);
     std::vector<TH1D*> GetSpectra(int ch, SFSelectionType sel_type, TString cut);
     std::vector<TH1D*> GetCustomHistograms(SFSelectionType sel_type, TString cut);
-    std::vector<TH2D*> GetCorrHistograms(SFSelectionType sel_type, TString cut, int ch = -1);
-    std::vector<TH2D*> GetRefCorrHistograms(int ch);
+    std::vector<SFCorrHist*> GetCorrHistograms(SFSelectionType sel_type, TString cut,
+                                               int ch = -1);
+    std::vector<SFCorrHist*> GetRefCorrHistograms(int ch);
+    int                BookSpectra(int ch, SFSelectionType sel_type, TString cut);
+    int                BookCustomHistograms(SFSelectionType sel_type, TString cut,
+                                            std::vector<double> customNum = {});
+    int                BookCorrHistograms(SFSelectionType sel_type, TString cut, int ch = -1);
+    bool               FillBookedHistograms(void);
+    std::vector<TH1D*> GetBookedHistograms(int request);
+    std::vector<SFCorrHist*> GetBookedCorrHistograms(int request);
+    void               ClearBookings(void);
     TProfile*          GetSignalAverage(int ch, int ID, TString cut, int number, bool bl);
+    bool               GetSignalAverages(int ID, std::vector<SFSignalRequest>& requests);
     TH1D*              GetSignal(int ch, int ID, TString cut, int number, bool bl);
+    bool               InvalidateHistCache(void);
     void               Print(void);
 
+    static void ConvertSignal(DDSignal* sig, SFSignal& converted);
+    static void ConvertSignal(SDDSignal* sig, SFSignal& converted);
+    static void ConvertSignal(SFibersRaw* hit, int side, SFSignal& converted);
+
     /// Returns number of measurements in the series.
     int GetNpoints(void) { return fNpoints; };
     /// Returns fiber type.
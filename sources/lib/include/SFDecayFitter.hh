@@ -0,0 +1,70 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *           SFDecayFitter.hh            *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#ifndef __SFDecayFitter_H_
+#define __SFDecayFitter_H_ 1
+
+#include <TObject.h>
+#include <TProfile.h>
+
+#include <iostream>
+#include <vector>
+
+/// Structure containing results of the fit performed with SFDecayFitter.
+/// Parameters are ordered like in the functions fitted in SFTimeConst, i.e.
+/// A, t0, tau, const for the single decay and A_fast, t0, tau_fast, A_slow,
+/// tau_slow, const for the double decay. Time offset and constant are fixed
+/// in the fit, so their uncertainties are 0.
+
+struct SFDecayFitResult
+{
+    int                 fStat    = -1; ///< Fit status: 0 - converged, otherwise failed
+    double              fChi2    = -1; ///< Chi2 of the fit
+    int                 fNDF     = -1; ///< Number of degrees of freedom
+    int                 fNpoints = 0;  ///< Number of fitted bins
+    double              fXmin    = 0;  ///< Lower edge of the fitting range
+    double              fXmax    = 0;  ///< Upper edge of the fitting range
+    std::vector<double> fParameters;   ///< Fitted parameters
+    std::vector<double> fParErrors;    ///< Uncertainties of the fitted parameters
+};
+
+/// Fitter of the falling slope of averaged signals, used by SFTimeConst.
+/// Sum of one or two exponential decays and a constant is fitted with the
+/// Levenberg-Marquardt algorithm with analytic derivatives. Amplitudes enter
+/// the function linearly, so they are eliminated: for the given decay times
+/// they are calculated with linear least squares and the algorithm iterates
+/// over the decay times only (variable projection). The constant is the base
+/// line before the signal and the time offset is fixed at the signal maximum.
+/// ROOT fitting isn't used, therefore signals can be fitted in parallel.
+
+class SFDecayFitter : public TObject
+{
+
+  private:
+    int    fComponents; ///< Number of decay components: 1 or 2
+    int    fMaxIter;    ///< Maximal number of iterations
+    double fTolerance;  ///< Relative change of chi2 at which the fit is converged
+
+  public:
+    SFDecayFitter(int components, int maxIter = 500, double tolerance = 1E-9);
+    ~SFDecayFitter();
+
+    SFDecayFitResult Fit(TProfile* signal) const;
+    static double    FitBaseLine(TProfile* signal, double xmin, double xmax);
+
+    /// Returns number of fitted decay components.
+    int GetComponents(void) { return fComponents; };
+
+    void Print(void);
+
+    ClassDef(SFDecayFitter, 1)
+};
+
+#endif /* __SFDecayFitter_H_ */
@@ -13,6 +13,7 @@
 #include <TObject.h>
 #include <TString.h>
 #include <iostream>
+#include <vector>
 
 /// \file
 /// Enumeration representing different types of selections
@@ -160,6 +161,8 @@ class SFDrawCommands : public TObject
                                        std::vector<double> customNum = {});
     static TString        GetCut(SFCutType cut, std::vector<double> customNum = {});
     static ChannelAddress GetChannelAddress(int ch);
+    static bool           ParseSelection(TString selection, std::vector<TString>& expressions,
+                                         std::vector<double>& binning);
 
     void Print(void);
 
@@ -14,6 +14,7 @@
 #include "SFAttenuationModel.hh"
 #include "SFData.hh"
 #include "SFResults.hh"
+#include "SFSeriesContext.hh"
 
 #include <TF1.h>
 #include <TF2.h>
@@ -24,8 +25,9 @@ class SFEnergyReco : public TObject
 {
 
   private:
-    int     fSeriesNo;
-    SFData* fData;
+    int                 fSeriesNo;
+    SFSeriesContext*    fContext;
+    SFData*             fData;
     SFAttenuationModel* fModel;
 
     TGraphErrors* fMAttCh0Graph;
@@ -45,8 +47,11 @@ class SFEnergyReco : public TObject
     
     double fEref;
     
+    bool Init(void);
+
   public:
     SFEnergyReco(int seriesNo);
+    SFEnergyReco(SFSeriesContext* context);
     ~SFEnergyReco();
 
     bool CalculateAlpha(void);
@@ -0,0 +1,119 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *            SFEventCache.hh            *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#ifndef __SFEventCache_H_
+#define __SFEventCache_H_ 1
+
+#include <TObject.h>
+#include <TString.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+struct SFSignal;
+
+/// \file
+/// Enumeration representing columns of the event cache.
+
+/// Enumeration representing columns of the event cache. Columns kEvent,
+/// kModule, kLayer and kFiber are common for both sides of the fiber,
+/// remaining columns are stored separately for the left (side 0) and
+/// right (side 1) signal.
+
+enum class SFCacheCol
+{
+    kEvent,   ///< Event number (entry of the ROOT tree)
+    kModule,  ///< Module number
+    kLayer,   ///< Layer number
+    kFiber,   ///< Fiber number
+    kPE,      ///< Calibrated charge [P.E.]
+    kCharge,  ///< Uncalibrated charge
+    kAmp,     ///< Amplitude
+    kT0,      ///< Time T0
+    kTOT,     ///< Time over threshold
+    kBL,      ///< Base line
+    kBLSigma, ///< Sigma of the base line
+    kVeto,    ///< Veto flag
+    kPileUp   ///< Pile-up flag
+};
+
+/// Class representing columnar cache of the signals stored in sifi_results.root
+/// of a single measurement. At the first use all SDDSamples of the measurement
+/// are decoded once and their fields are stored as struct of arrays in the
+/// binary file sifi_cache.bin, next to sifi_results.root. Subsequently the
+/// cache file is memory-mapped and analyses iterate over plain arrays instead
+/// of decoding ROOT objects. The cache is rebuilt if sifi_results.root is newer
+/// than the cache file. If the cache file can't be written, columns are kept
+/// in memory only.
+///
+/// Each row of the cache corresponds to a single SDDSamples object. Rows are
+/// ordered by event number.
+
+class SFEventCache : public TObject
+{
+
+  private:
+    TString          fDirectory; ///< Directory of the measurement
+    TString          fFileName;  ///< Name of the cache file
+    Long64_t         fNrows;     ///< Number of rows (SDDSamples objects)
+    int              fFD;        //! File descriptor of the mapped file
+    void*            fMap;       //! Address of the memory-mapped file
+    size_t           fMapSize;   //! Size of the memory-mapped region [bytes]
+    std::vector<int> fBuffer;    //! Columns kept in memory if cache file is not used
+    const char*      fColumns;   //! Pointer to the first column
+
+    const int*   fModuleCol;       //! Column kModule
+    const float* fFloatCols[2][7]; //! Columns kPE...kBLSigma of both sides
+    const int*   fVetoCol[2];      //! Column kVeto of both sides
+    const int*   fPileUpCol[2];    //! Column kPileUp of both sides
+
+    bool   Open(void);
+    bool   Build(void);
+    void   Close(void);
+    void   SetColumns(void);
+    size_t GetColumnIndex(SFCacheCol col, int side);
+
+  public:
+    SFEventCache(TString directory);
+    ~SFEventCache();
+
+    const int*   GetInt(SFCacheCol col, int side = 0);
+    const float* GetFloat(SFCacheCol col, int side = 0);
+    void         GetSignal(Long64_t row, int side, SFSignal& sig);
+
+    /// Returns side of the fiber (0 - left, 1 - right) in the given row,
+    /// which corresponds to the requested channel, or -1 if the row doesn't
+    /// contain signal of this channel.
+    /// \param row - row number
+    /// \param ch - channel number
+    int GetSide(Long64_t row, int ch)
+    {
+        int m = fModuleCol[row];
+        return (m == 0 && (ch == 0 || ch == 1)) ? ch : ((m == 1 && ch == 2) ? 0 : -1);
+    };
+
+    /// Returns number of rows (SDDSamples objects) in the cache.
+    Long64_t GetNrows(void) { return fNrows; };
+    /// Returns name of the cache file.
+    TString GetFileName(void) { return fFileName; };
+    /// Returns true if the cache file is memory-mapped.
+    bool IsMapped(void) { return fMap != nullptr; };
+
+    void Print(void);
+
+    ClassDef(SFEventCache, 1)
+};
+
+#endif /* __SFEventCache_H_ */
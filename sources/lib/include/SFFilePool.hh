@@ -0,0 +1,46 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *            SFFilePool.hh              *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#ifndef __SFFilePool_H_
+#define __SFFilePool_H_ 1
+
+#include <TFile.h>
+#include <TObject.h>
+#include <TString.h>
+
+#include <iostream>
+
+/// Pool of opened ROOT files with experimental data, shared by all SFData
+/// objects. Files are opened on demand, at the first Acquire() call, and kept
+/// open for the subsequent calls. At most GetCapacity() files are kept open:
+/// when the limit is exceeded, the least recently used file which is not in
+/// use is closed. A file is used by one caller at a time: if it is requested
+/// while in use, e.g. by another thread, it is opened once more. Files are
+/// opened without changing the current directory, so that histograms drawn
+/// from their trees are never owned by the files.
+/// SLoop opens the files by itself, therefore Evict() should be called before
+/// a file is read with SLoop, so that it is not kept open twice.
+
+class SFFilePool : public TObject
+{
+
+  public:
+    static TFile* Acquire(TString fname);
+    static void   Release(TFile* file);
+    static void   Evict(TString fname);
+    static void   CloseAll(void);
+    static void   SetCapacity(int capacity);
+    static int    GetCapacity(void);
+    static int    GetNOpened(void);
+
+    ClassDef(SFFilePool, 1)
+};
+
+#endif /* __SFFilePool_H_ */
@@ -0,0 +1,76 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *          SFFitParamStore.hh           *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#ifndef __SFFitParamStore_H_
+#define __SFFitParamStore_H_ 1
+
+#include "FitterFactory.h"
+
+#include <TObject.h>
+#include <TString.h>
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+/// Class storing fit parameters and series details used by SFPeakFinder.
+///
+/// Details of the experimental series (names, IDs and positions of the measurements,
+/// description and collimator type) are read from the data base once per series
+/// and kept in the store, so that peak finders don't need to construct SFData
+/// objects. Fit parameters are kept in one FitterFactory per directory, which is
+/// initialized from fitconfig.txt and fitparams.out at the first use and shared
+/// by all peak finders. Updated parameters are written back to fitparams.out only
+/// with Flush(), which sfbatch calls after each analysis and which is called
+/// automatically at the end of the program. All static functions are safe to
+/// call from many threads.
+
+class SFFitParamStore : public TObject
+{
+
+  private:
+    int                  fSeriesNo;   ///< Number of experimental series
+    std::vector<TString> fNames;      ///< Names of measurements
+    std::vector<int>     fMeasureID;  ///< IDs of measurements
+    std::vector<double>  fPositions;  ///< Positions of radioactive source [mm]
+    TString              fDesc;       ///< Description of the series
+    TString              fCollimator; ///< Collimator type
+
+  public:
+    SFFitParamStore(int seriesNo);
+    ~SFFitParamStore();
+
+    static SFFitParamStore* GetStore(int seriesNo);
+    static FitterFactory*   GetFactory(TString path);
+    static void             SetModified(TString path);
+    static bool             Flush(TString path);
+    static bool             Flush(void);
+    static void             Drop(TString path);
+
+    /// Returns number of the experimental series.
+    int GetSeriesNo(void) { return fSeriesNo; };
+    /// Returns names of the measurements.
+    std::vector<TString> GetNames(void) { return fNames; };
+    /// Returns IDs of the measurements.
+    std::vector<int> GetMeasurementsIDs(void) { return fMeasureID; };
+    /// Returns source positions of the measurements.
+    std::vector<double> GetPositions(void) { return fPositions; };
+    /// Returns description of the series.
+    TString GetDescription(void) { return fDesc; };
+    /// Returns collimator type.
+    TString GetCollimator(void) { return fCollimator; };
+
+    void Print(void);
+
+    ClassDef(SFFitParamStore, 1)
+};
+
+#endif /* __SFFitParamStore_H_ */
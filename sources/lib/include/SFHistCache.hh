@@ -0,0 +1,47 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *           SFHistCache.hh              *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#ifndef __SFHistCache_H_
+#define __SFHistCache_H_ 1
+
+#include <TH1.h>
+#include <TObject.h>
+#include <TString.h>
+
+#include <iostream>
+
+/// Persistent cache of histograms (TH1 or SFCorrHist) drawn from the
+/// experimental data, shared
+/// by all SFData objects and all processes. Each histogram is stored in a
+/// separate ROOT file in the cache directory ($SFDATA/HistCache by default),
+/// in a subdirectory of the data file it was drawn from. Name of the file is
+/// a hash of the data file name, its size and modification time and the key
+/// of the histogram (e.g. selection and cut), so that histograms of modified
+/// data files are never returned. Full key is stored together with the
+/// histogram and compared when it is read. Files are written under temporary
+/// names and renamed afterwards, so that concurrent processes never read
+/// incomplete files.
+
+class SFHistCache : public TObject
+{
+
+  public:
+    static TObject* Get(TString dataFile, TString key);
+    static bool     Put(TString dataFile, TString key, TObject* hist);
+    static bool     Invalidate(TString dataFile = "");
+    static void     SetEnabled(bool enabled);
+    static bool     IsEnabled(void);
+    static void     SetPath(TString path);
+    static TString  GetPath(void);
+
+    ClassDef(SFHistCache, 1)
+};
+
+#endif /* __SFHistCache_H_ */
@@ -13,6 +13,8 @@
 
 #include "FitterFactory.h"
 #include "SFData.hh"
+#include "SFFitParamStore.hh"
+#include "SFPeakFitter.hh"
 #include "SFResults.hh"
 #include "SFTools.hh"
 
@@ -27,6 +29,14 @@
 #include <iostream>
 #include <vector>
 
+/// Enumeration representing methods of the 511 keV peak fit in SFPeakFinder.
+
+enum class SFPeakFitMode
+{
+    kFormula, ///< fit of the interpreted formula performed by FitterFactory
+    kCompiled ///< fit of the compiled function with analytic derivatives (see SFPeakFitter)
+};
+
 /// Class searching for the 511 keV peak and performing peak fitting and background
 /// subtraction on measured charge spectra.
 /// Function fitted to the analyzed spectra has the following form:
@@ -54,6 +64,9 @@ class SFPeakFinder : public TObject
     bool       fVerbose;   ///< Print-outs level
     bool       fTests;     ///< Flag for testing mode
     SFResults* fResults; ///< Object containing parameters of 511 keV peak as determined by the fit
+    SFPeakFitMode fFitMode; ///< Method of the 511 keV peak fit
+
+    bool FindPeakFitCompiled(FitterFactory* fitter, HistogramFitParams* histFP, double& chi2NDF);
 
   public:
     SFPeakFinder();
@@ -78,6 +91,13 @@ class SFPeakFinder : public TObject
     void SetVerbLevel(bool verbose) { fVerbose = verbose; };
     /// Sets testing mode.
     void SetTests(bool tests) { fTests = tests; };
+    /// Sets method of the 511 keV peak fit.
+    void SetFitMode(SFPeakFitMode mode) { fFitMode = mode; };
+    /// Returns method of the 511 keV peak fit.
+    SFPeakFitMode GetFitMode(void) { return fFitMode; };
+
+    static void          SetDefaultFitMode(SFPeakFitMode mode);
+    static SFPeakFitMode GetDefaultFitMode(void);
 
     ClassDef(SFPeakFinder, 1)
 };
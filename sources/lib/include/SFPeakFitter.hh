@@ -0,0 +1,73 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *            SFPeakFitter.hh            *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#ifndef __SFPeakFitter_H_
+#define __SFPeakFitter_H_ 1
+
+#include <TF1.h>
+#include <TH1D.h>
+#include <TObject.h>
+
+#include <iostream>
+#include <vector>
+
+/// Structure containing results of the fit performed with SFPeakFitter.
+/// Parameters are ordered like in the function fitted in SFPeakFinder.
+
+struct SFPeakFitResult
+{
+    int                 fStat    = -1; ///< Fit status: 0 - converged, otherwise failed
+    double              fChi2    = -1; ///< Chi2 of the fit
+    int                 fNDF     = -1; ///< Number of degrees of freedom
+    int                 fNpoints = 0;  ///< Number of fitted bins
+    std::vector<double> fParameters;   ///< Fitted parameters
+    std::vector<double> fParErrors;    ///< Uncertainties of the fitted parameters
+};
+
+/// Compiled fitter of the 511 keV peak, used by SFPeakFinder instead of
+/// the fit of the interpreted formula gaus(0) pol0(3)+[4]*TMath::Exp((x-[5])*[6]).
+/// Function and its analytic derivatives are evaluated in plain loops over
+/// the bins within the fitting range only, and chi2 is minimized with the
+/// Levenberg-Marquardt algorithm. Initial parameters, their limits, fixed
+/// parameters and the fitting range are taken from the given TF1 function,
+/// i.e. from the fitting configuration of FitterFactory. Parameters [4] and
+/// [5] of the background are degenerate, therefore [5] is kept at its
+/// initial value and only [4] is fitted.
+
+class SFPeakFitter : public TObject
+{
+
+  private:
+    std::vector<double> fInit;      ///< Initial parameters
+    std::vector<double> fLower;     ///< Lower limits of parameters
+    std::vector<double> fUpper;     ///< Upper limits of parameters
+    std::vector<bool>   fFixed;     ///< Flags indicating fixed parameters
+    double              fXmin;      ///< Lower edge of the fitting range
+    double              fXmax;      ///< Upper edge of the fitting range
+    int                 fMaxIter;   ///< Maximal number of iterations
+    double              fTolerance; ///< Relative change of chi2 at which the fit is converged
+
+  public:
+    static const int kNpar = 7; ///< Number of parameters of the fitted function
+
+    SFPeakFitter(TF1* fun, int maxIter = 1000, double tolerance = 1E-10);
+    ~SFPeakFitter();
+
+    SFPeakFitResult Fit(TH1D* spectrum) const;
+
+    static void Eval(const double* x, double* y, int n, const double* par);
+    static void Derivatives(const double* x, double* deriv, int n, const double* par);
+
+    void Print(void);
+
+    ClassDef(SFPeakFitter, 1)
+};
+
+#endif /* __SFPeakFitter_H_ */
@@ -16,6 +16,7 @@
 #include "SFPositionRes.hh"
 #include "SFData.hh"
 #include "SFResults.hh"
+#include "SFSeriesContext.hh"
 
 #include <TF1.h>
 #include <TF2.h>
@@ -26,8 +27,9 @@ class SFPositionReco : public TObject
 {
 
   private:
-    int     fSeriesNo;
-    SFData* fData;
+    int                 fSeriesNo;
+    SFSeriesContext*    fContext;
+    SFData*             fData;
     SFAttenuationModel* fModel;
 
     TGraphErrors* fMAttCh0CorrGraph;
@@ -62,8 +64,11 @@ class SFPositionReco : public TObject
     SFResults* fResultsExp;
     SFResults* fResultsCorr;
 
+    bool Init(void);
+
   public:
     SFPositionReco(int seriesNo);
+    SFPositionReco(SFSeriesContext* context);
     ~SFPositionReco();
 
     bool CalculateMLR(void);
@@ -16,6 +16,7 @@
 #include "SFData.hh"
 #include "SFPeakFinder.hh"
 #include "SFResults.hh"
+#include "SFSeriesContext.hh"
 #include "SFTools.hh"
 
 #include <TCanvas.h>
@@ -30,9 +31,10 @@ class SFPositionRes : public TObject
 {
 
   private:
-    int            fSeriesNo;
-    SFData*        fData;
-    SFAttenuation* fAtt;
+    int              fSeriesNo;
+    SFSeriesContext* fContext;
+    SFData*          fData;
+    SFAttenuation*   fAtt;
 
     TGraphErrors* fPosVsMLRGraph;
 
@@ -44,10 +46,12 @@ class SFPositionRes : public TObject
     SFResults* fResultsPol3;
     SFResults* fResultsPol1;
 
+    bool Init(void);
     bool LoadRatios(void);
 
   public:
     SFPositionRes(int seriesNo);
+    SFPositionRes(SFSeriesContext* context);
     ~SFPositionRes();
 
     bool AnalyzePositionRes(void);
@@ -0,0 +1,42 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *           SFPrefetcher.hh             *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#ifndef __SFPrefetcher_H_
+#define __SFPrefetcher_H_ 1
+
+#include <TObject.h>
+#include <TString.h>
+
+#include <iostream>
+
+/// Background reader of the experimental data files, shared by all SFData
+/// objects. While a measurement is analyzed, SFData schedules the files of
+/// the next GetDepth() measurements with Schedule(). They are read on a
+/// separate thread, so that they are already in the page cache of the
+/// operating system when the analysis reaches them, and reading from a
+/// (possibly remote) disk overlaps with the analysis. Each file is read
+/// only once per program. Prefetching is disabled if the depth is 0.
+/// Nothing is decoded on the background thread, since SLoop and its
+/// categories are not thread-safe.
+
+class SFPrefetcher : public TObject
+{
+
+  public:
+    static void Schedule(TString fname);
+    static void Wait(void);
+    static void Stop(void);
+    static void SetDepth(int depth);
+    static int  GetDepth(void);
+
+    ClassDef(SFPrefetcher, 1)
+};
+
+#endif /* __SFPrefetcher_H_ */
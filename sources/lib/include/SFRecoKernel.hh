@@ -0,0 +1,69 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *            SFRecoKernel.hh            *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#ifndef __SFRecoKernel_H_
+#define __SFRecoKernel_H_ 1
+
+#include <TMatrixDfwd.h>
+#include <TMatrixT.h>
+#include <TObject.h>
+#include <TString.h>
+
+#include <cmath>
+#include <iostream>
+
+class SFAttenuationModel;
+
+/// Class for event-by-event reconstruction of the primary light components,
+/// energy and position based on the fitted attenuation model with light
+/// reflection (see SFAttenuationModel). Reconstructed primary components
+/// Pl and Pr are linear in the measured signals S left and S right, and
+/// partial derivatives with respect to the model parameters are linear as
+/// well. Therefore all model parameters and the covariance matrix are bound
+/// once in the constructor into a few coefficients, and reconstruction of
+/// whole arrays of events is performed in plain loops without evaluation
+/// of TF2 functions or construction of derivative matrices.
+///
+/// Uncertainties are identical to the ones calculated with
+/// SFAttenuationModel::CalculateUncertainty().
+
+class SFRecoKernel : public TObject
+{
+
+  private:
+    double fPlCoeff[2]; ///< Coefficients of Pl: [0] - S left, [1] - S right
+    double fPrCoeff[2]; ///< Coefficients of Pr: [0] - S left, [1] - S right
+    double fPlVar[3];   ///< Model variance of Pl: [0] - SL^2, [1] - 2*SL*SR, [2] - SR^2
+    double fPrVar[3];   ///< Model variance of Pr: [0] - SL^2, [1] - 2*SL*SR, [2] - SR^2
+
+    void Bind(double lambda, double etaR, double etaL, double ksi, double length,
+              const TMatrixD& cov);
+    void CheckVariance(int nneg, TString method);
+
+  public:
+    SFRecoKernel(SFAttenuationModel* model);
+    SFRecoKernel(double lambda, double etaR, double etaL, double ksi, double length,
+                 const TMatrixD& cov);
+    ~SFRecoKernel(){};
+
+    void Primary(int n, const double* SL, const double* SR, double* Pl, double* Pr);
+    void PrimaryUncertainty(int n, const double* SL, const double* SR, double sigmaSL,
+                            double sigmaSR, double* PlErr, double* PrErr);
+    void Energy(int n, const double* SL, const double* SR, double sigmaSL, double sigmaSR,
+                double alpha, double alphaErr, double* E, double* EErr);
+    void Position(int n, const double* SL, const double* SR, double sigmaSL, double sigmaSR,
+                  double A, double AErr, double B, double BErr, double* pos, double* posErr);
+
+    void Print(void);
+
+    ClassDef(SFRecoKernel, 1)
+};
+
+#endif /* __SFRecoKernel_H_ */
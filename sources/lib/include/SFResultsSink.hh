@@ -0,0 +1,69 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *           SFResultsSink.hh            *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#ifndef __SFResultsSink_H_
+#define __SFResultsSink_H_ 1
+
+#include <TObject.h>
+#include <TString.h>
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <sqlite3.h>
+#include <utility>
+#include <vector>
+
+/// Class writing analysis results to the results data base. One connection
+/// per data base file is kept open during the whole program (see Open()).
+/// The data base is switched to WAL journal mode, so that readers don't block
+/// writers, and concurrent writers from other processes are handled by the
+/// SQLite busy timeout instead of retrying after whole seconds. Each Save()
+/// call is a single transaction: table is created if needed and the entry is
+/// inserted together with the current date. Insert statements are prepared
+/// once and reused.
+
+class SFResultsSink : public TObject
+{
+
+  private:
+    TString  fDatabase;    ///< Name of the results data base file
+    int      fBusyTimeout; ///< Maximal time of waiting for locked data base [ms]
+    sqlite3* fDB;          //! Connection to the results data base
+
+    std::map<TString, sqlite3_stmt*> fStatements; //! Prepared statements, accessed by query
+    std::set<TString>                fTables;     //! Tables known to exist in the data base
+
+    sqlite3_stmt* Prepare(TString query);
+    bool          Execute(TString query);
+    bool          CheckTable(TString table);
+    bool          Check(int status, TString method);
+
+  public:
+    SFResultsSink(TString database, int busyTimeout = 60000);
+    ~SFResultsSink();
+
+    static SFResultsSink* Open(TString database);
+    static void           CloseAll(void);
+
+    bool Save(TString table, int seriesNo, TString resultsFile,
+              const std::vector<std::pair<TString, double>>&  values,
+              const std::vector<std::pair<TString, TString>>& text = {});
+    bool SaveQuery(TString table, TString query, int seriesNo);
+
+    /// Returns name of the results data base file.
+    TString GetDatabase(void) { return fDatabase; };
+
+    void Print(void);
+
+    ClassDef(SFResultsSink, 1)
+};
+
+#endif /* __SFResultsSink_H_ */
@@ -0,0 +1,88 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *          SFSeriesContext.hh           *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#ifndef __SFSeriesContext_H_
+#define __SFSeriesContext_H_ 1
+
+#include "SFData.hh"
+#include "SFPeakFinder.hh"
+#include "SFTools.hh"
+
+#include <TH1D.h>
+#include <TObject.h>
+#include <TString.h>
+
+#include <iostream>
+#include <map>
+#include <vector>
+
+class SFAttenuation;
+class SFAttenuationModel;
+
+/// Class representing shared state of a single experimental series. It keeps
+/// one SFData object (i.e. one connection to the data base and one set of opened
+/// ROOT files), spectra which have already been drawn, peak finders which have
+/// already been fitted and results of the attenuation analysis. Analysis classes
+/// (SFAttenuation, SFAttenuationModel, SFPositionRes, SFPositionReco, SFEnergyReco)
+/// accept the context in their constructors, so that each file is read and each
+/// spectrum is fitted only once during the whole analysis chain.
+///
+/// Contexts are reference counted. Acquire() returns the context of the requested
+/// series (created on the first call) and each Acquire() or Retain() call has to
+/// be balanced with Release(). Context is deleted together with all objects it
+/// owns when the last reference is released. Histograms, peak finders, SFAttenuation
+/// and SFAttenuationModel objects returned by the context must not be deleted by
+/// the caller.
+
+class SFSeriesContext : public TObject
+{
+
+  private:
+    int     fSeriesNo; ///< Number of experimental series
+    int     fRefCount; ///< Number of references to this context
+    SFData* fData;     ///< SFData object of the experimental series
+
+    std::map<TString, std::vector<TH1D*>> fSpectra; ///< Drawn spectra and histograms
+    std::map<TH1D*, SFPeakFinder*>        fPeakFin; ///< Fitted peak finders
+
+    SFAttenuation*      fAtt;   ///< Shared attenuation analysis
+    SFAttenuationModel* fModel; ///< Shared attenuation model analysis
+
+  public:
+    SFSeriesContext(int seriesNo);
+    ~SFSeriesContext();
+
+    static SFSeriesContext* Acquire(int seriesNo);
+
+    void Retain(void);
+    void Release(void);
+
+    std::vector<TH1D*> GetSpectra(int ch, SFSelectionType sel_type, TString cut);
+    std::vector<TH1D*> GetCustomHistograms(SFSelectionType sel_type, TString cut);
+    TH1D*              GetSpectrum(int ch, SFSelectionType sel_type, TString cut, int ID);
+    TH1D*              GetCustomHistogram(SFSelectionType sel_type, TString cut, int ID);
+
+    SFPeakFinder*       GetPeakFinder(TH1D* spectrum);
+    SFAttenuation*      GetAttenuation(void);
+    SFAttenuationModel* GetAttenuationModel(void);
+
+    /// Returns number of the experimental series.
+    int GetSeriesNo(void) { return fSeriesNo; };
+    /// Returns shared SFData object of the series.
+    SFData* GetData(void) { return fData; };
+    /// Returns number of references to this context.
+    int GetRefCount(void) { return fRefCount; };
+
+    void Print(void);
+
+    ClassDef(SFSeriesContext, 1)
+};
+
+#endif /* __SFSeriesContext_H_ */
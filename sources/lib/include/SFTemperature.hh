@@ -50,9 +50,18 @@ class SFTemperature : public TObject
                                        ///< the temperature measurement
     std::vector<double> fTemperatures; ///< Vector containing temperature values
 
+    std::map<TString, std::map<TString, std::vector<int>>>    fTimeSeries; //! Timestamps of all
+                                                                           //! readings of the series
+                                                                           //! (keys - sensor ID,
+                                                                           //! measurement name)
+    std::map<TString, std::map<TString, std::vector<double>>> fTempSeries; //! Temperatures of all
+                                                                           //! readings of the series
+    bool fSeriesLoaded;                //! Flag indicating whether readings were loaded
+
     sqlite3* fDB;                      ///< SQLite3 data base
 
     bool       OpenDataBase(void);
+    bool       LoadSeriesFromDB(void);
     bool       LoadFromDB(TString sensor, TString name = "all");
     SFResults* CalcAverageTempMeasure(TString sensor, TString name);
 
@@ -13,11 +13,11 @@
 #define __SFTimeConst_H_ 1
 
 #include "SFData.hh"
+#include "SFDecayFitter.hh"
 #include "SFFitResults.hh"
 #include "SFTools.hh"
 #include "SFResults.hh"
 
-#include <Math/MinimizerOptions.h>
 #include <TF1.h>
 #include <TObject.h>
 #include <TProfile.h>
@@ -54,6 +54,9 @@ class SFTimeConst : public TObject
     
     SFResults* fResults; ///< Object containing final results of signals shape analysis
 
+    bool SetFitResults(TProfile* signal, int ID, const SFDecayFitResult& fit);
+    bool FitSignals(std::vector<TProfile*> signals, std::vector<int> IDs, int components);
+
   public:
     SFTimeConst();
     SFTimeConst(int seriesNo, double PE, bool verb);
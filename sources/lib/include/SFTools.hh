@@ -20,11 +20,24 @@
 
 #include "SFData.hh"
 
+#include <functional>
 #include <iostream>
 #include <sqlite3.h>
 #include <stdlib.h>
 #include <time.h>
 
+/// \file
+/// Enumeration representing models fitted to the charge ratio histograms.
+
+/// Enumeration representing models fitted to the charge ratio histograms
+/// with SFTools::RatiosFit().
+
+enum class SFRatioModel
+{
+    kGauss,      ///< single Gaussian function, fitted function named fGauss
+    kDoubleGauss ///< sum of two Gaussian functions, fitted function named fDGauss
+};
+
 /// Namespace containing functions useful for data analysis, e.g.
 /// getting details of the measurement series, accessing and modyfing
 /// data bases and data, calculating statistical parameters, fitting, etc.
@@ -43,6 +56,7 @@ double              GetSigmaBL(TString SiPM);
 bool                CheckDBStatus(int status, sqlite3* database);
 bool                SaveResultsDB(TString database, TString table, TString query, int seriesNo);
 bool                CreateTable(TString database, TString table);
+TString             GetTableSchema(TString table);
 double              GetMean(std::vector<double> vec);
 double              GetStandardDev(std::vector<double> vec);
 double              GetStandardErr(std::vector<double> vec);
@@ -50,9 +64,15 @@ double              FindMaxXaxis(TH1D* h);
 double              FindMaxYaxis(TH1D* h);
 bool                RatiosFitGauss(std::vector<TH1D*>& vec, float range_in_RMS = 1);
 bool                RatiosFitDoubleGauss(std::vector<TH1D*>& vec, float range_in_RMS = 1);
+bool                RatiosFit(std::vector<TH1D*>& vec, SFRatioModel model, float range_in_RMS = 1);
 bool                FitGaussSingle(TH1D* h, float range_in_RMS);
 TString             FindData(TString directory);
 std::vector<double> GetFWHM(TH1D* h);
+void                SetNThreads(int nthreads);
+int                 GetNThreads(void);
+void                ParallelFor(int n, std::function<void(int)> fun);
+bool                SolveLinear(std::vector<double> m, std::vector<double>& b, int n);
+bool                SelectBranches(TTree* tree, const std::vector<TString>& branches);
 
 };
 
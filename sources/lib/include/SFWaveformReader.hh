@@ -0,0 +1,64 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *          SFWaveformReader.hh          *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#ifndef __SFWaveformReader_H_
+#define __SFWaveformReader_H_ 1
+
+#include <TObject.h>
+#include <TString.h>
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+/// Class providing access to the binary files with raw signals recorded
+/// with the Krakow test bench (wave_N.dat). Each event is stored as a block
+/// of fixed number of float samples. The file is memory-mapped, so that
+/// GetEvent() returns a pointer to the samples of requested event without
+/// any copying. If mapping of the file is not possible, the whole file is
+/// read into memory with a single block read.
+
+class SFWaveformReader : public TObject
+{
+
+  private:
+    TString            fFileName; ///< Name of the binary file
+    int                fSamples;  ///< Number of samples per event
+    int                fEvents;   ///< Number of events in the file
+    int                fFD;       //! File descriptor of the mapped file
+    void*              fMap;      //! Address of the memory-mapped file
+    size_t             fMapSize;  //! Size of the memory-mapped region [bytes]
+    std::vector<float> fBuffer;   //! Samples read in one block if mapping failed
+    const float*       fData;     //! Pointer to the first sample in the file
+
+    bool Open(void);
+    void Close(void);
+
+  public:
+    SFWaveformReader(TString fname, int samples = 1024);
+    ~SFWaveformReader();
+
+    const float* GetEvent(int event);
+
+    /// Returns name of the binary file.
+    TString GetFileName(void) { return fFileName; };
+    /// Returns number of samples per event.
+    int GetNsamples(void) { return fSamples; };
+    /// Returns number of events stored in the file.
+    int GetNevents(void) { return fEvents; };
+    /// Returns true if the file is memory-mapped.
+    bool IsMapped(void) { return fMap != nullptr; };
+
+    void Print(void);
+
+    ClassDef(SFWaveformReader, 1)
+};
+
+#endif /* __SFWaveformReader_H_ */
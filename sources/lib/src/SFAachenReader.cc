@@ -0,0 +1,151 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *          SFAachenReader.cc            *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#include "SFAachenReader.hh"
+
+#include <TDirectory.h>
+
+ClassImp(SFAachenReader);
+
+/// Size of TTreeCache of each tree [bytes].
+static const Long64_t gCacheSize = 32 * 1024 * 1024;
+/// Number of samples of a single waveform.
+static const int gSamples = 1024;
+
+//------------------------------------------------------------------
+/// Standard constructor. Opens results.root and waves.root of the given
+/// measurement and enables TTreeCache of their trees.
+/// \param directory - directory of the measurement
+SFAachenReader::SFAachenReader(TString directory) : fDirectory(directory),
+                                                    fChannel(-1),
+                                                    fFile(nullptr),
+                                                    fWaveFile(nullptr),
+                                                    fTree(nullptr),
+                                                    fWaveTree(nullptr),
+                                                    fSignal(new DDSignal()),
+                                                    fVoltages(new TVectorT<float>(gSamples))
+{
+    {
+        // TFile constructor changes the current directory
+        TDirectory::TContext context;
+        fFile     = new TFile(fDirectory + "/results.root", "READ");
+        fWaveFile = new TFile(fDirectory + "/waves.root", "READ");
+    }
+
+    if (fFile->IsOpen() && !fFile->IsZombie()) fTree = (TTree*)fFile->Get("tree_ft");
+    if (fWaveFile->IsOpen() && !fWaveFile->IsZombie())
+        fWaveTree = (TTree*)fWaveFile->Get("wavetree");
+
+    if (fTree == nullptr || fWaveTree == nullptr)
+    {
+        std::cerr << "##### Error in SFAachenReader constructor! Could not access data in "
+                  << fDirectory << std::endl;
+        delete fFile;
+        delete fWaveFile;
+        delete fSignal;
+        delete fVoltages;
+        throw "##### Exception in SFAachenReader constructor!";
+    }
+
+    fTree->SetCacheSize(gCacheSize);
+    fWaveTree->SetCacheSize(gCacheSize);
+}
+//------------------------------------------------------------------
+/// Default destructor. Closes the files.
+SFAachenReader::~SFAachenReader()
+{
+    // trees are deleted together with the files, before the objects they fill
+    delete fFile;
+    delete fWaveFile;
+    delete fSignal;
+    delete fVoltages;
+}
+//------------------------------------------------------------------
+/// Makes the given branch the only one read from the tree and from its
+/// TTreeCache.
+/// \param tree - tree
+/// \param bname - name of the branch
+/// \param address - address of the pointer to the object filled by the branch
+bool SFAachenReader::SelectBranch(TTree* tree, TString bname, void* address)
+{
+    if (tree->GetBranch(bname) == nullptr)
+    {
+        std::cerr << "##### Error in SFAachenReader::SelectBranch()! Branch " << bname
+                  << " not found in " << tree->GetName() << std::endl;
+        return false;
+    }
+
+    tree->ResetBranchAddresses();
+    tree->SetBranchStatus("*", false);
+    tree->SetBranchStatus(bname + "*", true);
+    tree->SetBranchAddress(bname, address);
+
+    tree->DropBranchFromCache("*", true);
+    tree->AddBranchToCache(bname, true);
+    tree->StopCacheLearningPhase();
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Selects channel whose signals and waveforms are read. Branches of
+/// other channels are neither read nor cached.
+/// \param ch - channel number
+bool SFAachenReader::SetChannel(int ch)
+{
+    if (ch == fChannel) return true;
+
+    fChannel = -1;
+
+    if (!SelectBranch(fTree, Form("ch_%i", ch), &fSignal) ||
+        !SelectBranch(fWaveTree, Form("voltages_ch_%i", ch), &fVoltages))
+    {
+        std::cerr << "##### Error in SFAachenReader::SetChannel()! Channel " << ch
+                  << " not available in " << fDirectory << std::endl;
+        return false;
+    }
+
+    fChannel = ch;
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Reads signal of the selected channel from the given entry. Returned
+/// object is owned by the reader and overwritten by the next call.
+/// Returns nullptr if the entry can't be read.
+/// \param entry - entry number
+DDSignal* SFAachenReader::GetSignal(Long64_t entry)
+{
+    if (fChannel < 0 || fTree->GetEntry(entry) <= 0) return nullptr;
+
+    return fSignal;
+}
+//------------------------------------------------------------------
+/// Reads waveform of the selected channel from the given entry. Returned
+/// object is owned by the reader and overwritten by the next call.
+/// Returns nullptr if the entry can't be read.
+/// \param entry - entry number
+const TVectorT<float>* SFAachenReader::GetWaveform(Long64_t entry)
+{
+    if (fChannel < 0 || fWaveTree->GetEntry(entry) <= 0) return nullptr;
+
+    return fVoltages;
+}
+//------------------------------------------------------------------
+/// Prints details of the SFAachenReader class object.
+void SFAachenReader::Print(void)
+{
+    std::cout << "\n-------------------------------------------" << std::endl;
+    std::cout << "This is print out of SFAachenReader class object" << std::endl;
+    std::cout << "Directory: " << fDirectory << std::endl;
+    std::cout << "Number of entries: " << GetEntries() << std::endl;
+    std::cout << "Channel: " << fChannel << std::endl;
+    std::cout << "-------------------------------------------\n" << std::endl;
+}
+//------------------------------------------------------------------
@@ -19,6 +19,8 @@ ClassImp(SFAttenuation);
 /// Standard constructor (recommended)
 /// \param seriesNo is number of experimental series to be analyzed.
 SFAttenuation::SFAttenuation(int seriesNo) : fSeriesNo(seriesNo),
+                                             fContext(nullptr),
+                                             fRetained(true),
                                              fData(nullptr),
                                              fAttGraph(nullptr),
                                              fAttCh0(nullptr),
@@ -31,7 +33,7 @@ SFAttenuation::SFAttenuation(int seriesNo) : fSeriesNo(seriesNo),
 {
     try
     {
-        fData = new SFData(fSeriesNo);
+        fContext = SFSeriesContext::Acquire(fSeriesNo);
     }
     catch (const char* message)
     {
@@ -39,12 +41,53 @@ SFAttenuation::SFAttenuation(int seriesNo) : fSeriesNo(seriesNo),
         throw "##### Exception in SFAttenuation constructor!";
     }
 
+    if (!Init())
+    {
+        fContext->Release();
+        throw "##### Exception in SFAttenuation constructor!";
+    }
+}
+//------------------------------------------------------------------
+/// Constructor sharing data, spectra and fitted peaks with other
+/// analysis classes of the same series.
+/// \param context - context of the experimental series to be analyzed.
+/// \param retain - if false the context is neither retained nor released,
+/// used for objects owned by the context itself
+SFAttenuation::SFAttenuation(SFSeriesContext* context, bool retain)
+    : fSeriesNo(context->GetSeriesNo()),
+      fContext(context),
+      fRetained(retain),
+      fData(nullptr),
+      fAttGraph(nullptr),
+      fAttCh0(nullptr),
+      fAttCh1(nullptr),
+      fResultsCh0(nullptr),
+      fResultsCh1(nullptr),
+      fResultsCombPol1(nullptr),
+      fResultsCombPol3(nullptr),
+      fResultsExpSim(nullptr)
+{
+    if (fRetained) fContext->Retain();
+
+    if (!Init())
+    {
+        if (fRetained) fContext->Release();
+        throw "##### Exception in SFAttenuation constructor!";
+    }
+}
+//------------------------------------------------------------------
+/// Checks type of the series and creates results objects. Used by
+/// constructors.
+bool SFAttenuation::Init(void)
+{
+    fData = fContext->GetData();
+
     TString desc = fData->GetDescription();
 
     if (!desc.Contains("Regular series"))
     {
         std::cout << "##### Error in SFAttenuation constructor! Non-regular series!" << std::endl;
-        throw "##### Exception in SFAttenuation constructor!";
+        return false;
     }
 
     fResultsCh0 = new SFResults(Form("AttenuationResults_S%i_ch0", fSeriesNo));
@@ -52,20 +95,25 @@ SFAttenuation::SFAttenuation(int seriesNo) : fSeriesNo(seriesNo),
     fResultsCombPol1 = new SFResults(Form("AttenuationResults_S%i_CombPol1", fSeriesNo));
     fResultsCombPol3 = new SFResults(Form("AttenuationResults_S%i_CombPol3", fSeriesNo));
     fResultsExpSim   = new SFResults(Form("Attenuation_S%i_ExpSim", fSeriesNo));
+
+    return true;
 }
 //------------------------------------------------------------------
-/// Default destructor.
+/// Default destructor. Releases context of the series.
 SFAttenuation::~SFAttenuation()
 {
-    if (fData != nullptr) delete fData;
+    if (fContext != nullptr && fRetained) fContext->Release();
 }
 //------------------------------------------------------------------
 /// Method to determine attenuation length used in Pauwels et al., JINST 8 (2013) P09019.
 /// For both ends of the fiber one MLR value is calculated, since combined signal from both 
 /// channels is taken into account. Obtained MLR dependence is fitted with pol1 and pol3 
-/// function.
+/// function. Analysis is performed only once, subsequent calls return
+/// immediately.
 bool SFAttenuation::AttCombinedCh(void)
 {
+    if (fAttGraph != nullptr) return true;
+
     std::cout << "\n----- Inside SFAttenuation::AttCombinedCh() for series " << fSeriesNo
               << std::endl;
 
@@ -80,14 +128,14 @@ bool SFAttenuation::AttCombinedCh(void)
     if (testBench == "PMI")
     {
         cut = SFDrawCommands::GetCut(SFCutType::kPMICombCh0Ch1);
-        fRatios = fData->GetCustomHistograms(SFSelectionType::kPMILogSqrtChargeRatio, cut);
+        fRatios = fContext->GetCustomHistograms(SFSelectionType::kPMILogSqrtChargeRatio, cut);
     }
     else
     {
         double s = SFTools::GetSigmaBL(sipm);
         std::vector<double> sigmas = {s, s};
         cut = SFDrawCommands::GetCut(SFCutType::kCombCh0Ch1, sigmas);
-        fRatios = fData->GetCustomHistograms(SFSelectionType::kLogSqrtPERatio, cut);
+        fRatios = fContext->GetCustomHistograms(SFSelectionType::kLogSqrtPERatio, cut);
     }
     
     std::vector<TF1*> fun;
@@ -113,50 +161,46 @@ bool SFAttenuation::AttCombinedCh(void)
     double  const_2  = 0;
     TString fun_name = "";
 
-    for (int i = 0; i < npoints; i++)
+    // each histogram is fitted once, before the loop over positions
+    if (testBench == "PL")
     {
-        if(testBench == "PL")
+        if (collimator.Contains("Lead"))
         {
-            if (collimator.Contains("Lead"))
-            {
-                SFTools::RatiosFitDoubleGauss(fRatios, 5);
-                fun_name = "fDGauss";
-                const_1  = fRatios[i]->GetFunction(fun_name)->GetParameter(0);
-                const_2  = fRatios[i]->GetFunction(fun_name)->GetParameter(3);
-                if (const_1 > const_2)
-                    parNo = 1;
-                else
-                    parNo = 4;
-            }
-            else if (collimator.Contains("Electronic") && sipm.Contains("SensL"))
-            {
-                SFTools::RatiosFitDoubleGauss(fRatios, 2);
-                fun_name = "fDGauss";
-                const_1  = fRatios[i]->GetFunction(fun_name)->GetParameter(0);
-                const_2  = fRatios[i]->GetFunction(fun_name)->GetParameter(3);
-                if (const_1 > const_2)
-                    parNo = 1;
-                else
-                    parNo = 4;
-            }
-            else if (collimator.Contains("Electronic") && sipm.Contains("Hamamatsu"))
-            {
-                SFTools::RatiosFitGauss(fRatios, 2);
-                fun_name = "fGauss";
-                parNo    = 1;
-            }
+            SFTools::RatiosFitDoubleGauss(fRatios, 5);
+            fun_name = "fDGauss";
         }
-        else if (testBench == "PMI")
+        else if (collimator.Contains("Electronic") && sipm.Contains("SensL"))
         {
-            SFTools::RatiosFitDoubleGauss(fRatios, 2);   /// TODO tune!
+            SFTools::RatiosFitDoubleGauss(fRatios, 2);
             fun_name = "fDGauss";
-            const_1  = fRatios[i]->GetFunction(fun_name)->GetParameter(0);
-            const_2  = fRatios[i]->GetFunction(fun_name)->GetParameter(3);
+        }
+        else if (collimator.Contains("Electronic") && sipm.Contains("Hamamatsu"))
+        {
+            SFTools::RatiosFitGauss(fRatios, 2);
+            fun_name = "fGauss";
+        }
+    }
+    else if (testBench == "PMI")
+    {
+        SFTools::RatiosFitDoubleGauss(fRatios, 2);   /// TODO tune!
+        fun_name = "fDGauss";
+    }
+
+    for (int i = 0; i < npoints; i++)
+    {
+        if (fun_name == "fDGauss")
+        {
+            const_1 = fRatios[i]->GetFunction(fun_name)->GetParameter(0);
+            const_2 = fRatios[i]->GetFunction(fun_name)->GetParameter(3);
             if (const_1 > const_2)
                 parNo = 1;
             else
                 parNo = 4;
         }
+        else
+        {
+            parNo = 1;
+        }
 
         fAttGraph->SetPoint(i, positions[i],
                             fRatios[i]->GetFunction(fun_name)->GetParameter(parNo));
@@ -248,9 +292,12 @@ bool SFAttenuation::Fit3rdOrder(void)
 /// with the FindPeakNoBackground() method of the SFPeakFinder class. If
 /// series was measured with electronic collimator - FindPeakFit() method
 /// of the SFPeakFinder class is used.
+/// Analysis of each channel is performed only once.
 /// \param ch - channel number
 bool SFAttenuation::AttSeparateCh(int ch)
 {
+    if ((ch == 0 && fAttCh0 != nullptr) || (ch == 1 && fAttCh1 != nullptr)) return true;
+
     std::cout << "\n----- Inside SFAttenuation::AttSeparateCh() for series " << fSeriesNo
               << std::endl;
     std::cout << "----- Analyzing channel " << ch << std::endl;
@@ -272,7 +319,7 @@ bool SFAttenuation::AttSeparateCh(int ch)
         else if (ch == 1)
             cut = SFDrawCommands::GetCut(SFCutType::kPMISpecCh1);
         
-        spectra = fData->GetSpectra(ch, SFSelectionType::kPMICharge, cut);
+        spectra = fContext->GetSpectra(ch, SFSelectionType::kPMICharge, cut);
     }
     else
     {
@@ -284,7 +331,7 @@ bool SFAttenuation::AttSeparateCh(int ch)
         else if (ch == 1)
             cut = SFDrawCommands::GetCut(SFCutType::kSpecCh1, sigma);
         
-        spectra = fData->GetSpectra(ch, SFSelectionType::kPE, cut);
+        spectra = fContext->GetSpectra(ch, SFSelectionType::kPE, cut);
     }
 
 
@@ -303,9 +350,7 @@ bool SFAttenuation::AttSeparateCh(int ch)
     
     for (int i = 0; i < npoints; i++)
     {
-        auto pf = std::unique_ptr<SFPeakFinder>(new SFPeakFinder(spectra[i], false));
-        pf->FindPeakFit();
-        peakParams = pf->GetResults();
+        peakParams = fContext->GetPeakFinder(spectra[i])->GetResults();
         graph->SetPoint(i, positions[i], peakParams->GetValue(SFResultTypeNum::kPeakPosition));
         graph->SetPointError(i, SFTools::GetPosError(collimator, testBench),
                              peakParams->GetUncertainty(SFResultTypeNum::kPeakPosition));
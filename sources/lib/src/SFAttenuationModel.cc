@@ -19,17 +19,20 @@ ClassImp(SFAttenuationModel);
 /// Standard constructor.
 /// \param seriesNo - number of the experimental series.
 SFAttenuationModel::SFAttenuationModel(int seriesNo) : fSeriesNo(seriesNo), 
+                                                       fContext(nullptr),
+                                                       fRetained(true),
                                                        fData(nullptr),
                                                        fMAttCh0Graph(nullptr),
                                                        fMAttCh1Graph(nullptr),
                                                        fMAttCh0CorrGraph(nullptr),
                                                        fMAttCh1CorrGraph(nullptr),
                                                        fResults(nullptr),
-                                                       fFitterResults(nullptr)
+                                                       fFitterResults(nullptr),
+                                                       fKernel(nullptr)
 {
     try
     {
-        fData = new SFData(fSeriesNo);
+        fContext = SFSeriesContext::Acquire(fSeriesNo);
     }
     catch (const char* message)
     {
@@ -37,24 +40,55 @@ SFAttenuationModel::SFAttenuationModel(int seriesNo) : fSeriesNo(seriesNo),
         throw "##### Exception in SFAttenuationModel constructor!";
     }
 
-    TString desc = fData->GetDescription();
-    if (!desc.Contains("Regular series"))
+    if (!Init())
     {
-        std::cout << "##### Error in SFAttenuationModel constructor! Non-regular series!"
-                  << std::endl;
+        fContext->Release();
         throw "##### Exception in SFAttenuationModel constructor!";
     }
+}
+//------------------------------------------------------------------
+/// Constructor sharing data, spectra and attenuation analysis with other
+/// analysis classes of the same series.
+/// \param context - context of the experimental series.
+/// \param retain - if false the context is neither retained nor released,
+/// used for objects owned by the context itself
+SFAttenuationModel::SFAttenuationModel(SFSeriesContext* context, bool retain)
+    : fSeriesNo(context->GetSeriesNo()),
+      fContext(context),
+      fRetained(retain),
+      fData(nullptr),
+      fMAttCh0Graph(nullptr),
+      fMAttCh1Graph(nullptr),
+      fMAttCh0CorrGraph(nullptr),
+      fMAttCh1CorrGraph(nullptr),
+      fResults(nullptr),
+      fFitterResults(nullptr),
+      fKernel(nullptr)
+{
+    if (fRetained) fContext->Retain();
 
-    SFAttenuation* att;
-    try
+    if (!Init())
     {
-        att = new SFAttenuation(fSeriesNo);
+        if (fRetained) fContext->Release();
+        throw "##### Exception in SFAttenuationModel constructor!";
     }
-    catch (const char* message)
+}
+//------------------------------------------------------------------
+/// Checks type of the series and accesses results of the attenuation
+/// analysis of separate channels. Used by constructors.
+bool SFAttenuationModel::Init(void)
+{
+    fData = fContext->GetData();
+
+    TString desc = fData->GetDescription();
+    if (!desc.Contains("Regular series"))
     {
-        std::cerr << message << std::endl;
-        throw "##### Exception in SFAttenuationModel constructor!";
+        std::cout << "##### Error in SFAttenuationModel constructor! Non-regular series!"
+                  << std::endl;
+        return false;
     }
+
+    SFAttenuation* att = fContext->GetAttenuation();
     
     att->AttSeparateCh(0);
     att->AttSeparateCh(1);
@@ -64,20 +98,26 @@ SFAttenuationModel::SFAttenuationModel(int seriesNo) : fSeriesNo(seriesNo),
     fMAttCh1Graph = (TGraphErrors*)att_res[1]->GetObject(SFResultTypeObj::kAttGraph);
 
     fResults = new SFResults(Form("ReconstructionResults_S%i_Mod", fSeriesNo));
+
+    return true;
 }
 //------------------------------------------------------------------
-/// Destructor.
+/// Destructor. Releases context of the series.
 SFAttenuationModel::~SFAttenuationModel()
 {
-    if (fData != nullptr) delete fData;
+    if (fKernel != nullptr) delete fKernel;
+    if (fContext != nullptr && fRetained) fContext->Release();
 };
 //------------------------------------------------------------------
 /// Calculates partial derivatives of the reconstructed primary components
-/// for requested side: L (left) or R (right). Calculated values are returned
-/// in an array. Order in the array is the following: [0] - lambda, [1] - 
-/// etha right, [2] - etha left, [3] - ksi, [4] - L, [5] - S left, [6] -
-/// S right.
-double* ConstructDerivativesMatrix(std::vector<double> par, TString side)
+/// for requested side: left or right. Calculated values are written to the
+/// given array of size 6, ordered as the fitted parameters: [0] - S0 (always 0),
+/// [1] - lambda, [2] - etha right, [3] - etha left, [4] - ksi, [5] - L
+/// (always 0).
+/// \param par - parameters (see below)
+/// \param left - true for the left side, false for the right side
+/// \param matrix - array for the calculated derivatives
+void ConstructDerivativesMatrix(const double* par, bool left, double* matrix)
 {
     /*-----
      * params:
@@ -90,64 +130,50 @@ double* ConstructDerivativesMatrix(std::vector<double> par, TString side)
      * 6 - S right
     -----*/
 
-    /*
-    std::cout << "lambda: " << par[0] <<std::endl;
-    std::cout << "eta right: " << par[1] <<std::endl;
-    std::cout << "eta left: " << par[2] <<std::endl;
-    std::cout << "ksi: " << par[3] <<std::endl;
-    std::cout << "L: " << par[4] <<std::endl;
-    std::cout << "S left: " << par[5] <<std::endl;
-    std::cout << "S right: " << par[6] <<std::endl;
-    */
-
     double dPdLambda, dPdEtaR, dPdEtaL, dPdKsi;
 
-    double e = exp(par[4] / par[0]);
+    double e   = exp(par[4] / par[0]);
+    double e2  = e * e;
+    double den = e2 - par[1] * par[2];
+    double aux = par[3] * den * den;
 
-    if (side == "L")
+    if (left)
     {
         dPdLambda = -(e * par[4] * par[1] *
-                     (-2 * e * par[3] * par[5] * par[2] + par[6] * (pow(e, 2) + par[1] * par[2]))) /
-                     (pow(par[0], 2) * par[3] * pow((pow(e, 2) - par[1] * par[2]), 2));
+                     (-2 * e * par[3] * par[5] * par[2] + par[6] * (e2 + par[1] * par[2]))) /
+                     (par[0] * par[0] * aux);
 
-        dPdEtaR = (pow(e, 2) * (-e * par[6] + par[3] * par[5] * par[2])) /
-                  (par[3] * (pow((pow(e, 2) - par[1] * par[2]), 2)));
+        dPdEtaR = (e2 * (-e * par[6] + par[3] * par[5] * par[2])) / aux;
 
-        dPdEtaL = (e * par[1] * (e * par[3] * par[5] - par[6] * par[1])) /
-                  (par[3] * pow((pow(e, 2) - par[1] * par[2]), 2));
+        dPdEtaL = (e * par[1] * (e * par[3] * par[5] - par[6] * par[1])) / aux;
 
-        dPdKsi = (e * par[6] * par[1]) / (pow(par[3], 2) * (pow(e, 2) - par[1] * par[2]));
+        dPdKsi = (e * par[6] * par[1]) / (par[3] * par[3] * den);
     }
-    else if (side == "R")
+    else
     {
         dPdLambda = -(e * par[4] * par[2] *
-                     (-2 * e * par[6] * par[1] + par[3] * par[5] * (pow(e, 2) + par[1] * par[2]))) /
-                     (pow(par[0], 2) * par[3] * (pow((pow(e, 2) - par[1] * par[2]), 2)));
+                     (-2 * e * par[6] * par[1] + par[3] * par[5] * (e2 + par[1] * par[2]))) /
+                     (par[0] * par[0] * aux);
 
-        dPdEtaR = (e * par[2] * (e * par[6] - par[3] * par[5] * par[2])) /
-                  (par[3] * (pow((pow(e, 2) - par[1] * par[2]), 2)));
+        dPdEtaR = (e * par[2] * (e * par[6] - par[3] * par[5] * par[2])) / aux;
 
-        dPdEtaL = (-pow(e, 3) * par[3] * par[5] + pow(e, 2) * par[6] * par[1]) /
-                  (par[3] * (pow((pow(e, 2) - par[1] * par[2]), 2)));
+        dPdEtaL = (-e * e2 * par[3] * par[5] + e2 * par[6] * par[1]) / aux;
 
-        dPdKsi = -(pow(e, 2) * par[6]) / (pow(par[3], 2) * (pow(e, 2) - par[1] * par[2]));
+        dPdKsi = -(e2 * par[6]) / (par[3] * par[3] * den);
     }
 
-    double* matrix = new double[6];
-    matrix[0]      = 0;
-    matrix[1]      = dPdLambda;
-    matrix[2]      = dPdEtaR;
-    matrix[3]      = dPdEtaL;
-    matrix[4]      = dPdKsi;
-    matrix[5]      = 0;
-
-    return matrix;
+    matrix[0] = 0;
+    matrix[1] = dPdLambda;
+    matrix[2] = dPdEtaR;
+    matrix[3] = dPdEtaL;
+    matrix[4] = dPdKsi;
+    matrix[5] = 0;
 }
 //------------------------------------------------------------------
 /// Multiplies an array containing partial derivatives of the 
 /// reconstructed primary components with the covariance matrix. 
 /// Returns final value of the multiplication. 
-double Multiply(double* deriv, TMatrixD cov)
+double Multiply(const double* deriv, const TMatrixD& cov)
 {
     // cov - covariance matrix: 6 rows & 6 columns
     // deriv - vector of derivatives: 1 row & 6 columns
@@ -160,7 +186,7 @@ double Multiply(double* deriv, TMatrixD cov)
     {
         for (int j = 0; j < dim; j++)
         {
-            var += cov[i][j] * deriv[i] * deriv[j];
+            var += cov(i, j) * deriv[i] * deriv[j];
         }
     }
 
@@ -174,79 +200,72 @@ double Multiply(double* deriv, TMatrixD cov)
     return var;
 }
 //------------------------------------------------------------------
-/// Calculates uncertainty of the reconstructed primary component.
-double SFAttenuationModel::CalculateUncertainty(std::vector<double> params, TString side)
+/// Calculates uncertainty of the reconstructed primary component for
+/// arbitrary model parameters. For the fitted parameters the overloaded
+/// version, which evaluates both sides at once, should be preferred.
+/// \param params - [0] - lambda, [1] - eta right, [2] - eta left, [3] - ksi,
+/// [4] - L, [5] - S left, [6] - S right, [7] - sigma S left, [8] - sigma S right
+/// \param side - side of the fiber: L or R
+double SFAttenuationModel::CalculateUncertainty(const std::vector<double>& params, TString side)
 {
-    double uncert = 0;
-    
-    std::vector<double> parsForDerivatives(7);
-    parsForDerivatives[0] = params[0]; //fResults->GetValue(SFResultTypeNum::kLambda);
-    parsForDerivatives[1] = params[1]; //fResults->GetValue(SFResultTypeNum::kEtaR);
-    parsForDerivatives[2] = params[2]; //fResults->GetValue(SFResultTypeNum::kEtaL);
-    parsForDerivatives[3] = params[3]; //fResults->GetValue(SFResultTypeNum::kKsi);
-    parsForDerivatives[4] = params[4]; //fResults->GetValue(SFResultTypeNum::kLength);
-    parsForDerivatives[5] = params[5]; //SL
-    parsForDerivatives[6] = params[6]; //SR
-    // params[7] - sigma_SL
-    // params[8] - sigma_SR 
-    
-    double* derivativesL;
-    double* derivativesR;
-    
-    if (side == "L")
-    {
-        derivativesL = ConstructDerivativesMatrix(parsForDerivatives, "L");
-
-        double sigma_fSL = Multiply(derivativesL, fCovMatrix);
-
-        double dPLdSL = (exp(2 * params[4] / params[0])) /
-                        (exp(2 * params[4] / params[0]) -
-                        params[1] * params[2]);
-        double dPLdSR = (exp(params[4] / params[0]) *
-                        params[1]) / (params[3] *
-                        (exp(2 * params[4] / params[0]) -
-                        params[1] * params[2]));
+    bool left = true;
 
-        double signalLCh0Err = sqrt(sigma_fSL + pow(dPLdSL * params[7], 2) + pow(dPLdSR * params[8], 2));
-        uncert = signalLCh0Err;
-    }
+    if (side == "L")
+        left = true;
     else if (side == "R")
-    {
-        derivativesR = ConstructDerivativesMatrix(parsForDerivatives, "R");
-        
-        double sigma_fSR = Multiply(derivativesR, fCovMatrix);
-
-        double dPRdSL = (-exp(params[4] / params[0]) *
-                        params[2]) / (exp(2 * params[4] /
-                        params[0]) - params[1] *
-                        params[2]);
-        double dPRdSR = (exp(2 * params[4] / params[0])) /
-                        (params[3] * (exp(2 * params[4] /
-                        params[0]) - params[1] *
-                        params[2]));
-                        
-        double signalRCh1Err = sqrt(sigma_fSR + pow(dPRdSL * params[7], 2) + pow(dPRdSR * params[8], 2));
-        uncert = signalRCh1Err;
-    }
+        left = false;
     else 
     {
         std::cerr << "Error in SFAttenuationModel::CalculateUncertainty()" << std::endl;
         std::cerr << "Incorrect side. Possible optios are: L and R" << std::endl;
         std::abort();
     }
-    
-    //delete[] derivativesL;
-    //delete[] derivativesR;
-    
-    return uncert;
+
+    double derivatives[6];
+    ConstructDerivativesMatrix(params.data(), left, derivatives);
+
+    double sigma_fS = Multiply(derivatives, fCovMatrix);
+
+    double e   = exp(params[4] / params[0]);
+    double den = e * e - params[1] * params[2];
+
+    double dPdSL = left ? (e * e) / den : (-e * params[2]) / den;
+    double dPdSR = left ? (e * params[1]) / (params[3] * den) : (e * e) / (params[3] * den);
+
+    return sqrt(sigma_fS + pow(dPdSL * params[7], 2) + pow(dPdSR * params[8], 2));
+}
+//------------------------------------------------------------------
+/// Calculates uncertainties of both reconstructed primary components with
+/// the fitted model parameters. Uses the evaluator created in FitModel(),
+/// so that no parameters are recalculated and nothing is allocated.
+/// \param SL - signal of the left side (ch0) [P.E.]
+/// \param SR - signal of the right side (ch1) [P.E.]
+/// \param sigmaSL - uncertainty of the left side signal
+/// \param sigmaSR - uncertainty of the right side signal
+/// \param PlErr - uncertainty of the left side primary component
+/// \param PrErr - uncertainty of the right side primary component
+void SFAttenuationModel::CalculateUncertainty(double SL, double SR, double sigmaSL,
+                                              double sigmaSR, double& PlErr, double& PrErr)
+{
+    if (fKernel == nullptr)
+    {
+        std::cerr << "##### Error in SFAttenuationModel::CalculateUncertainty()!" << std::endl;
+        std::cerr << "Model not fitted! Call FitModel() first." << std::endl;
+        std::abort();
+    }
+
+    fKernel->PrimaryUncertainty(1, &SL, &SR, sigmaSL, sigmaSR, &PlErr, &PrErr);
 }
 //------------------------------------------------------------------
 /// Fits exponential attenuation model with light reflection to the
 /// experimental data. Model equations are fitted simultaneously to
 /// data sets for left and right side of the fiber. Additionally,
 /// primary component is reconstructed and presented in graphs.
+/// Fitting is performed only once, subsequent calls return immediately.
 bool SFAttenuationModel::FitModel(void)
 {
+    if (fFitterResults != nullptr) return true;
+
     std::cout << "\n\n----- Inside SFAttenuationModel::FitModel() for series " << fSeriesNo << "\n"
               << std::endl;
 
@@ -427,12 +446,9 @@ bool SFAttenuationModel::FitModel(void)
 //     double* derivativesL;
 //     double* derivativesR;
 
-    std::vector<double> parsForErrors(9);
-    parsForErrors[0] = fResults->GetValue(SFResultTypeNum::kLambda);
-    parsForErrors[1] = fResults->GetValue(SFResultTypeNum::kEtaR);
-    parsForErrors[2] = fResults->GetValue(SFResultTypeNum::kEtaL);
-    parsForErrors[3] = fResults->GetValue(SFResultTypeNum::kKsi);
-    parsForErrors[4] = fResults->GetValue(SFResultTypeNum::kLength);
+    //----- uncertainty evaluator bound to the fit results
+    if (fKernel != nullptr) delete fKernel;
+    fKernel = new SFRecoKernel(this);
     
     //std::vector<double> parsForDerivatives(7);
     //parsForDerivatives[0] = fResults->GetValue(SFResultTypeNum::kLambda);
@@ -449,13 +465,10 @@ bool SFAttenuationModel::FitModel(void)
         double sigmaSL = fMAttCh0Graph->GetErrorY(i);
         double sigmaSR = fMAttCh1Graph->GetErrorY(i);
 
-        parsForErrors[5] = SL;
-        parsForErrors[6] = SR;
-        parsForErrors[7] = sigmaSL;
-        parsForErrors[8] = sigmaSR;
+        double signalLCh0Err, signalRCh1Err;
+        CalculateUncertainty(SL, SR, sigmaSL, sigmaSR, signalLCh0Err, signalRCh1Err);
         
         double signalLCh0 = fun_PlReco->Eval(SR, SL);
-        double signalLCh0Err = CalculateUncertainty(parsForErrors, "L");
 
         //parsForDerivatives[5] = SL;
         //parsForDerivatives[6] = SR;
@@ -479,7 +492,6 @@ bool SFAttenuationModel::FitModel(void)
         fMAttCh0CorrGraph->SetPointError(i, SFTools::GetPosError(collimator, testBench), signalLCh0Err);
 
         double signalRCh1 = fun_PrReco->Eval(SR, SL);
-        double signalRCh1Err = CalculateUncertainty(parsForErrors, "R");
 
         //double sigma_fSR = Multiply(derivativesR, covMatrix);
 
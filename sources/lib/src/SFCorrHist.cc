@@ -0,0 +1,291 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *            SFCorrHist.cc              *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#include "SFCorrHist.hh"
+
+ClassImp(SFCorrHist);
+
+/// Approximate memory occupied by a single bin in the sparse storage [B].
+static const size_t gSparseBinSize = 48;
+
+//------------------------------------------------------------------
+/// Returns number of the bin containing given bin of the histogram
+/// rebinned by the given factor. Bins which don't fit in the rebinned
+/// axis go to the overflow bin, like in TH2::Rebin2D().
+/// \param bin - bin number
+/// \param ngroup - number of merged bins
+/// \param nbins - number of bins of the rebinned axis
+static int GroupBin(int bin, int ngroup, int nbins)
+{
+    if (bin == 0) return 0;
+
+    int group = (bin - 1) / ngroup + 1;
+    return group > nbins ? nbins + 1 : group;
+}
+//------------------------------------------------------------------
+/// Default constructor.
+SFCorrHist::SFCorrHist() : TNamed(),
+                           fNbinsX(0),
+                           fXmin(0),
+                           fXmax(0),
+                           fNbinsY(0),
+                           fYmin(0),
+                           fYmax(0),
+                           fEntries(0),
+                           fTsumw(0),
+                           fTsumw2(0),
+                           fTsumwx(0),
+                           fTsumwx2(0),
+                           fTsumwy(0),
+                           fTsumwy2(0),
+                           fTsumwxy(0)
+{
+}
+//------------------------------------------------------------------
+/// Standard constructor. Arguments are the same as for TH2D constructor.
+/// \param name - name of the histogram
+/// \param title - title of the histogram
+/// \param nbinsx - number of bins on X axis
+/// \param xmin - lower edge of X axis
+/// \param xmax - upper edge of X axis
+/// \param nbinsy - number of bins on Y axis
+/// \param ymin - lower edge of Y axis
+/// \param ymax - upper edge of Y axis
+SFCorrHist::SFCorrHist(TString name, TString title, int nbinsx, double xmin, double xmax,
+                       int nbinsy, double ymin, double ymax) : TNamed(name, title),
+                                                               fNbinsX(nbinsx),
+                                                               fXmin(xmin),
+                                                               fXmax(xmax),
+                                                               fNbinsY(nbinsy),
+                                                               fYmin(ymin),
+                                                               fYmax(ymax),
+                                                               fEntries(0),
+                                                               fTsumw(0),
+                                                               fTsumw2(0),
+                                                               fTsumwx(0),
+                                                               fTsumwx2(0),
+                                                               fTsumwy(0),
+                                                               fTsumwy2(0),
+                                                               fTsumwxy(0)
+{
+    if (fNbinsX < 1 || fNbinsY < 1 || fXmax <= fXmin || fYmax <= fYmin)
+    {
+        std::cerr << "##### Error in SFCorrHist constructor! Incorrect binning of " << name
+                  << ": " << fNbinsX << ", " << fXmin << ", " << fXmax << ", " << fNbinsY
+                  << ", " << fYmin << ", " << fYmax << std::endl;
+        throw "##### Exception in SFCorrHist constructor!";
+    }
+}
+//------------------------------------------------------------------
+/// Default destructor.
+SFCorrHist::~SFCorrHist()
+{
+}
+//------------------------------------------------------------------
+/// Returns number of the bin containing given value, like TAxis::FindBin().
+/// \param x - value
+/// \param xmin - lower edge of the axis
+/// \param xmax - upper edge of the axis
+/// \param nbins - number of bins of the axis
+int SFCorrHist::FindBin(double x, double xmin, double xmax, int nbins) const
+{
+    if (x < xmin) return 0;
+    if (!(x < xmax)) return nbins + 1;
+
+    return 1 + int(nbins * (x - xmin) / (xmax - xmin));
+}
+//------------------------------------------------------------------
+/// Moves contents of the filled bins to the dense array of all bins.
+void SFCorrHist::SwitchToDense(void)
+{
+    fDense.assign((fNbinsX + 2) * (fNbinsY + 2), 0);
+
+    for (auto& bin : fSparse)
+        fDense[bin.first] = bin.second;
+
+    fSparse.clear();
+}
+//------------------------------------------------------------------
+/// Calls given function for all filled bins.
+/// \param fun - function taking global bin number and its content
+void SFCorrHist::ForEachBin(const std::function<void(int bin, float content)>& fun) const
+{
+    if (IsSparse())
+    {
+        for (auto& bin : fSparse)
+            fun(bin.first, bin.second);
+    }
+    else
+    {
+        for (size_t bin = 0; bin < fDense.size(); bin++)
+        {
+            if (fDense[bin] != 0) fun(bin, fDense[bin]);
+        }
+    }
+}
+//------------------------------------------------------------------
+/// Calculates binning of the histogram rebinned by the given factors.
+/// Returns false if the factors are incorrect.
+/// \param ngroupx - number of merged bins on X axis
+/// \param ngroupy - number of merged bins on Y axis
+/// \param nbinsx - number of bins on X axis after rebinning
+/// \param xmax - upper edge of X axis after rebinning
+/// \param nbinsy - number of bins on Y axis after rebinning
+/// \param ymax - upper edge of Y axis after rebinning
+bool SFCorrHist::GetGroupedAxes(int ngroupx, int ngroupy, int& nbinsx, double& xmax,
+                                int& nbinsy, double& ymax) const
+{
+    if (ngroupx < 1 || ngroupx > fNbinsX || ngroupy < 1 || ngroupy > fNbinsY)
+    {
+        std::cerr << "##### Error in SFCorrHist::GetGroupedAxes()! Incorrect rebinning of "
+                  << GetName() << ": " << ngroupx << ", " << ngroupy << std::endl;
+        return false;
+    }
+
+    nbinsx = fNbinsX / ngroupx;
+    nbinsy = fNbinsY / ngroupy;
+    xmax   = fXmin + (fXmax - fXmin) / fNbinsX * nbinsx * ngroupx;
+    ymax   = fYmin + (fYmax - fYmin) / fNbinsY * nbinsy * ngroupy;
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Fills histogram, like TH2::Fill().
+/// \param x - value on X axis
+/// \param y - value on Y axis
+/// \param w - weight
+void SFCorrHist::Fill(double x, double y, double w)
+{
+    int binx = FindBin(x, fXmin, fXmax, fNbinsX);
+    int biny = FindBin(y, fYmin, fYmax, fNbinsY);
+    int bin  = binx + (fNbinsX + 2) * biny;
+
+    fEntries++;
+
+    if (IsSparse())
+    {
+        fSparse[bin] += w;
+
+        if (fSparse.size() * gSparseBinSize >= (fNbinsX + 2) * (fNbinsY + 2) * sizeof(float))
+            SwitchToDense();
+    }
+    else
+    {
+        fDense[bin] += w;
+    }
+
+    // like in TH2, underflows and overflows are not included in the statistics
+    if (binx == 0 || binx > fNbinsX || biny == 0 || biny > fNbinsY) return;
+
+    fTsumw += w;
+    fTsumw2 += w * w;
+    fTsumwx += w * x;
+    fTsumwx2 += w * x * x;
+    fTsumwy += w * y;
+    fTsumwy2 += w * y * y;
+    fTsumwxy += w * x * y;
+}
+//------------------------------------------------------------------
+/// Returns content of the given bin. Bins are numbered like in TH2.
+/// \param binx - bin number on X axis
+/// \param biny - bin number on Y axis
+double SFCorrHist::GetBinContent(int binx, int biny) const
+{
+    if (binx < 0 || binx > fNbinsX + 1 || biny < 0 || biny > fNbinsY + 1) return 0;
+
+    int bin = binx + (fNbinsX + 2) * biny;
+
+    if (!IsSparse()) return fDense[bin];
+
+    auto it = fSparse.find(bin);
+    return it == fSparse.end() ? 0 : it->second;
+}
+//------------------------------------------------------------------
+/// Merges bins of the histogram, like TH2::Rebin2D(). Bins which don't fit
+/// in the rebinned axes are moved to the overflow bins. Storage is switched
+/// to the sparse one if it becomes smaller.
+/// \param ngroupx - number of merged bins on X axis
+/// \param ngroupy - number of merged bins on Y axis
+void SFCorrHist::Rebin(int ngroupx, int ngroupy)
+{
+    int    nbinsx = 0, nbinsy = 0;
+    double xmax = 0, ymax = 0;
+
+    if (!GetGroupedAxes(ngroupx, ngroupy, nbinsx, xmax, nbinsy, ymax)) return;
+
+    std::map<int, float> sparse;
+
+    ForEachBin([&](int bin, float content) {
+        int binx = GroupBin(bin % (fNbinsX + 2), ngroupx, nbinsx);
+        int biny = GroupBin(bin / (fNbinsX + 2), ngroupy, nbinsy);
+        sparse[binx + (nbinsx + 2) * biny] += content;
+    });
+
+    fNbinsX = nbinsx;
+    fXmax   = xmax;
+    fNbinsY = nbinsy;
+    fYmax   = ymax;
+    fSparse = sparse;
+    fDense.clear();
+    fDense.shrink_to_fit();
+
+    if (fSparse.size() * gSparseBinSize >= (fNbinsX + 2) * (fNbinsY + 2) * sizeof(float))
+        SwitchToDense();
+}
+//------------------------------------------------------------------
+/// Returns TH2D with the same name, title, binning, contents and statistics,
+/// optionally rebinned by the given factors (see Rebin()). This histogram
+/// is not modified. Returned histogram belongs to the current directory,
+/// like any newly created TH2D, and it is owned by the caller.
+/// \param ngroupx - number of merged bins on X axis
+/// \param ngroupy - number of merged bins on Y axis
+TH2D* SFCorrHist::ToTH2(int ngroupx, int ngroupy) const
+{
+    int    nbinsx = 0, nbinsy = 0;
+    double xmax = 0, ymax = 0;
+
+    if (!GetGroupedAxes(ngroupx, ngroupy, nbinsx, xmax, nbinsy, ymax)) return nullptr;
+
+    TH2D* hist = new TH2D(GetName(), GetTitle(), nbinsx, fXmin, xmax, nbinsy, fYmin, ymax);
+
+    ForEachBin([&](int bin, float content) {
+        int binx = GroupBin(bin % (fNbinsX + 2), ngroupx, nbinsx);
+        int biny = GroupBin(bin / (fNbinsX + 2), ngroupy, nbinsy);
+        hist->AddBinContent(hist->GetBin(binx, biny), content);
+    });
+
+    double stats[7] = {fTsumw, fTsumw2, fTsumwx, fTsumwx2, fTsumwy, fTsumwy2, fTsumwxy};
+    hist->PutStats(stats);
+    hist->SetEntries(fEntries);
+
+    return hist;
+}
+//------------------------------------------------------------------
+/// Returns approximate memory occupied by the histogram [B].
+size_t SFCorrHist::GetMemorySize(void) const
+{
+    return sizeof(SFCorrHist) + fSparse.size() * gSparseBinSize +
+           fDense.capacity() * sizeof(float);
+}
+//------------------------------------------------------------------
+/// Prints details of the SFCorrHist class object.
+void SFCorrHist::Print(void)
+{
+    std::cout << "\n-------------------------------------------" << std::endl;
+    std::cout << "This is print out of SFCorrHist class object" << std::endl;
+    std::cout << "Name: " << GetName() << std::endl;
+    std::cout << "X axis: " << fNbinsX << " bins, " << fXmin << " - " << fXmax << std::endl;
+    std::cout << "Y axis: " << fNbinsY << " bins, " << fYmin << " - " << fYmax << std::endl;
+    std::cout << "Entries: " << fEntries << std::endl;
+    std::cout << "Storage: " << (IsSparse() ? "sparse" : "dense") << ", "
+              << GetMemorySize() / 1024 << " kB" << std::endl;
+    std::cout << "-------------------------------------------\n" << std::endl;
+}
+//------------------------------------------------------------------
@@ -0,0 +1,650 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *               SFCut.cc                *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#include "SFCut.hh"
+#include "SFData.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+ClassImp(SFCut);
+
+//------------------------------------------------------------------
+// field codes; fields of the right signal are shifted by gSideR
+static const int gModule = 0;
+static const int gAmp    = 1;
+static const int gCharge = 2;
+static const int gPE     = 3;
+static const int gT0     = 4;
+static const int gTOT    = 5;
+static const int gBL     = 6;
+static const int gBLsig  = 7;
+static const int gPileUp = 8;
+static const int gVeto   = 9;
+static const int gSideR  = 16;
+
+// depth of the evaluation stack allocated on the program stack
+static const int gStackSize = 64;
+//------------------------------------------------------------------
+namespace
+{
+
+/// Token of the cut string.
+struct CutToken
+{
+    int         fType  = 0;  ///< 0 - number, 1 - identifier, 2 - operator
+    std::string fText  = ""; ///< Text of the identifier or operator
+    double      fValue = 0;  ///< Value of the number
+};
+
+/// Recursive descent parser translating list of tokens into operations
+/// in reverse Polish notation.
+class CutParser
+{
+
+  private:
+    const std::vector<CutToken>& fTokens;
+    std::vector<SFCutOp>&        fOps;
+    std::vector<double>&         fValues;
+    size_t                       fPos = 0;
+    std::string                  fError;
+
+    bool Peek(const char* op)
+    {
+        return fPos < fTokens.size() && fTokens[fPos].fType == 2 && fTokens[fPos].fText == op;
+    }
+
+    void Emit(SFCutOp op, double value = 0)
+    {
+        fOps.push_back(op);
+        fValues.push_back(value);
+    }
+
+    bool ParseOr(void);
+    bool ParseAnd(void);
+    bool ParseComparison(void);
+    bool ParseSum(void);
+    bool ParseProduct(void);
+    bool ParseUnary(void);
+    bool ParsePrimary(void);
+    bool ResolveField(std::string name, int& code);
+
+  public:
+    CutParser(const std::vector<CutToken>& tokens, std::vector<SFCutOp>& ops,
+              std::vector<double>& values)
+        : fTokens(tokens), fOps(ops), fValues(values)
+    {
+    }
+
+    bool Parse(void)
+    {
+        if (!ParseOr()) return false;
+        if (fPos != fTokens.size())
+        {
+            fError = "Unexpected token: " + fTokens[fPos].fText;
+            return false;
+        }
+        return true;
+    }
+
+    std::string GetError(void) { return fError; }
+};
+
+bool CutParser::ParseOr(void)
+{
+    if (!ParseAnd()) return false;
+    while (Peek("||"))
+    {
+        fPos++;
+        if (!ParseAnd()) return false;
+        Emit(SFCutOp::kOr);
+    }
+    return true;
+}
+
+bool CutParser::ParseAnd(void)
+{
+    if (!ParseComparison()) return false;
+    while (Peek("&&"))
+    {
+        fPos++;
+        if (!ParseComparison()) return false;
+        Emit(SFCutOp::kAnd);
+    }
+    return true;
+}
+
+bool CutParser::ParseComparison(void)
+{
+    if (!ParseSum()) return false;
+
+    const char*   ops[]   = {"<=", ">=", "==", "!=", "<", ">"};
+    const SFCutOp codes[] = {SFCutOp::kLessEq, SFCutOp::kGreaterEq, SFCutOp::kEqual,
+                             SFCutOp::kNotEqual, SFCutOp::kLess, SFCutOp::kGreater};
+
+    for (int i = 0; i < 6; i++)
+    {
+        if (Peek(ops[i]))
+        {
+            fPos++;
+            if (!ParseSum()) return false;
+            Emit(codes[i]);
+            break;
+        }
+    }
+    return true;
+}
+
+bool CutParser::ParseSum(void)
+{
+    if (!ParseProduct()) return false;
+    while (Peek("+") || Peek("-"))
+    {
+        SFCutOp op = Peek("+") ? SFCutOp::kAdd : SFCutOp::kSub;
+        fPos++;
+        if (!ParseProduct()) return false;
+        Emit(op);
+    }
+    return true;
+}
+
+bool CutParser::ParseProduct(void)
+{
+    if (!ParseUnary()) return false;
+    while (Peek("*") || Peek("/"))
+    {
+        SFCutOp op = Peek("*") ? SFCutOp::kMul : SFCutOp::kDiv;
+        fPos++;
+        if (!ParseUnary()) return false;
+        Emit(op);
+    }
+    return true;
+}
+
+bool CutParser::ParseUnary(void)
+{
+    if (Peek("-"))
+    {
+        fPos++;
+        if (!ParseUnary()) return false;
+        Emit(SFCutOp::kNeg);
+        return true;
+    }
+    if (Peek("!"))
+    {
+        fPos++;
+        if (!ParseUnary()) return false;
+        Emit(SFCutOp::kNot);
+        return true;
+    }
+    if (Peek("+"))
+    {
+        fPos++;
+        return ParseUnary();
+    }
+    return ParsePrimary();
+}
+
+bool CutParser::ParsePrimary(void)
+{
+    if (fPos >= fTokens.size())
+    {
+        fError = "Unexpected end of the cut";
+        return false;
+    }
+
+    const CutToken& token = fTokens[fPos];
+
+    if (token.fType == 0)
+    {
+        fPos++;
+        Emit(SFCutOp::kNumber, token.fValue);
+        return true;
+    }
+
+    if (Peek("("))
+    {
+        fPos++;
+        if (!ParseOr()) return false;
+        if (!Peek(")"))
+        {
+            fError = "Missing ')'";
+            return false;
+        }
+        fPos++;
+        return true;
+    }
+
+    if (token.fType == 1)
+    {
+        fPos++;
+
+        // function call
+        if (Peek("("))
+        {
+            std::string name = token.fText;
+            size_t      icol = name.rfind("::");
+            if (icol != std::string::npos) name = name.substr(icol + 2);
+            for (auto& c : name)
+                c = tolower(c);
+
+            SFCutOp op;
+            if (name == "log")
+                op = SFCutOp::kLog;
+            else if (name == "log10")
+                op = SFCutOp::kLog10;
+            else if (name == "sqrt")
+                op = SFCutOp::kSqrt;
+            else if (name == "exp")
+                op = SFCutOp::kExp;
+            else if (name == "abs" || name == "fabs")
+                op = SFCutOp::kAbs;
+            else
+            {
+                fError = "Unknown function: " + token.fText;
+                return false;
+            }
+
+            fPos++;
+            if (!ParseOr()) return false;
+            if (!Peek(")"))
+            {
+                fError = "Missing ')' after function argument";
+                return false;
+            }
+            fPos++;
+            Emit(op);
+            return true;
+        }
+
+        int code = -1;
+        if (!ResolveField(token.fText, code)) return false;
+        Emit(SFCutOp::kField, code);
+        return true;
+    }
+
+    fError = "Unexpected token: " + token.fText;
+    return false;
+}
+
+bool CutParser::ResolveField(std::string name, int& code)
+{
+    while (!name.empty() && name.back() == '.')
+        name.pop_back();
+
+    size_t      idot  = name.rfind('.');
+    std::string field = idot == std::string::npos ? name : name.substr(idot + 1);
+    int         side  = name.find("signal_r") != std::string::npos ? gSideR : 0;
+
+    if (field == "module")
+    {
+        code = gModule;
+        return true;
+    }
+    else if (field == "qdc_l" || field == "qdc_r")
+    {
+        code = gCharge + (field == "qdc_r" ? gSideR : 0);
+        return true;
+    }
+    else if (field == "time_l" || field == "time_r")
+    {
+        code = gT0 + (field == "time_r" ? gSideR : 0);
+        return true;
+    }
+    else if (field == "fAmp")
+        code = gAmp;
+    else if (field == "fCharge")
+        code = gCharge;
+    else if (field == "fPE")
+        code = gPE;
+    else if (field == "fT0")
+        code = gT0;
+    else if (field == "fTOT")
+        code = gTOT;
+    else if (field == "fBL")
+        code = gBL;
+    else if (field == "fBL_sigma" || field == "fBLsig")
+        code = gBLsig;
+    else if (field == "fPileUp")
+        code = gPileUp;
+    else if (field == "fVeto")
+        code = gVeto;
+    else
+    {
+        fError = "Unknown field: " + name + ". Available fields are: fAmp, fCharge, fPE, fT0, "
+                 "fTOT, fBL, fBL_sigma, fPileUp, fVeto, qdc_l/r, time_l/r and module.";
+        return false;
+    }
+
+    code += side;
+    return true;
+}
+
+/// Splits cut string into tokens.
+bool Tokenize(const std::string& cut, std::vector<CutToken>& tokens, std::string& error)
+{
+    const char* ops[] = {"&&", "||", "<=", ">=", "==", "!=", "<", ">",
+                         "!",  "+",  "-",  "*",  "/",  "(",  ")"};
+
+    size_t i = 0;
+    while (i < cut.length())
+    {
+        char c = cut[i];
+
+        if (isspace(c))
+        {
+            i++;
+            continue;
+        }
+
+        CutToken token;
+
+        if (isdigit(c) || (c == '.' && i + 1 < cut.length() && isdigit(cut[i + 1])))
+        {
+            char* end    = nullptr;
+            token.fType  = 0;
+            token.fValue = strtod(cut.c_str() + i, &end);
+            token.fText  = cut.substr(i, end - (cut.c_str() + i));
+            i            = end - cut.c_str();
+        }
+        else if (isalpha(c) || c == '_')
+        {
+            size_t start = i;
+            while (i < cut.length() &&
+                   (isalnum(cut[i]) || cut[i] == '_' || cut[i] == '.' ||
+                    (cut[i] == ':' && i + 1 < cut.length() && cut[i + 1] == ':')))
+            {
+                i += cut[i] == ':' ? 2 : 1;
+            }
+            token.fType = 1;
+            token.fText = cut.substr(start, i - start);
+        }
+        else
+        {
+            bool found = false;
+            for (auto op : ops)
+            {
+                if (cut.compare(i, strlen(op), op) == 0)
+                {
+                    token.fType = 2;
+                    token.fText = op;
+                    i += strlen(op);
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+            {
+                error = std::string("Unexpected character: ") + c;
+                return false;
+            }
+        }
+
+        tokens.push_back(token);
+    }
+
+    return true;
+}
+
+} // namespace
+//------------------------------------------------------------------
+/// Default constructor. Cut is empty, i.e. always fulfilled.
+SFCut::SFCut() : fCut(""),
+                 fDepth(0)
+{
+}
+//------------------------------------------------------------------
+/// Standard constructor.
+/// \param cut - logic cut (syntax explained in the class description)
+SFCut::SFCut(TString cut) : fCut(""),
+                            fDepth(0)
+{
+
+    if (!SetCut(cut)) { throw "##### Exception in SFCut constructor!"; }
+}
+//------------------------------------------------------------------
+/// Default destructor.
+SFCut::~SFCut()
+{
+}
+//------------------------------------------------------------------
+/// Parses and compiles given cut. Returns false if the cut syntax is
+/// incorrect; in this case cut is reset to the empty one.
+/// \param cut - logic cut (syntax explained in the class description)
+bool SFCut::SetCut(TString cut)
+{
+
+    fCut = cut;
+    fOps.clear();
+    fValues.clear();
+    fDepth = 0;
+
+    std::vector<CutToken> tokens;
+    std::string           error;
+
+    bool status = Tokenize(std::string(cut), tokens, error);
+
+    if (status && !tokens.empty())
+    {
+        CutParser parser(tokens, fOps, fValues);
+        status = parser.Parse();
+        if (!status) error = parser.GetError();
+    }
+
+    if (!status)
+    {
+        std::cerr << "##### Error in SFCut::SetCut()! Incorrect cut syntax!" << std::endl;
+        std::cerr << "Cut: " << cut << std::endl;
+        std::cerr << error << std::endl;
+        fCut = "";
+        fOps.clear();
+        fValues.clear();
+        return false;
+    }
+
+    //----- calculating required depth of the stack
+    int depth    = 0;
+    int maxDepth = 0;
+
+    for (auto op : fOps)
+    {
+        switch (op)
+        {
+            case SFCutOp::kNumber:
+            case SFCutOp::kField:
+                depth++;
+                break;
+            case SFCutOp::kNeg:
+            case SFCutOp::kNot:
+            case SFCutOp::kLog:
+            case SFCutOp::kLog10:
+            case SFCutOp::kSqrt:
+            case SFCutOp::kExp:
+            case SFCutOp::kAbs:
+                break;
+            default:
+                depth--;
+                break;
+        }
+        maxDepth = std::max(maxDepth, depth);
+    }
+
+    fDepth = maxDepth;
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Returns value of the requested field.
+/// \param code - field code
+/// \param sigL - left signal
+/// \param sigR - right signal
+/// \param module - module number
+double SFCut::GetField(int code, const SFSignal* sigL, const SFSignal* sigR, int module) const
+{
+
+    if (code == gModule) return module;
+
+    const SFSignal* sig = code >= gSideR ? sigR : sigL;
+
+    switch (code % gSideR)
+    {
+        case gAmp:
+            return sig->fAmp;
+        case gCharge:
+            return sig->fCharge;
+        case gPE:
+            return sig->fPE;
+        case gT0:
+            return sig->fT0;
+        case gTOT:
+            return sig->fTOT;
+        case gBL:
+            return sig->fBL;
+        case gBLsig:
+            return sig->fBLsig;
+        case gPileUp:
+            return sig->fPileUp;
+        case gVeto:
+            return sig->fVeto;
+        default:
+            return 0;
+    }
+}
+//------------------------------------------------------------------
+/// Checks whether the signal fulfills the cut. All signal fields used in
+/// the cut (also those with the "signal_r" prefix) refer to the given signal.
+/// \param sig - analyzed signal
+/// \param module - module number of the signal
+bool SFCut::Evaluate(const SFSignal* sig, int module) const
+{
+    return Evaluate(sig, sig, module);
+}
+//------------------------------------------------------------------
+/// Checks whether the pair of signals fulfills the cut. The evaluation
+/// stack is local, so the same cut can be evaluated from many threads.
+/// \param sigL - left signal (ch0 or ch2)
+/// \param sigR - right signal (ch1)
+/// \param module - module number
+bool SFCut::Evaluate(const SFSignal* sigL, const SFSignal* sigR, int module) const
+{
+
+    if (fOps.empty()) return true;
+
+    double              local[gStackSize];
+    std::vector<double> heap;
+    double*             stack = local;
+
+    if (fDepth > gStackSize)
+    {
+        heap.resize(fDepth);
+        stack = heap.data();
+    }
+
+    int       top  = -1;
+    const int nops = fOps.size();
+
+    for (int i = 0; i < nops; i++)
+    {
+        switch (fOps[i])
+        {
+            case SFCutOp::kNumber:
+                stack[++top] = fValues[i];
+                break;
+            case SFCutOp::kField:
+                stack[++top] = GetField((int)fValues[i], sigL, sigR, module);
+                break;
+            case SFCutOp::kNeg:
+                stack[top] = -stack[top];
+                break;
+            case SFCutOp::kNot:
+                stack[top] = !stack[top];
+                break;
+            case SFCutOp::kLog:
+                stack[top] = log(stack[top]);
+                break;
+            case SFCutOp::kLog10:
+                stack[top] = log10(stack[top]);
+                break;
+            case SFCutOp::kSqrt:
+                stack[top] = sqrt(stack[top]);
+                break;
+            case SFCutOp::kExp:
+                stack[top] = exp(stack[top]);
+                break;
+            case SFCutOp::kAbs:
+                stack[top] = fabs(stack[top]);
+                break;
+            case SFCutOp::kAdd:
+                top--;
+                stack[top] = stack[top] + stack[top + 1];
+                break;
+            case SFCutOp::kSub:
+                top--;
+                stack[top] = stack[top] - stack[top + 1];
+                break;
+            case SFCutOp::kMul:
+                top--;
+                stack[top] = stack[top] * stack[top + 1];
+                break;
+            case SFCutOp::kDiv:
+                top--;
+                stack[top] = stack[top] / stack[top + 1];
+                break;
+            case SFCutOp::kLess:
+                top--;
+                stack[top] = stack[top] < stack[top + 1];
+                break;
+            case SFCutOp::kGreater:
+                top--;
+                stack[top] = stack[top] > stack[top + 1];
+                break;
+            case SFCutOp::kLessEq:
+                top--;
+                stack[top] = stack[top] <= stack[top + 1];
+                break;
+            case SFCutOp::kGreaterEq:
+                top--;
+                stack[top] = stack[top] >= stack[top + 1];
+                break;
+            case SFCutOp::kEqual:
+                top--;
+                stack[top] = stack[top] == stack[top + 1];
+                break;
+            case SFCutOp::kNotEqual:
+                top--;
+                stack[top] = stack[top] != stack[top + 1];
+                break;
+            case SFCutOp::kAnd:
+                top--;
+                stack[top] = stack[top] && stack[top + 1];
+                break;
+            case SFCutOp::kOr:
+                top--;
+                stack[top] = stack[top] || stack[top + 1];
+                break;
+        }
+    }
+
+    return stack[0] != 0;
+}
+//------------------------------------------------------------------
+/// Prints details of the SFCut class object.
+void SFCut::Print(void)
+{
+    std::cout << "\n-------------------------------------------" << std::endl;
+    std::cout << "This is print out of SFCut class object" << std::endl;
+    std::cout << "Cut: " << fCut << std::endl;
+    std::cout << "Number of compiled operations: " << fOps.size() << std::endl;
+    std::cout << "-------------------------------------------\n" << std::endl;
+}
+//------------------------------------------------------------------
@@ -9,8 +9,12 @@
 // *****************************************
 
 #include "SFData.hh"
+#include "SFFilePool.hh"
+#include "SFHistCache.hh"
 
+#include <cstdlib>
 #include <memory>
+#include <mutex>
 
 ClassImp(SFData);
 
@@ -21,6 +25,61 @@ static const int    gBLMax = 50;               // number of samples for base lin
 static const double gmV    = 4.096;            // coefficient to calibrate ADC channels to mV
 const double        ampMax = 660;              // maximal valid amplitude in the measurements 
                                                // with the Desktop Digitizer
+
+/// Connections to the data bases shared by all SFData objects, accessed by file name.
+static std::map<TString, sqlite3*> gDataBases;
+/// Mutex protecting gDataBases.
+static std::mutex gDataBasesMutex;
+/// Flag indicating whether CloseDataBases() has been registered to be called at exit.
+static bool gCloseRegistered = false;
+
+/// Closes all shared connections to the data bases at the end of the program.
+static void CloseDataBases(void)
+{
+    std::lock_guard<std::mutex> lock(gDataBasesMutex);
+
+    for (auto& db : gDataBases)
+        sqlite3_close_v2(db.second);
+
+    gDataBases.clear();
+}
+
+/// Details of a single experimental series and its measurements, as stored
+/// in the SERIES and MEASUREMENT tables of the data base.
+struct SeriesDetails
+{
+    TString              fFiber;
+    double               fFiberLength = -1;
+    TString              fSource;
+    TString              fTestBench;
+    TString              fCollimator;
+    TString              fSiPM;
+    double               fOvervoltage = -1;
+    TString              fCoupling;
+    int                  fNpoints = -1;
+    TString              fLogFile;
+    TString              fTempFile;
+    TString              fDesc;
+    TString              fDAQ;
+    std::vector<TString> fNames;
+    std::vector<int>     fTimes;
+    std::vector<double>  fPositions;
+    std::vector<int>     fStart;
+    std::vector<int>     fStop;
+    std::vector<int>     fMeasureID;
+};
+
+/// Details of all experimental series of a data base.
+struct SeriesTable
+{
+    int                          fCount = 0; ///< Number of rows in the SERIES table
+    std::map<int, SeriesDetails> fSeries;    ///< Details accessed by series number
+};
+
+/// Series details already read from the data bases, accessed by connection.
+static std::map<sqlite3*, SeriesTable> gSeriesTables;
+/// Mutex protecting gSeriesTables.
+static std::mutex gSeriesTablesMutex;
 //------------------------------------------------------------------
 /// Default constructor. If this constructor is used the series
 /// number should be set via SetDetails(int seriesNo) function.
@@ -71,21 +130,38 @@ SFData::SFData(int seriesNo) : fSeriesNo(seriesNo),
 SFData::~SFData()
 {
 
-    int status = sqlite3_close(fDB);
-    if (status != 0) std::cerr << "In SFData destructor. Data base corrupted!" << std::endl;
+    for (auto& cache : fEventCache)
+        delete cache.second;
 
-    for (auto h : fFiles)
-        delete h;
+    for (auto& reader : fAachenReaders)
+        delete reader.second;
 }
 //------------------------------------------------------------------
 /// Opens SQLite3 data base containing details of experimental series
-/// and measurements.
+/// and measurements. The connection is opened only once and shared by
+/// all SFData objects, so that processing of many series in one program
+/// (see sfbatch) doesn't open the data base again for each series.
+/// Connection is opened in serialized mode, i.e. it can be used from
+/// multiple threads, and it is kept open until the end of the program,
+/// when all shared connections are closed.
 /// \param name - name of the data base file.
 bool SFData::OpenDataBase(TString name)
 {
 
     TString db_name = std::string(gPath) + "/DB/" + name;
-    int     status  = sqlite3_open(db_name, &fDB);
+
+    std::lock_guard<std::mutex> lock(gDataBasesMutex);
+
+    auto it = gDataBases.find(db_name);
+    if (it != gDataBases.end())
+    {
+        fDB = it->second;
+        return true;
+    }
+
+    int status = sqlite3_open_v2(db_name, &fDB,
+                                 SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
+                                 nullptr);
 
     std::cout << db_name << std::endl;
     
@@ -93,15 +169,103 @@ bool SFData::OpenDataBase(TString name)
     {
         std::cerr << "##### Error in SFData::OpenDataBase()!" << std::endl;
         std::cerr << "Could not access data base!" << std::endl;
+        sqlite3_close(fDB);
+        fDB = nullptr;
         return false;
     }
 
+    if (!gCloseRegistered)
+    {
+        std::atexit(CloseDataBases);
+        gCloseRegistered = true;
+    }
+
+    gDataBases[db_name] = fDB;
+
     return true;
 }
 //------------------------------------------------------------------
+/// Returns text stored in the given column of the current row, or empty
+/// string if the value is NULL.
+static TString ColumnText(sqlite3_stmt* statement, int col)
+{
+    const unsigned char* text = sqlite3_column_text(statement, col);
+    if (text == nullptr) return "";
+    return std::string(reinterpret_cast<const char*>(text));
+}
+//------------------------------------------------------------------
+/// Reads details of all experimental series and all measurements from
+/// the data base. Each table is read with a single query.
+/// \param db - connection to the data base
+/// \param table - filled with the details of all series
+static bool LoadSeriesTable(sqlite3* db, SeriesTable& table)
+{
+    sqlite3_stmt* statement;
+    int           status;
+
+    status = sqlite3_prepare_v2(db,
+                                "SELECT SERIES_ID, FIBER, FIBER_LENGTH, SOURCE, TEST_BENCH, "
+                                "COLLIMATOR, SIPM, OVERVOLTAGE, COUPLING, NO_MEASUREMENTS, "
+                                "LOG_FILE, TEMP_FILE, DESCRIPTION, DAQ FROM SERIES",
+                                -1, &statement, nullptr);
+
+    if (!SFTools::CheckDBStatus(status, db)) return false;
+
+    while ((status = sqlite3_step(statement)) == SQLITE_ROW)
+    {
+        SeriesDetails& d = table.fSeries[sqlite3_column_int(statement, 0)];
+        d.fFiber         = ColumnText(statement, 1);
+        d.fFiberLength   = sqlite3_column_double(statement, 2);
+        d.fSource        = ColumnText(statement, 3);
+        d.fTestBench     = ColumnText(statement, 4);
+        d.fCollimator    = ColumnText(statement, 5);
+        d.fSiPM          = ColumnText(statement, 6);
+        d.fOvervoltage   = sqlite3_column_double(statement, 7);
+        d.fCoupling      = ColumnText(statement, 8);
+        d.fNpoints       = sqlite3_column_int(statement, 9);
+        d.fLogFile       = ColumnText(statement, 10);
+        d.fTempFile      = ColumnText(statement, 11);
+        d.fDesc          = ColumnText(statement, 12);
+        d.fDAQ           = ColumnText(statement, 13);
+        table.fCount++;
+    }
+
+    sqlite3_finalize(statement);
+
+    if (!SFTools::CheckDBStatus(status, db)) return false;
+
+    status = sqlite3_prepare_v2(db,
+                                "SELECT SERIES_ID, MEASUREMENT_NAME, DURATION_TIME, "
+                                "SOURCE_POSITION, START_TIME, STOP_TIME, MEASUREMENT_ID "
+                                "FROM MEASUREMENT",
+                                -1, &statement, nullptr);
+
+    if (!SFTools::CheckDBStatus(status, db)) return false;
+
+    while ((status = sqlite3_step(statement)) == SQLITE_ROW)
+    {
+        auto itr = table.fSeries.find(sqlite3_column_int(statement, 0));
+        if (itr == table.fSeries.end()) continue;
+
+        SeriesDetails& d = itr->second;
+        d.fNames.push_back(ColumnText(statement, 1));
+        d.fTimes.push_back(sqlite3_column_int(statement, 2));
+        d.fPositions.push_back(sqlite3_column_double(statement, 3));
+        d.fStart.push_back(sqlite3_column_int(statement, 4));
+        d.fStop.push_back(sqlite3_column_int(statement, 5));
+        d.fMeasureID.push_back(sqlite3_column_int(statement, 6));
+    }
+
+    sqlite3_finalize(statement);
+
+    return SFTools::CheckDBStatus(status, db);
+}
+//------------------------------------------------------------------
 /// Sets all details of selected experimental series. If default constructor
 /// was used, this function needs to be called explicitly with the number of
-/// of requested series as an argument.
+/// of requested series as an argument. Details of all series are read from
+/// the data base at the first call in the program and kept in memory, so that
+/// subsequent SFData objects don't query the data base again.
 /// \param seriesNo - number of experimental series to analyze.
 ///
 /// The following attributes of the experimental series are set within this
@@ -109,29 +273,30 @@ bool SFData::OpenDataBase(TString name)
 bool SFData::SetDetails(int seriesNo)
 {
 
-    TString       query;
-    sqlite3_stmt* statement;
-    int           status;
-
     if (fSeriesNo == -1) fSeriesNo = seriesNo;
 
-    //-----Checking if series number is valid
-    int maxSeries;
-    query  = "SELECT COUNT(*) FROM SERIES";
-    status = sqlite3_prepare_v2(fDB, query, -1, &statement, nullptr);
+    std::lock_guard<std::mutex> lock(gSeriesTablesMutex);
 
-    SFTools::CheckDBStatus(status, fDB);
+    auto table = gSeriesTables.find(fDB);
 
-    while ((status = sqlite3_step(statement)) == SQLITE_ROW)
+    if (table == gSeriesTables.end())
     {
-        maxSeries = sqlite3_column_int(statement, 0);
-    }
+        SeriesTable loaded;
 
-    SFTools::CheckDBStatus(status, fDB);
+        if (!LoadSeriesTable(fDB, loaded))
+        {
+            std::cerr << "##### Error in SFData::SetDetails()! Could not read series details!"
+                      << std::endl;
+            return false;
+        }
 
-    sqlite3_finalize(statement);
+        table = gSeriesTables.emplace(fDB, loaded).first;
+    }
 
-    if (fSeriesNo < 1 || fSeriesNo > maxSeries)
+    //-----Checking if series number is valid
+    auto series = table->second.fSeries.find(fSeriesNo);
+
+    if (fSeriesNo < 1 || fSeriesNo > table->second.fCount || series == table->second.fSeries.end())
     {
         std::cerr << "##### Error in SFData::SetDetails()! Series number out of range!"
                   << std::endl;
@@ -139,6 +304,8 @@ bool SFData::SetDetails(int seriesNo)
     }
     //-----
 
+    const SeriesDetails& details = series->second;
+
     //----- Setting series attributes
     ///- fiber type
     ///- liber length [mm]
@@ -153,44 +320,19 @@ bool SFData::SetDetails(int seriesNo)
     ///- name of the temperature log file
     ///- description of the series
     ///- daq
-    query  = Form("SELECT FIBER, FIBER_LENGTH, SOURCE, TEST_BENCH, COLLIMATOR, SIPM, OVERVOLTAGE, "
-                 "COUPLING, NO_MEASUREMENTS, LOG_FILE, TEMP_FILE, DESCRIPTION, DAQ FROM "
-                 "SERIES WHERE SERIES_ID = %i",
-                 fSeriesNo);
-    status = sqlite3_prepare_v2(fDB, query, -1, &statement, nullptr);
-
-    SFTools::CheckDBStatus(status, fDB);
-
-    while ((status = sqlite3_step(statement)) == SQLITE_ROW)
-    {
-        const unsigned char* fiber       = sqlite3_column_text(statement, 0);
-        const unsigned char* source      = sqlite3_column_text(statement, 2);
-        const unsigned char* test_bench  = sqlite3_column_text(statement, 3);
-        const unsigned char* collimator  = sqlite3_column_text(statement, 4);
-        const unsigned char* sipm        = sqlite3_column_text(statement, 5);
-        const unsigned char* coupling    = sqlite3_column_text(statement, 7);
-        const unsigned char* logfile     = sqlite3_column_text(statement, 9);
-        const unsigned char* tempfile    = sqlite3_column_text(statement, 10);
-        const unsigned char* description = sqlite3_column_text(statement, 11);
-        const unsigned char* daq         = sqlite3_column_text(statement, 12);
-        fNpoints                         = sqlite3_column_int(statement, 8);
-        fFiberLength                     = sqlite3_column_double(statement, 1);
-        fOvervoltage                     = sqlite3_column_double(statement, 6);
-        fFiber                           = std::string(reinterpret_cast<const char*>(fiber));
-        fSource                          = std::string(reinterpret_cast<const char*>(source));
-        fDesc                            = std::string(reinterpret_cast<const char*>(description));
-        fCollimator                      = std::string(reinterpret_cast<const char*>(collimator));
-        fTestBench                       = std::string(reinterpret_cast<const char*>(test_bench));
-        fSiPM                            = std::string(reinterpret_cast<const char*>(sipm));
-        fCoupling                        = std::string(reinterpret_cast<const char*>(coupling));
-        fLogFile                         = std::string(reinterpret_cast<const char*>(logfile));
-        fTempFile                        = std::string(reinterpret_cast<const char*>(tempfile));
-        fDAQ                             = std::string(reinterpret_cast<const char*>(daq));
-    }
-
-    SFTools::CheckDBStatus(status, fDB);
-
-    sqlite3_finalize(statement);
+    fFiber       = details.fFiber;
+    fFiberLength = details.fFiberLength;
+    fSource      = details.fSource;
+    fTestBench   = details.fTestBench;
+    fCollimator  = details.fCollimator;
+    fSiPM        = details.fSiPM;
+    fOvervoltage = details.fOvervoltage;
+    fCoupling    = details.fCoupling;
+    fNpoints     = details.fNpoints;
+    fLogFile     = details.fLogFile;
+    fTempFile    = details.fTempFile;
+    fDesc        = details.fDesc;
+    fDAQ         = details.fDAQ;
     //-----
 
     //----- Setting measurements attributes
@@ -200,293 +342,139 @@ bool SFData::SetDetails(int seriesNo)
     ///- list of measurements starting times
     ///- list of measurements stopping times
     ///- list of measurements IDs
-    query  = Form("SELECT MEASUREMENT_NAME, DURATION_TIME, SOURCE_POSITION, START_TIME, STOP_TIME, "
-                 "MEASUREMENT_ID FROM MEASUREMENT WHERE SERIES_ID = %i",
-                 fSeriesNo);
-    status = sqlite3_prepare_v2(fDB, query, -1, &statement, nullptr);
-
-    SFTools::CheckDBStatus(status, fDB);
-
-    while ((status = sqlite3_step(statement)) == SQLITE_ROW)
-    {
-        const unsigned char* name = sqlite3_column_text(statement, 0);
-        fNames.push_back(std::string(reinterpret_cast<const char*>(name)));
-        fTimes.push_back(sqlite3_column_int(statement, 1));
-        fPositions.push_back(sqlite3_column_double(statement, 2));
-        fStart.push_back(sqlite3_column_int(statement, 3));
-        fStop.push_back(sqlite3_column_int(statement, 4));
-        fMeasureID.push_back(sqlite3_column_int(statement, 5));
-    }
-
-    SFTools::CheckDBStatus(status, fDB);
-
-    sqlite3_finalize(statement);
+    fNames     = details.fNames;
+    fTimes     = details.fTimes;
+    fPositions = details.fPositions;
+    fStart     = details.fStart;
+    fStop      = details.fStop;
+    fMeasureID = details.fMeasureID;
 
     return true;
 }
 //------------------------------------------------------------------
-/// Converts DDSignal object (DesktopDigitizer6-based signal) into 
-/// universal SFSignal object. 
+/// Converts DDSignal object (DesktopDigitizer6-based signal) into
+/// universal SFSignal object. The signal is filled in place, so that the
+/// same object can be reused for all events without any allocations.
 /// \param sig - signal (DDSignal object)
-SFSignal* SFData::ConvertSignal(DDSignal* sig)
+/// \param converted - filled signal
+void SFData::ConvertSignal(DDSignal* sig, SFSignal& converted)
 {
 
-    SFSignal* converted   = new SFSignal();
-    converted->fAmp       = sig->GetAmplitude();
-    converted->fCharge    = sig->GetCharge();
-    converted->fPE        = sig->GetPE();
-    converted->fT0        = sig->GetT0();
-    converted->fTOT       = sig->GetTOT();
-    converted->fSDDSignal = false;
-
-    return converted;
+    converted            = SFSignal();
+    converted.fAmp       = sig->GetAmplitude();
+    converted.fCharge    = sig->GetCharge();
+    converted.fPE        = sig->GetPE();
+    converted.fT0        = sig->GetT0();
+    converted.fTOT       = sig->GetTOT();
+    converted.fSDDSignal = false;
 }
 //------------------------------------------------------------------
-/// Converts DDSignal object (sifi-framework-based signal) into 
-/// universal SFSignal object. 
+/// Converts SDDSignal object (sifi-framework-based signal) into
+/// universal SFSignal object. The signal is filled in place (see above).
 /// \param sig - signal (SDDSignal object)
-SFSignal* SFData::ConvertSignal(SDDSignal* sig)
+/// \param converted - filled signal
+void SFData::ConvertSignal(SDDSignal* sig, SFSignal& converted)
+{
+
+    converted            = SFSignal();
+    converted.fAmp       = sig->GetAmplitude();
+    converted.fCharge    = sig->GetCharge();
+    converted.fPE        = sig->GetPE();
+    converted.fT0        = sig->GetT0();
+    converted.fTOT       = sig->GetTOT();
+    converted.fBL        = sig->GetBL();
+    converted.fBLsig     = sig->GetBLSigma();
+    converted.fPileUp    = sig->GetPileUp();
+    converted.fVeto      = sig->GetVeto();
+    converted.fSDDSignal = true;
+}
+//------------------------------------------------------------------
+/// Converts one side of SFibersRaw object (hit registered with the PMI
+/// test bench) into universal SFSignal object. Like in the selections of
+/// SFDrawCommands, QDC value is used both as charge and PE, and time as
+/// T0. The signal is filled in place (see above).
+/// \param hit - hit (SFibersRaw object)
+/// \param side - side of the fiber: 0 - left, 1 - right
+/// \param converted - filled signal
+void SFData::ConvertSignal(SFibersRaw* hit, int side, SFSignal& converted)
 {
 
-    SFSignal* converted   = new SFSignal();
-    converted->fAmp       = sig->GetAmplitude();
-    converted->fCharge    = sig->GetCharge();
-    converted->fPE        = sig->GetPE();
-    converted->fT0        = sig->GetT0();
-    converted->fTOT       = sig->GetTOT();
-    converted->fBL        = sig->GetBL();
-    converted->fBLsig     = sig->GetBLSigma();
-    converted->fPileUp    = sig->GetPileUp();
-    converted->fVeto      = sig->GetVeto();
-    converted->fSDDSignal = true;
-
-    return converted;
+    converted            = SFSignal();
+    converted.fCharge    = side == 0 ? hit->getQDCL() : hit->getQDCR();
+    converted.fPE        = converted.fCharge;
+    converted.fT0        = side == 0 ? hit->getTimeL() : hit->getTimeR();
+    converted.fSDDSignal = false;
 }
 //------------------------------------------------------------------
-/// Opens ROOT files containing experimental data for the analyzed
-/// experimental series. 
+/// Finds ROOT files containing experimental data for the analyzed
+/// experimental series. Files are not opened here, but on demand, when
+/// data of the measurement is accessed (see AcquireFile()).
 bool SFData::OpenFiles(void)
 {
 
-    TString fname = "";
+    fFiles.clear();
 
     for (int i = 0; i < fNpoints; i++)
-    {
-        fname = SFTools::FindData(fNames[i]);
-        fFiles.push_back(new TFile(fname + "/sifi_results.root", "READ"));
-        if (!fFiles[i]->IsOpen())
-        {
-            std::cerr << "##### Error in SFData::OpenFiles()" << std::endl;
-            std::cerr << "Couldn't open: " << fname << "/sifi_results.root" << std::endl;
-            std::abort();
-        }
-    }
+        fFiles.push_back(SFTools::FindData(fNames[i]) + "/sifi_results.root");
 
     return true;
 }
 //------------------------------------------------------------------
-/// Parses given cut and checks if signal fulfills conditions specified by it.
-/// \param sig - currently analyzed signal, as read from the tree
-/// \param cut - a logic cut to select specific signals.
-///
-/// For floating point variables (fAmp, fCharge, fPE, fT0, fTOT, fBL, fBL_sigma)
-/// the following syntax of the cut is acceptable:
-/// - inequality signs: '<' and '>'
-/// - single expressions, e.g. "fAmp>50", "ch_0.fPE>10", "fT0<100"
-/// - double expressions with &&, e.g. "fPE>10 && fPE<100", "ch_0.fT0>0 && ch_0.fT0<500"
-///
-/// For intiger variables (fPileUp and fVeto) the following syntax is acceptable:
-/// - equality sign '=='
-/// - single expressions, eg. "fVeto==1", "fPileUp==0"
-/// - double expressions, eg. "fVeto==0 && fPileUp==0"
-///
-/// If empty cut is passed returns true.
-bool SFData::InterpretCut(SFSignal* sig, TString cut)
+/// Returns opened ROOT file with experimental data of the requested
+/// measurement. File is taken from SFFilePool, therefore it has to be
+/// returned with SFFilePool::Release() when it is no longer needed.
+/// \param index - index of the measurement in the series
+TFile* SFData::AcquireFile(int index)
 {
 
-    bool result = true;
-    if (cut == "" || cut == " ") return result;
-
-    double amp     = sig->fAmp;
-    double charge  = sig->fCharge;
-    double pe      = sig->fPE;
-    double t0      = sig->fT0;
-    double tot     = sig->fTOT;
-    double bl      = sig->fBL;
-    double blsig   = sig->fBLsig;
-    int    pileup  = sig->fPileUp;
-    int    veto    = sig->fVeto;
-    bool   SDDflag = sig->fSDDSignal;
-
-    // convert TString into string and char[]
-    std::string cut_str  = std::string(cut);
-    int         nletters = cut_str.length();
-    char        letters[nletters];
-    strcpy(letters, cut_str.c_str());
-
-    // splitting cut into expressions
-    int         iposition    = -1;
-    int         nexpressions = 0;
-    std::string expression[2];
-
-    for (int i = 0; i < nletters; i++)
-    {
-        if (letters[i] == '&' && letters[i + 1] == '&')
-        {
-            iposition = i;
-            break;
-        }
-    }
-
-    if (iposition == -1)
-    {
-        nexpressions  = 1;
-        expression[0] = cut_str;
-    }
-    else
-    {
-        nexpressions  = 2;
-        expression[0] = std::string(&letters[0], &letters[iposition]);
-        expression[1] = std::string(&letters[iposition + 2], &letters[nletters]);
-    }
-
-    // extracting doubles
-    int         nletters_expr = 0;
-    int         istop         = -1;
-    char        letters_expr[100];
-    std::string number_str[2];
-    double      number[2];
+    TFile* file = SFFilePool::Acquire(fFiles[index]);
 
-    for (int i = 0; i < nexpressions; i++)
+    if (file == nullptr)
     {
-        istop         = -1;
-        nletters_expr = expression[i].length();
-        strcpy(letters_expr, expression[i].c_str());
-        for (int ii = nletters_expr; ii > 0; ii--)
-        {
-            if (letters_expr[ii] == '<' || letters_expr[ii] == '>')
-            {
-                istop = ii + 1;
-                break;
-            }
-            else if (letters_expr[ii] == '=')
-            {
-                istop = ii + 2;
-                break;
-            }
-        }
-        if (istop == -1)
-        {
-            std::cerr << "#### Error in SFData::InterpretCut! Incorrect cut syntax!" << std::endl;
-            std::cerr << "Missing '<' or '>'." << std::endl;
-            return false;
-        }
-        number_str[i] = std::string(&letters_expr[istop], &letters_expr[nletters_expr]);
-        number[i]     = atof(number_str[i].c_str());
+        std::cerr << "##### Error in SFData::AcquireFile()" << std::endl;
+        std::cerr << "Couldn't open: " << fFiles[index] << std::endl;
+        std::abort();
     }
 
-    // checking logic
-    bool logic[2] = {true, true};
+    return file;
+}
+//------------------------------------------------------------------
+/// Schedules reading of the given file of the next SFPrefetcher::GetDepth()
+/// measurements in the background, so that it is read from the disk while
+/// the current measurement is analyzed.
+/// \param index - index of the analyzed measurement
+/// \param fname - name of the file in the directory of the measurement
+/// \param alternative - name of the file read instead, if fname doesn't exist
+void SFData::Prefetch(int index, TString fname, TString alternative)
+{
+    int depth = SFPrefetcher::GetDepth();
 
-    for (int i = 0; i < nexpressions; i++)
+    for (int i = index + 1; i <= index + depth && i < fNpoints; i++)
     {
+        TString directory = gSystem->DirName(fFiles[i]);
+        TString path      = directory + "/" + fname;
 
-        if (expression[i].find("fAmp") != std::string::npos)
-        { // cut on fAmp
-            if (expression[i].find("<") != std::string::npos) { logic[i] = amp < number[i]; }
-            else if (expression[i].find(">") != std::string::npos)
-            {
-                logic[i] = amp > number[i];
-            }
-        }
-
-        else if (expression[i].find("fPE") != std::string::npos)
-        { // cut on fPE
-            if (expression[i].find("<") != std::string::npos) { logic[i] = pe < number[i]; }
-            else if (expression[i].find(">") != std::string::npos)
-            {
-                logic[i] = pe > number[i];
-            }
-        }
-
-        else if (expression[i].find("fCharge") != std::string::npos)
-        { // cut on fCharge
-            if (expression[i].find("<") != std::string::npos) { logic[i] = charge < number[i]; }
-            else if (expression[i].find(">") != std::string::npos)
-            {
-                logic[i] = charge > number[i];
-            }
-        }
-
-        else if (expression[i].find("fT0") != std::string::npos)
-        { // cut on fT0
-            if (expression[i].find("<") != std::string::npos) { logic[i] = t0 < number[i]; }
-            else if (expression[i].find(">") != std::string::npos)
-            {
-                logic[i] = t0 > number[i];
-            }
-        }
-
-        else if (expression[i].find("fTOT") != std::string::npos)
-        { // cut on fTOT
-            if (expression[i].find("<") != std::string::npos) { logic[i] = tot < number[i]; }
-            else if (expression[i].find(">") != std::string::npos)
-            {
-                logic[i] = tot > number[i];
-            }
-        }
-
-        else if (SDDflag && expression[i].find("fBL") != std::string::npos)
-        { // cut on fBL
-            if (expression[i].find("<") != std::string::npos) { logic[i] = bl < number[i]; }
-            else if (expression[i].find(">") != std::string::npos)
-            {
-                logic[i] = bl > number[i];
-            }
-        }
-
-        else if (SDDflag && expression[i].find("fBL_sigma") != std::string::npos)
-        { // cut on fBL_sigma
-            if (expression[i].find("<") != std::string::npos) { logic[i] = blsig < number[i]; }
-            else if (expression[i].find(">") != std::string::npos)
-            {
-                logic[i] = blsig > number[i];
-            }
-        }
-
-        else if (SDDflag && expression[i].find("fPileUp") != std::string::npos)
-        { // cut on fPileUp
-            if (expression[i].find("==") != std::string::npos) { logic[i] = pileup == number[i]; }
-        }
-
-        else if (SDDflag && expression[i].find("fVeto") != std::string::npos)
-        { // cut on fVeto
-            if (expression[i].find("==") != std::string::npos) { logic[i] = veto == number[i]; }
-        }
+        if (gSystem->AccessPathName(path) && alternative != "")
+            path = directory + "/" + alternative;
 
-        else
-        {
-            std::cerr << "#### Error in SFData::InterpretCut! Incorrect cut syntax!" << std::endl;
-            std::cerr << "Incorrect type. Available types are: fAmp, fCharge, fPE, fT0, fTOT, fBL, "
-                         "fBL_sigma, fPileUp and fVeto."
-                      << std::endl;
-            return false;
-        }
+        SFPrefetcher::Schedule(path);
     }
-
-    result = logic[0] && logic[1];
-
-    return result;
 }
 //------------------------------------------------------------------
 /// Accesses ROOT file and returns tree containing registered data for
-/// the requested measurement.
+/// the requested measurement. If list of branches is given, only these
+/// fields of the stored objects are read (see SFTools::SelectBranches()).
 /// \param ID - measurement ID
-SLoop* SFData::GetTree(int ID)
+/// \param branches - full names of the branches to be read, e.g.
+/// "SDDSamples.data.signal_l.fPE"; all branches are read if empty
+SLoop* SFData::GetTree(int ID, const std::vector<TString>& branches)
 {
 
     int         index = SFTools::GetIndex(fMeasureID, ID);
-    std::string fname = std::string(SFTools::FindData(fNames[index])) + "/sifi_results.root";
+    std::string fname = std::string(fFiles[index]);
+
+    // SLoop opens the file by itself
+    SFFilePool::Evict(fFiles[index]);
 
     SLoop* loop = new SLoop();
     loop->addFile(fname);
@@ -499,9 +487,90 @@ SLoop* SFData::GetTree(int ID)
         std::abort();
     }
 
+    if (!branches.empty() && !SFTools::SelectBranches(loop->getChain(), branches))
+    {
+        std::cout << "##### Warning in SFData::GetTree()! Reading all branches of "
+                  << fname << std::endl;
+    }
+
     return loop;
 }
 //------------------------------------------------------------------
+/// Returns columnar event cache of the requested measurement (see
+/// SFEventCache). The cache is created at the first call and owned
+/// by this SFData object.
+/// \param ID - measurement ID
+SFEventCache* SFData::GetEventCache(int ID)
+{
+    auto it = fEventCache.find(ID);
+    if (it != fEventCache.end()) return it->second;
+
+    int           index = SFTools::GetIndex(fMeasureID, ID);
+    SFEventCache* cache = nullptr;
+
+    try
+    {
+        cache = new SFEventCache(SFTools::FindData(fNames[index]));
+    }
+    catch (const char* message)
+    {
+        std::cerr << message << std::endl;
+        std::cerr << "##### Error in SFData::GetEventCache()! Cannot create event cache!"
+                  << std::endl;
+        std::abort();
+    }
+
+    fEventCache[ID] = cache;
+
+    // event caches of the next measurements are built from the ROOT files
+    // only if the cache files don't exist yet
+    Prefetch(index, "sifi_cache.bin", "sifi_results.root");
+
+    return cache;
+}
+//------------------------------------------------------------------
+/// Returns key of the histogram in SFHistCache. Selection should be created
+/// with 0 as unique flag, so that it is the same for all calls.
+/// \param selection - selection of the histogram (see SFDrawCommands)
+/// \param cut - logic cut for drawn events
+static TString CacheKey(TString selection, TString cut)
+{
+    return selection + "|" + cut.Strip(TString::kBoth);
+}
+//------------------------------------------------------------------
+/// Returns reader of the data of the requested measurement recorded with
+/// the Aachen test bench (see SFAachenReader). The reader is created at
+/// the first call and owned by this SFData object, so that the files of
+/// the measurement are opened only once.
+/// \param ID - measurement ID
+SFAachenReader* SFData::GetAachenReader(int ID)
+{
+    auto it = fAachenReaders.find(ID);
+    if (it != fAachenReaders.end()) return it->second;
+
+    int             index  = SFTools::GetIndex(fMeasureID, ID);
+    SFAachenReader* reader = nullptr;
+
+    try
+    {
+        reader = new SFAachenReader(SFTools::FindData(fNames[index]));
+    }
+    catch (const char* message)
+    {
+        std::cerr << message << std::endl;
+        std::cerr << "##### Error in SFData::GetAachenReader()! Cannot open measurement!"
+                  << std::endl;
+        std::abort();
+    }
+
+    fAachenReaders[ID] = reader;
+
+    Prefetch(index, "results.root");
+    Prefetch(index, "waves.root");
+
+    return reader;
+}
+//------------------------------------------------------------------
 /// Returns single spectrum of requested type.
 /// \param ch - chennel number
 /// \param sel_type - type of the spectrum, as defined in SFDrawCommands class
@@ -513,26 +582,22 @@ SLoop* SFData::GetTree(int ID)
 TH1D* SFData::GetSpectrum(int ch, SFSelectionType sel_type, TString cut, int ID)
 {
 
-    int    index    = SFTools::GetIndex(fMeasureID, ID);
-    double position = fPositions[index];
-    // TString fname = SFTools::FindData(fNames[index]);
-    // TFile *file = new TFile(fname+"/sifi_results.root", "READ");
-    TFile*  file  = fFiles[index];
-    TString tname = std::string("S");
-    TTree*  tree  = (TTree*)file->Get(tname);
-
-    gUnique += 1;
-    TString selection = SFDrawCommands::GetSelection(sel_type, gUnique, ch);
-
-    tree->Draw(selection, cut);
-    TH1D*   spec  = (TH1D*)gDirectory->FindObjectAny(Form("htemp%i", gUnique));
-    TString hname = Form("S%i_ch%i_pos%.1f_ID%i_", fSeriesNo, ch, position, ID) +
-                    SFDrawCommands::GetSelectionName(sel_type);
-    TString htitle = hname + " " + cut;
-    spec->SetName(hname);
-    spec->SetTitle(htitle);
+    std::vector<SFHistRequest> requests(1);
+    requests[0].fCh      = ch;
+    requests[0].fSelType = sel_type;
+    requests[0].fCut     = cut;
+    requests[0].fChName  = true;
+    requests[0].fCorr    = false;
+
+    int index = SFTools::GetIndex(fMeasureID, ID);
+
+    if (!FillRequests(requests, index))
+    {
+        std::cerr << "##### Error in SFData::GetSpectrum()!" << std::endl;
+        std::abort();
+    }
 
-    return spec;
+    return (TH1D*)requests[0].fHists[index];
 }
 //------------------------------------------------------------------
 /// Returns a vector with all spectra of requested type.
@@ -544,12 +609,23 @@ TH1D* SFData::GetSpectrum(int ch, SFSelectionType sel_type, TString cut, int ID)
 std::vector<TH1D*> SFData::GetSpectra(int ch, SFSelectionType sel_type, TString cut)
 {
 
-    std::vector<TH1D*> spectra;
-    for (int i = 0; i < fNpoints; i++)
+    std::vector<SFHistRequest> requests(1);
+    requests[0].fCh      = ch;
+    requests[0].fSelType = sel_type;
+    requests[0].fCut     = cut;
+    requests[0].fChName  = true;
+    requests[0].fCorr    = false;
+
+    if (!FillRequests(requests))
     {
-        spectra.push_back(GetSpectrum(ch, sel_type, cut, fMeasureID[i]));
+        std::cerr << "##### Error in SFData::GetSpectra()!" << std::endl;
+        std::abort();
     }
 
+    std::vector<TH1D*> spectra;
+    for (auto h : requests[0].fHists)
+        spectra.push_back((TH1D*)h);
+
     return spectra;
 }
 //------------------------------------------------------------------
@@ -563,26 +639,23 @@ TH1D* SFData::GetCustomHistogram(SFSelectionType sel_type, TString cut, int ID,
                                  std::vector<double> customNumbers)
 {
 
-    int    index    = SFTools::GetIndex(fMeasureID, ID);
-    double position = fPositions[index];
-    // TString fname = SFTools::FindData(fNames[index]);
-    // TFile *file = new TFile(fname+"/sifi_results.root", "READ");
-    TFile*  file  = fFiles[index];
-    TString tname = "S";
-    TTree*  tree  = (TTree*)file->Get(tname);
-
-    gUnique += 1;
-    TString selection;
-    selection = SFDrawCommands::GetSelection(sel_type, gUnique, customNumbers);
-    tree->Draw(selection, cut);
-    TH1D*   hist  = (TH1D*)gDirectory->FindObjectAny(Form("htemp%i", gUnique));
-    TString hname = Form("S%i_pos%.1f_ID%i_", fSeriesNo, position, ID) +
-                    SFDrawCommands::GetSelectionName(sel_type);
-    TString htitle = hname + " " + cut;
-    hist->SetName(hname);
-    hist->SetTitle(htitle);
+    std::vector<SFHistRequest> requests(1);
+    requests[0].fCh        = -1;
+    requests[0].fSelType   = sel_type;
+    requests[0].fCut       = cut;
+    requests[0].fCustomNum = customNumbers;
+    requests[0].fChName    = false;
+    requests[0].fCorr      = false;
+
+    int index = SFTools::GetIndex(fMeasureID, ID);
 
-    return hist;
+    if (!FillRequests(requests, index))
+    {
+        std::cerr << "##### Error in SFData::GetCustomHistogram()!" << std::endl;
+        std::abort();
+    }
+
+    return (TH1D*)requests[0].fHists[index];
 }
 //------------------------------------------------------------------
 /// Returns a vector of requested custom 1D histograms for all measurements in this series.
@@ -592,12 +665,23 @@ TH1D* SFData::GetCustomHistogram(SFSelectionType sel_type, TString cut, int ID,
 std::vector<TH1D*> SFData::GetCustomHistograms(SFSelectionType sel_type, TString cut)
 {
 
-    std::vector<TH1D*> hists;
-    for (int i = 0; i < fNpoints; i++)
+    std::vector<SFHistRequest> requests(1);
+    requests[0].fCh      = -1;
+    requests[0].fSelType = sel_type;
+    requests[0].fCut     = cut;
+    requests[0].fChName  = false;
+    requests[0].fCorr    = false;
+
+    if (!FillRequests(requests))
     {
-        hists.push_back(GetCustomHistogram(sel_type, cut, fMeasureID[i]));
+        std::cerr << "##### Error in SFData::GetCustomHistograms()!" << std::endl;
+        std::abort();
     }
 
+    std::vector<TH1D*> hists;
+    for (auto h : requests[0].fHists)
+        hists.push_back((TH1D*)h);
+
     return hists;
 }
 //------------------------------------------------------------------
@@ -612,31 +696,23 @@ TH1D* SFData::GetCustomHistogram(int ch, SFSelectionType sel_type, TString cut,
                                  std::vector<double> customNumbers)
 {
 
-    int    index    = SFTools::GetIndex(fMeasureID, ID);
-    double position = fPositions[index];
-    // TString fname = SFTools::FindData(fNames[index]);
-    // TFile *file = new TFile(fname+"/sifi_results.root", "READ");
-    TFile*  file  = fFiles[index];
-    TString tname = "S";
-    TTree*  tree  = (TTree*)file->Get(tname);
-
-    gUnique += 1;
+    std::vector<SFHistRequest> requests(1);
+    requests[0].fCh        = ch;
+    requests[0].fSelType   = sel_type;
+    requests[0].fCut       = cut;
+    requests[0].fCustomNum = customNumbers;
+    requests[0].fChName    = false;
+    requests[0].fCorr      = false;
 
-    TString selection;
-    if (customNumbers.empty())
-        selection = SFDrawCommands::GetSelection(sel_type, gUnique, ch);
-    else
-        selection = SFDrawCommands::GetSelection(sel_type, gUnique, ch, customNumbers);
+    int index = SFTools::GetIndex(fMeasureID, ID);
 
-    tree->Draw(selection, cut);
-    TH1D*   hist  = (TH1D*)gDirectory->FindObjectAny(Form("htemp%i", gUnique));
-    TString hname = Form("S%i_pos%.1f_ID%i_", fSeriesNo, position, ID) +
-                    SFDrawCommands::GetSelectionName(sel_type);
-    TString htitle = hname + " " + cut;
-    hist->SetName(hname);
-    hist->SetTitle(htitle);
+    if (!FillRequests(requests, index))
+    {
+        std::cerr << "##### Error in SFData::GetCustomHistogram()!" << std::endl;
+        std::abort();
+    }
 
-    return hist;
+    return (TH1D*)requests[0].fHists[index];
 }
 //------------------------------------------------------------------
 /// Returns single requested 2D correlation histogram.
@@ -644,34 +720,25 @@ TH1D* SFData::GetCustomHistogram(int ch, SFSelectionType sel_type, TString cut,
 /// \param cut - cut for drawn events. Also TTree-style syntax
 /// \param ID - ID of requested measurement
 /// \param ch - channel number
-TH2D* SFData::GetCorrHistogram(SFSelectionType sel_type, TString cut, int ID, int ch)
+SFCorrHist* SFData::GetCorrHistogram(SFSelectionType sel_type, TString cut, int ID, int ch)
 {
 
-    int    index    = SFTools::GetIndex(fMeasureID, ID);
-    double position = fPositions[index];
-    // TString fname = SFTools::FindData(fNames[index]);
-    // TFile *file = new TFile(fname+"/sifi_results.root", "READ");
-    TFile*  file  = fFiles[index];
-    TString tname = std::string("S");
-    TTree*  tree  = (TTree*)file->Get(tname);
-
-    gUnique += 1;
+    std::vector<SFHistRequest> requests(1);
+    requests[0].fCh      = ch;
+    requests[0].fSelType = sel_type;
+    requests[0].fCut     = cut;
+    requests[0].fChName  = false;
+    requests[0].fCorr    = true;
 
-    TString selection;
-    if (ch == -1)
-        selection = SFDrawCommands::GetSelection(sel_type, gUnique);
-    else
-        selection = SFDrawCommands::GetSelection(sel_type, gUnique, ch);
+    int index = SFTools::GetIndex(fMeasureID, ID);
 
-    tree->Draw(selection, cut, "colz");
-    TH2D*   hist  = (TH2D*)gDirectory->FindObjectAny(Form("htemp%.i", gUnique));
-    TString hname = Form("S%i_pos%.1f_ID%i_", fSeriesNo, position, ID) +
-                    SFDrawCommands::GetSelectionName(sel_type);
-    TString htitle = hname + " " + cut;
-    hist->SetName(hname);
-    hist->SetTitle(htitle);
+    if (!FillRequests(requests, index))
+    {
+        std::cerr << "##### Error in SFData::GetCorrHistogram()!" << std::endl;
+        std::abort();
+    }
 
-    return hist;
+    return (SFCorrHist*)requests[0].fHists[index];
 }
 //------------------------------------------------------------------
 /// Returns a vector of requested 2D correlation histograms for all measurements in
@@ -679,15 +746,27 @@ TH2D* SFData::GetCorrHistogram(SFSelectionType sel_type, TString cut, int ID, in
 /// \param sel_type - predefined selection type (see SFDrawCommands)
 /// \param cut - cut for drawn events. Also TTree-style syntax
 /// \param ch - channel number
-std::vector<TH2D*> SFData::GetCorrHistograms(SFSelectionType sel_type, TString cut, int ch)
+std::vector<SFCorrHist*> SFData::GetCorrHistograms(SFSelectionType sel_type, TString cut,
+                                                   int ch)
 {
 
-    std::vector<TH2D*> hists;
-    for (int i = 0; i < fNpoints; i++)
+    std::vector<SFHistRequest> requests(1);
+    requests[0].fCh      = ch;
+    requests[0].fSelType = sel_type;
+    requests[0].fCut     = cut;
+    requests[0].fChName  = false;
+    requests[0].fCorr    = true;
+
+    if (!FillRequests(requests))
     {
-        hists.push_back(GetCorrHistogram(sel_type, cut, fMeasureID[i], ch));
+        std::cerr << "##### Error in SFData::GetCorrHistograms()!" << std::endl;
+        std::abort();
     }
 
+    std::vector<SFCorrHist*> hists;
+    for (auto h : requests[0].fHists)
+        hists.push_back((SFCorrHist*)h);
+
     return hists;
 }
 //------------------------------------------------------------------
@@ -695,127 +774,446 @@ std::vector<TH2D*> SFData::GetCorrHistograms(SFSelectionType sel_type, TString c
 /// the reference detector.
 /// \param ID - measurement ID
 /// \param ch - channel number
-TH2D* SFData::GetRefCorrHistogram(int ID, int ch)
+SFCorrHist* SFData::GetRefCorrHistogram(int ID, int ch)
 {
 
     const double BL_sigma_cut = SFTools::GetSigmaBL(fSiPM);
     
-    int         index    = SFTools::GetIndex(fMeasureID, ID);
-    double      position = fPositions[index];
-    std::string fname    = std::string(SFTools::FindData(fNames[index])) + "/sifi_results.root";
-
-    TString hname = Form("S%i_pos%.1f_ID%i_PE%ivsPE2Correlation", fSeriesNo, position, ID, ch);
-    TH2D*   htemp = new TH2D(hname, hname, 1000, -100, 15E4, 2200, -150, 1500);
-
-    SLoop loop;
-    loop.addFile(fname);
-    loop.setInput({});
-    SCategory* tSig = SCategoryManager::getCategory(SCategory::CatDDSamples);
-
-    int n = loop.getEntries();
+    int    index    = SFTools::GetIndex(fMeasureID, ID);
+    double position = fPositions[index];
 
-    for (int i = 0; i < n; ++i)
+    TString     hname = Form("S%i_pos%.1f_ID%i_PE%ivsPE2Correlation", fSeriesNo, position, ID, ch);
+    SFCorrHist* htemp = new SFCorrHist(hname, hname, 1000, -100, 15E4, 2200, -150, 1500);
+
+    if (ch != 0 && ch != 1) return htemp;
+
+    SFEventCache* cache = GetEventCache(ID);
+
+    const int*   event  = cache->GetInt(SFCacheCol::kEvent);
+    const int*   module = cache->GetInt(SFCacheCol::kModule);
+    const float* PE[2]  = {cache->GetFloat(SFCacheCol::kPE, 0),
+                           cache->GetFloat(SFCacheCol::kPE, 1)};
+    const float* T0[2]  = {cache->GetFloat(SFCacheCol::kT0, 0),
+                           cache->GetFloat(SFCacheCol::kT0, 1)};
+    const float* TOT[2] = {cache->GetFloat(SFCacheCol::kTOT, 0),
+                           cache->GetFloat(SFCacheCol::kTOT, 1)};
+    const float* amp[2] = {cache->GetFloat(SFCacheCol::kAmp, 0),
+                           cache->GetFloat(SFCacheCol::kAmp, 1)};
+    const float* BLs[2] = {cache->GetFloat(SFCacheCol::kBLSigma, 0),
+                           cache->GetFloat(SFCacheCol::kBLSigma, 1)};
+
+    auto isValid = [&](Long64_t row, int side) {
+        return T0[side][row] > 0 && PE[side][row] > 0 && TOT[side][row] > 0 &&
+               amp[side][row] < ampMax && BLs[side][row] < BL_sigma_cut;
+    };
+
+    Long64_t nrows   = cache->GetNrows();
+    int      current = -1;
+    uint     coinc   = 0;
+    double   mod0PE  = 0.;
+    double   mod1PE  = 0.;
+
+    for (Long64_t i = 0; i < nrows; ++i)
     {
+        // rows are ordered by event, coincidence is searched within single event
+        if (event[i] != current)
+        {
+            current = event[i];
+            coinc   = 0;
+        }
 
-        loop.nextEvent();
-        size_t tentries = tSig->getEntries();
-
-        uint coinc = 0;
-
-        for (int j = 0; j < tentries; ++j)
+        if (module[i] == 0 && isValid(i, 0) && isValid(i, 1))
         {
+            mod0PE = PE[ch][i];
+            coinc |= 0x1;
+        }
+        else if (module[i] == 1 && isValid(i, 0))
+        {
+            mod1PE = PE[0][i];
+            coinc |= 0x2;
+        }
 
-            int              m, l, f;
-            double           mod0PE, mod1PE;
-            SDDSamples*      samples = (SDDSamples*)tSig->getObject(j);
-            samples->getAddress(m, l, f);
+        if (coinc == 0x3) htemp->Fill(mod1PE, mod0PE);
+    }
 
-            if (ch == 0)
-            {
-                if (m == 0 && 
-                    samples->getSignalL()->GetT0() > 0 && 
-                    samples->getSignalL()->GetPE() > 0 &&
-                    samples->getSignalL()->GetTOT() > 0 &&
-                    samples->getSignalL()->GetAmplitude() < ampMax &&
-                    samples->getSignalL()->GetBLSigma() < BL_sigma_cut &&
-                    samples->getSignalR()->GetT0() > 0 &&
-                    samples->getSignalR()->GetPE() > 0 &&
-                    samples->getSignalR()->GetTOT() > 0 &&
-                    samples->getSignalR()->GetAmplitude() < ampMax &&
-                    samples->getSignalR()->GetBLSigma() < BL_sigma_cut)
-                {
-                    mod0PE = samples->getSignalL()->GetPE();
-                    coinc |= 0x1;
-                }
-                else if (m == 1 &&
-                         samples->getSignalL()->GetT0() > 0 &&
-                         samples->getSignalL()->GetPE() > 0 &&
-                         samples->getSignalL()->GetTOT() > 0 &&
-                         samples->getSignalL()->GetAmplitude() < ampMax &&
-                         samples->getSignalL()->GetBLSigma() < BL_sigma_cut)
-                {
-                    mod1PE = samples->getSignalL()->GetPE();
-                    coinc |= 0x2;
+    return htemp;
+}
+//------------------------------------------------------------------
+/// Creates histograms of charge correlation between the chosen channel
+/// the reference detector for all measurements in the experimental series.
+/// Histograms are returned in the std::vector.
+/// \param ch - channel number
+std::vector<SFCorrHist*> SFData::GetRefCorrHistograms(int ch)
+{
+
+    std::vector<SFCorrHist*> hists;
+
+    for (int i = 0; i < fNpoints; i++)
+    {
+        hists.push_back(GetRefCorrHistogram(fMeasureID[i], ch));
+    }
+
+    return hists;
+}
+//------------------------------------------------------------------
+/// Books spectra of requested type for all measurements in this series.
+/// Booked spectra are filled in a single pass over the data with
+/// FillBookedHistograms() and accessed with GetBookedHistograms().
+/// Returns ID of the request.
+/// \param ch - channel number
+/// \param sel_type - type of spectra (see SFDrawCommands)
+/// \param cut - logic cut for drawn events (syntax like for Draw() method of TTree)
+int SFData::BookSpectra(int ch, SFSelectionType sel_type, TString cut)
+{
+
+    SFHistRequest request;
+    request.fCh      = ch;
+    request.fSelType = sel_type;
+    request.fCut     = cut;
+    request.fChName  = true;
+    request.fCorr    = false;
+
+    fRequests.push_back(request);
+
+    return fRequests.size() - 1;
+}
+//------------------------------------------------------------------
+/// Books custom 1D histograms of requested type for all measurements in
+/// this series. See BookSpectra() for details. Returns ID of the request.
+/// \param sel_type - predefined selection type (see SFDrawCommands)
+/// \param cut - cut for drawn events. Also TTree-style syntax
+/// \param customNum - vector containing set of numbers necessary for
+/// the selection of events to be drawn on the histogram
+int SFData::BookCustomHistograms(SFSelectionType sel_type, TString cut,
+                                 std::vector<double> customNum)
+{
+
+    SFHistRequest request;
+    request.fCh        = -1;
+    request.fSelType   = sel_type;
+    request.fCut       = cut;
+    request.fCustomNum = customNum;
+    request.fChName    = false;
+    request.fCorr      = false;
+
+    fRequests.push_back(request);
+
+    return fRequests.size() - 1;
+}
+//------------------------------------------------------------------
+/// Books 2D correlation histograms of requested type for all measurements
+/// in this series. Booked histograms are accessed with GetBookedCorrHistograms().
+/// See BookSpectra() for details. Returns ID of the request.
+/// \param sel_type - predefined selection type (see SFDrawCommands)
+/// \param cut - cut for drawn events. Also TTree-style syntax
+/// \param ch - channel number
+int SFData::BookCorrHistograms(SFSelectionType sel_type, TString cut, int ch)
+{
+
+    SFHistRequest request;
+    request.fCh      = ch;
+    request.fSelType = sel_type;
+    request.fCut     = cut;
+    request.fChName  = false;
+    request.fCorr    = true;
+
+    fRequests.push_back(request);
+
+    return fRequests.size() - 1;
+}
+//------------------------------------------------------------------
+/// Fills all booked histograms. Each ROOT file of the series is read only
+/// once and all booked selections and cuts are evaluated for every event.
+/// Histograms are identical to the ones returned by GetSpectra(),
+/// GetCustomHistograms() and GetCorrHistograms().
+bool SFData::FillBookedHistograms(void)
+{
+
+    if (fRequests.empty())
+    {
+        std::cout << "##### Warning in SFData::FillBookedHistograms()!" << std::endl;
+        std::cout << "No histograms were booked!" << std::endl;
+        return false;
+    }
+
+    return FillRequests(fRequests);
+}
+//------------------------------------------------------------------
+/// This private function creates and fills histograms of given requests
+/// for all measurements in this series, or for the single requested one.
+/// Histograms are created sequentially in the calling thread, with binning
+/// taken from SFDrawCommands, and filled explicitly, so that they are owned
+/// by the caller without any lookup in the current directory. Histograms
+/// found in SFHistCache are taken from there, measurements whose histograms
+/// are all cached are not read at all. Afterwards measurements are processed concurrently
+/// with SFTools::ParallelFor(), each measurement (ROOT file) by a single
+/// thread, which fills only histograms of this measurement.
+/// \param requests - vector of requests to be filled
+/// \param index - index of the measurement to be filled, -1 for all measurements.
+/// Histograms of other measurements are set to nullptr.
+bool SFData::FillRequests(std::vector<SFHistRequest>& requests, int index)
+{
+
+    const int nrequests = requests.size();
+
+    std::vector<int> points;
+
+    if (index == -1)
+    {
+        for (int i = 0; i < fNpoints; i++)
+            points.push_back(i);
+    }
+    else
+    {
+        points.push_back(index);
+    }
+
+    std::vector<std::vector<TString>> expressions(nrequests);
+    std::vector<TString>              keys(nrequests);
+    std::vector<std::vector<int>>     pending(fNpoints); // requests not found in SFHistCache
+
+    //----- booking histograms
+    for (int r = 0; r < nrequests; r++)
+    {
+        SFHistRequest& request = requests[r];
+
+        TString selection;
+        if (request.fCh == -1)
+            selection = SFDrawCommands::GetSelection(request.fSelType, 0, request.fCustomNum);
+        else
+            selection = SFDrawCommands::GetSelection(request.fSelType, 0, request.fCh,
+                                                     request.fCustomNum);
+
+        std::vector<double> binning;
+
+        if (!SFDrawCommands::ParseSelection(selection, expressions[r], binning) ||
+            (request.fCorr && expressions[r].size() != 2) ||
+            (!request.fCorr && expressions[r].size() != 1))
+        {
+            std::cerr << "##### Error in SFData::FillRequests()!" << std::endl;
+            std::cerr << "Incorrect selection for the request " << r << std::endl;
+            std::abort();
+        }
+
+        keys[r] = CacheKey(selection, request.fCut);
+        request.fHists.assign(fNpoints, nullptr);
+
+        for (auto i : points)
+        {
+            TString hname;
+            if (request.fChName)
+                hname = Form("S%i_ch%i_pos%.1f_ID%i_", fSeriesNo, request.fCh, fPositions[i],
+                             fMeasureID[i]);
+            else
+                hname = Form("S%i_pos%.1f_ID%i_", fSeriesNo, fPositions[i], fMeasureID[i]);
+
+            hname += SFDrawCommands::GetSelectionName(request.fSelType);
+            TString htitle = hname + " " + request.fCut;
+
+            TObject* cached = SFHistCache::Get(fFiles[i], keys[r]);
+
+            if (cached != nullptr &&
+                cached->InheritsFrom(request.fCorr ? SFCorrHist::Class() : TH1D::Class()))
+            {
+                request.fHists[i] = (TNamed*)cached;
+                request.fHists[i]->SetName(hname);
+                request.fHists[i]->SetTitle(htitle);
+                continue;
+            }
+
+            delete cached;
+
+            pending[i].push_back(r);
+
+            if (request.fCorr)
+                request.fHists[i] = new SFCorrHist(hname, htitle, binning[0], binning[1],
+                                                   binning[2], binning[3], binning[4], binning[5]);
+            else
+                request.fHists[i] = new TH1D(hname, htitle, binning[0], binning[1], binning[2]);
+        }
+    }
+
+    //----- filling histograms, measurement by measurement
+    std::vector<int> status(fNpoints, 1);
+
+    SFTools::ParallelFor(points.size(), [&](int p) {
+        int i = points[p];
+        if (pending[i].empty()) return;
+
+        TFile* file = AcquireFile(i);
+        TTree* tree = (TTree*)file->Get("S");
+
+        if (tree == nullptr)
+        {
+            std::cerr << "##### Error in SFData::FillRequests()!" << std::endl;
+            std::cerr << "Could not access tree for measurement " << fNames[i] << std::endl;
+            SFFilePool::Release(file);
+            status[i] = 0;
+            return;
+        }
+
+        std::vector<std::vector<TTreeFormula*>> vars(nrequests);
+        std::vector<TTreeFormula*>              cuts(nrequests, nullptr);
+        std::vector<TTreeFormulaManager*>       managers(nrequests, nullptr);
+
+        //----- compiling formulas
+        for (auto r : pending[i])
+        {
+            managers[r] = new TTreeFormulaManager();
+
+            for (size_t e = 0; e < expressions[r].size(); e++)
+            {
+                TTreeFormula* var =
+                    new TTreeFormula(Form("var%i_%i", r, (int)e), expressions[r][e], tree);
+                vars[r].push_back(var);
+                managers[r]->Add(var);
+
+                if (var->GetNdim() == 0)
+                {
+                    std::cerr << "##### Error in SFData::FillRequests()!" << std::endl;
+                    std::cerr << "Could not compile expression: " << expressions[r][e]
+                              << std::endl;
+                    std::abort();
                 }
-                if (coinc == 0x3) htemp->Fill(mod1PE, mod0PE);
             }
-            else if (ch == 1)
+
+            TString cut = requests[r].fCut;
+            cut         = cut.Strip(TString::kBoth);
+
+            if (!cut.IsNull())
             {
-                if (m == 0 &&
-                    samples->getSignalL()->GetT0() > 0 &&
-                    samples->getSignalL()->GetPE() > 0 &&
-                    samples->getSignalL()->GetTOT() > 0 &&
-                    samples->getSignalL()->GetAmplitude() < ampMax &&
-                    samples->getSignalL()->GetBLSigma() < BL_sigma_cut &&
-                    samples->getSignalR()->GetT0() > 0 &&
-                    samples->getSignalR()->GetPE() > 0 &&
-                    samples->getSignalR()->GetTOT() > 0 &&
-                    samples->getSignalR()->GetAmplitude() < ampMax &&
-                    samples->getSignalR()->GetBLSigma() < BL_sigma_cut)
+                cuts[r] = new TTreeFormula(Form("cut%i", r), cut, tree);
+                managers[r]->Add(cuts[r]);
+
+                if (cuts[r]->GetNdim() == 0)
                 {
-                    mod0PE = samples->getSignalR()->GetPE();
-                    coinc |= 0x1;
+                    std::cerr << "##### Error in SFData::FillRequests()!" << std::endl;
+                    std::cerr << "Could not compile cut: " << cut << std::endl;
+                    std::abort();
                 }
-                else if (m == 1 &&
-                         samples->getSignalL()->GetT0() > 0 &&
-                         samples->getSignalL()->GetPE() > 0 &&
-                         samples->getSignalL()->GetTOT() > 0 &&
-                         samples->getSignalL()->GetAmplitude() < ampMax &&
-                         samples->getSignalL()->GetBLSigma() < BL_sigma_cut)
+            }
+
+            managers[r]->Sync();
+        }
+
+        //----- single event loop
+        Long64_t nentries = tree->GetEntries();
+
+        for (Long64_t entry = 0; entry < nentries; entry++)
+        {
+            tree->LoadTree(entry);
+
+            for (auto r : pending[i])
+            {
+                int ndata = managers[r]->GetNdata();
+
+                for (int k = 0; k < ndata; k++)
                 {
-                    mod1PE = samples->getSignalL()->GetPE();
-                    coinc |= 0x2;
+                    // expression is evaluated before checking the cut to ensure
+                    // loading of all branches
+                    double weight = cuts[r] == nullptr ? 1. : cuts[r]->EvalInstance(k);
+                    double y      = vars[r][0]->EvalInstance(k);
+
+                    if (weight == 0) continue;
+
+                    if (requests[r].fCorr)
+                    {
+                        double x = vars[r][1]->EvalInstance(k);
+                        ((SFCorrHist*)requests[r].fHists[i])->Fill(x, y, weight);
+                    }
+                    else
+                    {
+                        ((TH1D*)requests[r].fHists[i])->Fill(y, weight);
+                    }
                 }
-                if (coinc == 0x3) htemp->Fill(mod1PE, mod0PE);
             }
         }
+
+        // deleting formulas deletes also their managers
+        for (auto r : pending[i])
+        {
+            for (auto var : vars[r])
+                delete var;
+            delete cuts[r];
+        }
+
+        SFFilePool::Release(file);
+    });
+
+    for (auto st : status)
+    {
+        if (st == 0) return false;
     }
 
-    return htemp;
+    //----- storing new histograms in the cache
+    for (auto i : points)
+    {
+        for (auto r : pending[i])
+            SFHistCache::Put(fFiles[i], keys[r], requests[r].fHists[i]);
+    }
+
+    return true;
 }
 //------------------------------------------------------------------
-/// Creates histograms of charge correlation between the chosen channel
-/// the reference detector for all measurements in the experimental series.
-/// Histograms are returned in the std::vector.
-/// \param ch - channel number
-std::vector<TH2D*> SFData::GetRefCorrHistograms(int ch)
+/// Returns a vector of booked 1D histograms (spectra or custom histograms)
+/// filled with FillBookedHistograms(). Ownership of the histograms is passed
+/// to the caller.
+/// \param request - request ID, as returned by BookSpectra() or BookCustomHistograms()
+std::vector<TH1D*> SFData::GetBookedHistograms(int request)
 {
 
-    std::vector<TH2D*> hists;
+    if (request < 0 || request >= (int)fRequests.size() || fRequests[request].fCorr ||
+        fRequests[request].fHists.empty())
+    {
+        std::cerr << "##### Error in SFData::GetBookedHistograms()!" << std::endl;
+        std::cerr << "Request " << request << " doesn't exist or was not filled!" << std::endl;
+        std::abort();
+    }
 
-    for (int i = 0; i < fNpoints; i++)
+    std::vector<TH1D*> hists;
+
+    for (auto h : fRequests[request].fHists)
+        hists.push_back((TH1D*)h);
+
+    return hists;
+}
+//------------------------------------------------------------------
+/// Returns a vector of booked 2D correlation histograms filled with
+/// FillBookedHistograms(). Ownership of the histograms is passed to the caller.
+/// \param request - request ID, as returned by BookCorrHistograms()
+std::vector<SFCorrHist*> SFData::GetBookedCorrHistograms(int request)
+{
+
+    if (request < 0 || request >= (int)fRequests.size() || !fRequests[request].fCorr ||
+        fRequests[request].fHists.empty())
     {
-        hists.push_back(GetRefCorrHistogram(fMeasureID[i], ch));
+        std::cerr << "##### Error in SFData::GetBookedCorrHistograms()!" << std::endl;
+        std::cerr << "Request " << request << " doesn't exist or was not filled!" << std::endl;
+        std::abort();
     }
 
+    std::vector<SFCorrHist*> hists;
+
+    for (auto h : fRequests[request].fHists)
+        hists.push_back((SFCorrHist*)h);
+
     return hists;
 }
 //------------------------------------------------------------------
+/// Removes all booked requests. Histograms which were already filled are
+/// not deleted.
+void SFData::ClearBookings(void)
+{
+
+    fRequests.clear();
+    return;
+}
+//------------------------------------------------------------------
 /// Returns averaged signal.
 /// \param ch - channel number
 /// \param ID - ID of requested measurement
 /// \param cut - logic cut to choose signals. Syntax of this cut is explained
-/// in InterpretCut() function
+/// in SFCut class
 /// \param number - number of signals to be averaged
 /// \param bl - flag for base line subtraction. If true - base line will be subtracted,
 /// if false - it won't
@@ -842,145 +1240,250 @@ TProfile* SFData::GetSignalAverage(int ch, int ID, TString cut, int number, bool
     return sig;
 }
 //------------------------------------------------------------------
+/// Returns averaged signals of the requested measurement. All requests
+/// are filled in a single scan of the measurement: events are selected
+/// once, for all requested channels and cuts, and each binary file is read
+/// only once. Averaged signals are set in the fSignal field of the requests.
+/// \param ID - ID of requested measurement
+/// \param requests - requested signals (see SFSignalRequest)
+///
+/// For the Aachen test bench signals are averaged one request after another.
+bool SFData::GetSignalAverages(int ID, std::vector<SFSignalRequest>& requests)
+{
+
+    if (fTestBench == "PL") { return GetSignalAveragesKrakow(ID, requests); }
+    else if (fTestBench == "DE")
+    {
+        for (auto& request : requests)
+            request.fSignal = GetSignalAverageAachen(request.fCh, ID, request.fCut,
+                                                     request.fNumber);
+    }
+    else
+    {
+        std::cerr << "##### Error in SFData::GetSignalAverages()!" << std::endl;
+        std::cerr << "Unknown data format!" << std::endl;
+        std::abort();
+    }
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Running average of signals. Mean and sum of squared deviations from
+/// the mean are updated for each sample with Welford's algorithm, which
+/// keeps single precision accumulators accurate. Used only in this file.
+namespace
+{
+struct SignalAverage
+{
+    std::vector<float> fMean;  ///< Mean value of each sample
+    std::vector<float> fM2;    ///< Sum of squared deviations of each sample
+    int                fN = 0; ///< Number of averaged signals
+
+    SignalAverage(int nsamples) : fMean(nsamples, 0.), fM2(nsamples, 0.) {}
+
+    /// Adds signal to the average.
+    /// \param wave - samples of the signal [ADC channels]
+    /// \param baseline - base line to be subtracted [ADC channels]
+    void Add(const float* wave, float baseline)
+    {
+        fN++;
+
+        int         nsamples = fMean.size();
+        const float scale    = 1. / gmV;
+
+        for (int ii = 0; ii < nsamples; ii++)
+        {
+            float y     = (wave[ii] - baseline) * scale;
+            float delta = y - fMean[ii];
+            fMean[ii] += delta / fN;
+            fM2[ii] += delta * (y - fMean[ii]);
+        }
+    }
+};
+} // namespace
+//------------------------------------------------------------------
+/// Fills empty profile histogram with averaged signal at once. Content
+/// of the profile is the same as if each sample of each signal was added
+/// with TProfile::Fill(ii, y), where ii = 1, 2, ..., nsamples.
+/// \param prof - empty profile histogram to be filled
+/// \param average - running average of the signals
+static void FillProfile(TProfile* prof, const SignalAverage& average)
+{
+    if (average.fN == 0) return;
+
+    TArrayD* binSumw2 = prof->GetBinSumw2();
+    int      nsamples = average.fMean.size();
+    int      nsig     = average.fN;
+
+    for (int ii = 0; ii < nsamples; ii++)
+    {
+        double mean = average.fMean[ii];
+        int    bin  = prof->GetXaxis()->FindBin(ii + 1);
+        prof->SetBinContent(bin, nsig * mean);
+        prof->SetBinEntries(bin, nsig);
+        prof->GetSumw2()->fArray[bin] = average.fM2[ii] + nsig * mean * mean;
+        if (binSumw2->fN > 0) binSumw2->fArray[bin] = nsig;
+    }
+
+    prof->ResetStats();
+    prof->SetEntries(nsamples * nsig);
+}
+//------------------------------------------------------------------
 /// This private function allows to access averaged signals recorded
 /// with the Krakow test bench. It opens binary file corresponding
 /// to the chosen measurement and channel. Based on the digitized data
-/// saved in the ROOT TTree it searches for signals which fulfil given cut
-/// and performs averaging using ROOT's TProfile object.
+/// stored in the event cache (see SFEventCache) it searches for signals
+/// which fulfil given cut and performs averaging using ROOT's TProfile object.
 /// \param ch - channel number
 /// \param ID - measuement ID
-/// \param cut - logic cut to choose signals (syntax explained in InterpretCutt()
+/// \param cut - logic cut to choose signals (syntax explained in SFCut class)
 /// \param number - number of signals to be averaged
 /// \param bl - flag for base line subtraction - if true baseline will be
 /// subtracted, if false - it will not.
 TProfile* SFData::GetSignalAverageKrakow(int ch, int ID, TString cut, int number, bool bl)
 {
 
-    int       index    = SFTools::GetIndex(fMeasureID, ID);
-    double    position = fPositions[index];
-    const int ipoints  = 1024;
-    float     x;
+    std::vector<SFSignalRequest> requests(1);
+    requests[0].fCh     = ch;
+    requests[0].fCut    = cut;
+    requests[0].fNumber = number;
+    requests[0].fBL     = bl;
+
+    GetSignalAveragesKrakow(ID, requests);
+
+    return requests[0].fSignal;
+}
+//------------------------------------------------------------------
+/// This private function averages signals recorded with the Krakow test
+/// bench for many requests at once. Event cache of the measurement (see
+/// SFEventCache) is scanned once and signals fulfilling cuts of the requests
+/// are read from binary files, one file per requested channel. First fNumber
+/// signals of each request are accumulated in single precision running averages
+/// (see SignalAverage) and converted to TProfile objects at the end. The scan
+/// stops as soon as all requests are complete.
+/// \param ID - measuement ID
+/// \param requests - requested signals (see SFSignalRequest)
+bool SFData::GetSignalAveragesKrakow(int ID, std::vector<SFSignalRequest>& requests)
+{
+
+    int       index     = SFTools::GetIndex(fMeasureID, ID);
+    double    position  = fPositions[index];
+    const int ipoints   = 1024;
+    int       nrequests = requests.size();
 
     double BL_sigma_cut = SFTools::GetSigmaBL(fSiPM);
 
-    std::string fname = std::string(SFTools::FindData(fNames[index]));
-    SLoop*      loop  = new SLoop();
-    loop->addFile(fname + "/sifi_results.root");
-    loop->setInput({});
-    SCategory* tSig = SCategoryManager::getCategory(SCategory::CatDDSamples);
+    std::string   fname = std::string(SFTools::FindData(fNames[index]));
+    SFEventCache* cache = GetEventCache(ID);
 
-    TString       iname = fname + Form("/wave_%i.dat", ch);
-    std::ifstream input(iname, std::ios::binary);
+    //----- opening binary files, one per channel
+    std::map<int, SFWaveformReader*> inputs;
 
-    if (!input.is_open())
+    for (auto& request : requests)
     {
-        std::cerr << "##### Error in SFData::GetSignalKraków()! Cannot open binary file!"
-                  << std::endl;
-        std::cerr << iname << std::endl;
-        std::abort();
+        if (inputs.find(request.fCh) != inputs.end()) continue;
+
+        TString iname = fname + Form("/wave_%i.dat", request.fCh);
+
+        try
+        {
+            inputs[request.fCh] = new SFWaveformReader(iname, ipoints);
+        }
+        catch (const char* message)
+        {
+            std::cerr << message << std::endl;
+            std::cerr << "##### Error in SFData::GetSignalKraków()! Cannot open binary file!"
+                      << std::endl;
+            std::cerr << iname << std::endl;
+            std::abort();
+        }
+
+        Prefetch(index, Form("wave_%i.dat", request.fCh));
     }
 
-    TString   hname  = "sig_profile";
-    TString   htitle = "sig_profile";
-    TProfile* psig   = new TProfile(hname, htitle, ipoints, 0, ipoints, "");
+    //----- compiling cuts
+    std::vector<SFCut> sigCuts(nrequests);
 
-    int   nloop     = loop->getEntries();
-    float baseline  = 0.;
-    int   counter   = 0;
-    int   infile    = 0;
-    bool  condition = true;
-    float firstT0   = 0.;
-    
-//     SDDSamples* samples = nullptr;
-//     SDDSignal*  sigL    = nullptr;
-//     SDDSignal*  sigR    = nullptr;
-    
-    TProfile*  hptr = nullptr;
-    SDDSignal* sptr = nullptr;
-    
-    for (int i = 0; i < nloop; ++i)
+    for (int r = 0; r < nrequests; r++)
     {
+        if (!sigCuts[r].SetCut(requests[r].fCut))
+        {
+            std::cerr << "##### Error in SFData::GetSignalAverageKrakow()!" << std::endl;
+            std::cerr << "Incorrect cut: " << requests[r].fCut << std::endl;
+            std::abort();
+        }
+    }
 
-        loop->getEvent(i);
-        size_t tentries = tSig->getEntries();
+    //----- single scan of the event cache
+    std::vector<SignalAverage> averages(nrequests, SignalAverage(ipoints));
+    std::vector<int>           counter(nrequests, 0);
+    std::vector<float>         firstT0(nrequests, 0.);
+    int                        ndone = 0;
 
-        for (int j = 0; j < tentries; ++j)
+    for (int r = 0; r < nrequests; r++)
+        if (requests[r].fNumber <= 0) ndone++;
+
+    Long64_t   nrows  = cache->GetNrows();
+    const int* event  = cache->GetInt(SFCacheCol::kEvent);
+    const int* module = cache->GetInt(SFCacheCol::kModule);
+
+    SFSignal sig;
+
+    for (Long64_t i = 0; i < nrows && ndone < nrequests; ++i)
+    {
+        for (int r = 0; r < nrequests; r++)
         {
-            int              m, l, f;
-            SDDSamples* samples = (SDDSamples*)tSig->getObject(j);
-            SDDSignal*  sigL    = (SDDSignal*)samples->getSignalL();
-            SDDSignal*  sigR    = (SDDSignal*)samples->getSignalR();
-            samples->getAddress(m, l, f);
+            if (counter[r] >= requests[r].fNumber) continue;
 
-            /*TProfile**/  hptr = psig;
-            /*SDDSignal**/ sptr = nullptr;
+            int side = cache->GetSide(i, requests[r].fCh);
+            if (side < 0) continue;
 
-            if (ch == 0 && m == 0)
-            {
-                sptr = sigL;
-            }
-            else if (ch == 1 && m == 0)
-            {
-                sptr = sigR;
-            }
-            else if (ch == 2 && m == 1)
-            {
-                sptr = sigL;
-            }
-            else
-            {
-                hptr = nullptr;
-            }
-            
-            if (hptr)
-            {
-                auto conv_sig = std::unique_ptr<SFSignal>(ConvertSignal(sptr));
-                condition = InterpretCut(conv_sig.get(), cut);
-                if (condition &&
-                    fabs(firstT0) < 1E-10 &&
-                    conv_sig->fBLsig < BL_sigma_cut)
-                    firstT0 = conv_sig->fT0;
-                if (condition &&
-                    fabs(conv_sig->fT0 - firstT0) < 1 &&
-                    conv_sig->fBLsig < BL_sigma_cut)
-                {
-                    infile = sizeof(x) * ipoints * i;
-                    if (bl) baseline = sptr->GetBL();
-                    input.seekg(infile);
-                    for (int ii = 1; ii < ipoints + 1; ii++)
-                    {
-                        input.read(reinterpret_cast<char*>(&x), sizeof(float));
-                        if (bl)
-                            hptr->Fill(ii, (x - baseline) / gmV);
-                        else
-                            hptr->Fill(ii, (x / gmV));
-                    }
-                    if (counter < number)
-                        counter++;
-                    else
-                        break;
-//                     delete conv_sig;
-                }
-            }
+            cache->GetSignal(i, side, sig);
+
+            if (!sigCuts[r].Evaluate(&sig, module[i]) || sig.fBLsig >= BL_sigma_cut) continue;
+            if (fabs(firstT0[r]) < 1E-10) firstT0[r] = sig.fT0;
+            if (fabs(sig.fT0 - firstT0[r]) >= 1) continue;
+
+            const float* wave = inputs[requests[r].fCh]->GetEvent(event[i]);
+            if (wave == nullptr) continue;
+
+            // first fNumber signals fulfilling the cut are averaged
+            averages[r].Add(wave, requests[r].fBL ? sig.fBL : 0.);
+            counter[r]++;
+
+            if (counter[r] == requests[r].fNumber) ndone++;
         }
     }
 
-    hname  = Form("S%i_ch%i_pos_%.1f_ID%i_sig_num_%i", fSeriesNo, ch, position, ID, counter);
-    htitle = hname + " " + cut;
-    psig->SetName(hname);
-    psig->SetTitle(htitle);
-
-    if (counter < number)
+    //----- converting averages to profiles
+    for (int r = 0; r < nrequests; r++)
     {
-        std::cout << "##### Warning in SFData::GetSignalAverage()! " << counter << " out of "
-                  << number << " plotted." << std::endl;
-        std::cout << "Position: " << position << "\t channel: " << ch << std::endl;
+        int     ch     = requests[r].fCh;
+        TString hname  = "sig_profile";
+        TString htitle = "sig_profile";
+
+        TProfile* psig = new TProfile(hname, htitle, ipoints, 0, ipoints, "");
+        FillProfile(psig, averages[r]);
+
+        hname  = Form("S%i_ch%i_pos_%.1f_ID%i_sig_num_%i", fSeriesNo, ch, position, ID, counter[r]);
+        htitle = hname + " " + requests[r].fCut;
+        psig->SetName(hname);
+        psig->SetTitle(htitle);
+
+        if (counter[r] < requests[r].fNumber)
+        {
+            std::cout << "##### Warning in SFData::GetSignalAverage()! " << counter[r]
+                      << " out of " << requests[r].fNumber << " plotted." << std::endl;
+            std::cout << "Position: " << position << "\t channel: " << ch << std::endl;
+        }
+
+        requests[r].fSignal = psig;
     }
 
-    delete loop;
-    input.close();
+    for (auto& input : inputs)
+        delete input.second;
 
-    return psig;
+    return true;
 }
 //------------------------------------------------------------------
 /// This private function allows to access averaged signals recorded
@@ -990,7 +1493,7 @@ TProfile* SFData::GetSignalAverageKrakow(int ch, int ID, TString cut, int number
 /// and performs averaging using ROOT's TProfile object.
 /// \param ch - channel number
 /// \param ID - measuement ID
-/// \param cut - logic cut to choose signals (syntax explained in InterpretCutt()
+/// \param cut - logic cut to choose signals (syntax explained in SFCut class)
 /// \param number - number of signals to be averaged.
 TProfile* SFData::GetSignalAverageAachen(int ch, int ID, TString cut, int number)
 {
@@ -999,37 +1502,45 @@ TProfile* SFData::GetSignalAverageAachen(int ch, int ID, TString cut, int number
     double    position = fPositions[index];
     const int ipoints  = 1024;
 
-    TString   fname = SFTools::FindData(fNames[index]);
-    TFile*    file  = new TFile(fname + "/results.root", "READ");
-    TTree*    tree  = (TTree*)file->Get("tree_ft");
-    DDSignal* sig   = new DDSignal();
-    tree->SetBranchAddress(Form("ch_%i", ch), &sig);
+    SFAachenReader* reader = GetAachenReader(ID);
+
+    if (!reader->SetChannel(ch))
+    {
+        std::cerr << "##### Error in SFData::GetSignalAverageAachen()!" << std::endl;
+        std::abort();
+    }
 
-    TString          iname = fname + "/waves.root";
-    TFile*           iFile = new TFile(iname, "READ");
-    TTree*           iTree = (TTree*)iFile->Get("wavetree");
-    TVectorT<float>* iVolt = new TVectorT<float>(ipoints);
-    TString          bname = Form("voltages_ch_%i", ch);
-    iTree->SetBranchAddress(bname, &iVolt);
+    SFCut sigCut;
+    if (!sigCut.SetCut(cut))
+    {
+        std::cerr << "##### Error in SFData::GetSignalAverageAachen()!" << std::endl;
+        std::cerr << "Incorrect cut: " << cut << std::endl;
+        std::abort();
+    }
 
     TString   hname  = "sig_profile";
     TString   htitle = "sig_profile";
     TProfile* psig   = new TProfile(hname, htitle, ipoints, 0, ipoints, "");
 
-    int    nentries  = tree->GetEntries();
-    int    counter   = 0;
-    bool   condition = true;
-    double firstT0   = 0.;
+    Long64_t nentries  = reader->GetEntries();
+    int      counter   = 0;
+    bool     condition = true;
+    double   firstT0   = 0.;
+    SFSignal conv_sig;
 
-    for (int i = 0; i < nentries; i++)
+    for (Long64_t i = 0; i < nentries; i++)
     {
-        tree->GetEntry(i);
-        SFSignal* conv_sig = ConvertSignal(sig);
-        condition          = InterpretCut(conv_sig, cut);
+        DDSignal* sig = reader->GetSignal(i);
+        if (sig == nullptr) continue;
+
+        ConvertSignal(sig, conv_sig);
+        condition = sigCut.Evaluate(&conv_sig);
         if (condition && fabs(firstT0) < 1E-10) firstT0 = sig->GetT0();
         if (condition && fabs(sig->GetT0() - firstT0) < 1)
         {
-            iTree->GetEntry(i);
+            const TVectorT<float>* iVolt = reader->GetWaveform(i);
+            if (iVolt == nullptr) continue;
+
             for (int ii = 0; ii < ipoints; ii++)
             {
                 psig->Fill(ii + 1, (*iVolt)[ii]);
@@ -1059,7 +1570,7 @@ TProfile* SFData::GetSignalAverageAachen(int ch, int ID, TString cut, int number
 /// Returns single raw signal.
 /// \param ch - channel number
 /// \param ID - ID of requested measurement
-/// \param cut - logic cut to choose signals (syntax explained in InterpretCut() function)
+/// \param cut - logic cut to choose signals (syntax explained in SFCut class)
 /// \param number - number of the signal to be drawn, eg. number=1 means that first signal
 /// which fulfills given cut will be drawn
 /// \param bl - flag for base line subtraction. If true - base line will be subtracted,
@@ -1087,15 +1598,125 @@ TH1D* SFData::GetSignal(int ch, int ID, TString cut, int number, bool bl)
     return sig;
 }
 //------------------------------------------------------------------
+/// This private function returns numbers of events (entries of the ROOT
+/// tree) containing signals of the Krakow test bench which fulfil given cut
+/// and base line sigma condition. The index is searched in memory first,
+/// then in the file stored next to sifi_results.root. If it doesn't exist
+/// yet or sifi_results.root has changed since it was written, the event
+/// cache (see SFEventCache) is scanned once and the index is saved, so that
+/// subsequent requests don't need to scan it again.
+/// \param ch - channel number
+/// \param ID - measuement ID
+/// \param cut - logic cut to choose signals (syntax explained in SFCut class)
+std::vector<int> SFData::GetSignalIndexKrakow(int ch, int ID, TString cut)
+{
+    int    index        = SFTools::GetIndex(fMeasureID, ID);
+    double BL_sigma_cut = SFTools::GetSigmaBL(fSiPM);
+
+    TString     key     = Form("ch%i_BLsig%g_", ch, BL_sigma_cut) + cut;
+    UInt_t      cutHash = key.Hash();
+    TString     memKey  = Form("ID%i_", ID) + key;
+    std::string fname   = std::string(SFTools::FindData(fNames[index]));
+    TString     iname   = fname + Form("/sig_index_ch%i_%u.txt", ch, cutHash);
+
+    auto it = fSignalIndex.find(memKey);
+    if (it != fSignalIndex.end()) return it->second;
+
+    // size and modification time of the data file are stored together with
+    // the key, so that index of regenerated data is never used
+    FileStat_t stat;
+    TString    fileKey = key;
+    if (gSystem->GetPathInfo(fFiles[index], stat) == 0)
+        fileKey = Form("%lld|%ld|", stat.fSize, stat.fMtime) + key;
+
+    std::vector<int> events;
+
+    //----- reading index from the file
+    std::ifstream input(iname);
+
+    if (input.is_open())
+    {
+        std::string line;
+        std::getline(input, line);
+
+        if (TString(line) == fileKey)
+        {
+            int event;
+            while (input >> event)
+                events.push_back(event);
+
+            input.close();
+            fSignalIndex[memKey] = events;
+            return events;
+        }
+
+        input.close();
+    }
+
+    //----- building index
+    SFCut sigCut;
+    if (!sigCut.SetCut(cut))
+    {
+        std::cerr << "##### Error in SFData::GetSignalIndexKrakow()!" << std::endl;
+        std::cerr << "Incorrect cut: " << cut << std::endl;
+        std::abort();
+    }
+
+    SFEventCache* cache  = GetEventCache(ID);
+    const int*    event  = cache->GetInt(SFCacheCol::kEvent);
+    const int*    module = cache->GetInt(SFCacheCol::kModule);
+    Long64_t      nrows  = cache->GetNrows();
+
+    SFSignal sig;
+
+    for (Long64_t i = 0; i < nrows; ++i)
+    {
+        int side = cache->GetSide(i, ch);
+        if (side < 0) continue;
+
+        cache->GetSignal(i, side, sig);
+        if (sigCut.Evaluate(&sig, module[i]) && sig.fBLsig < BL_sigma_cut)
+            events.push_back(event[i]);
+    }
+
+    //----- saving index, through temporary file so that concurrent readers
+    //----- never get incomplete index
+    TString       tmpname = iname + Form(".%i.tmp", gSystem->GetPid());
+    std::ofstream output(tmpname);
+    bool          written = output.is_open();
+
+    if (written)
+    {
+        output << fileKey << std::endl;
+        for (auto event : events)
+            output << event << "\n";
+        output.close();
+
+        written = !output.fail() && gSystem->Rename(tmpname, iname) == 0;
+        if (!written) gSystem->Unlink(tmpname);
+    }
+
+    if (!written)
+    {
+        std::cout << "##### Warning in SFData::GetSignalIndexKrakow()! Cannot save index file!"
+                  << std::endl;
+        std::cout << iname << std::endl;
+    }
+
+    fSignalIndex[memKey] = events;
+
+    return events;
+}
+//------------------------------------------------------------------
 /// This private function allows to access single raw signals recorded
-/// with the Krakow test bench. It opens binary file corresponding
-/// to the chosen measurement and channel. Based on the digitized data
-/// saved in the ROOT TTree it searches for signals which fulfil given cut
-/// and draws them.
+/// with the Krakow test bench. Number of the event containing requested
+/// signal is taken from the index of signals fulfilling given cut (see
+/// GetSignalIndexKrakow()), so only this single event and its waveform
+/// are read.
 /// \param ch - channel number
 /// \param ID - measuement ID
-/// \param cut - logic cut to choose signals (syntax explained in InterpretCutt()
-/// \param number - number of signals to be averaged
+/// \param cut - logic cut to choose signals (syntax explained in SFCut class)
+/// \param number - number of the signal to be drawn
 /// \param bl - flag for base line subtraction - if true baseline will be
 /// subtracted, if false - it will not.
 TH1D* SFData::GetSignalKrakow(int ch, int ID, TString cut, int number, bool bl)
@@ -1103,109 +1724,77 @@ TH1D* SFData::GetSignalKrakow(int ch, int ID, TString cut, int number, bool bl)
 
     int       index   = SFTools::GetIndex(fMeasureID, ID);
     const int ipoints = 1024;
-    float     x;
-
-    double BL_sigma_cut = SFTools::GetSigmaBL(fSiPM);
 
     std::string fname    = std::string(SFTools::FindData(fNames[index]));
     double      position = fPositions[index];
 
-    SLoop* loop = new SLoop();
-    loop->addFile(fname + "/sifi_results.root");
-    loop->setInput({});
-    SCategory* tSig = SCategoryManager::getCategory(SCategory::CatDDSamples);
+    TString hname  = Form("S%i_ch%i_pos_%.1f_ID%i_sig_no%i", fSeriesNo, ch, position, ID, number);
+    TString htitle = hname + " " + cut;
+
+    TH1D* hsig = new TH1D(hname, htitle, ipoints, 0, ipoints);
 
-    TString       iname = fname + Form("/wave_%i.dat", ch);
-    std::ifstream input(iname, std::ios::binary);
+    std::vector<int> events = GetSignalIndexKrakow(ch, ID, cut);
 
-    if (!input.is_open())
+    if (number < 1 || number > (int)events.size())
     {
+        std::cout << "##### Warning in SFData::GetSignalKrakow()! Signal number " << number
+                  << " requested, but only " << events.size() << " signals fulfil the cut."
+                  << std::endl;
+        return hsig;
+    }
+
+    int event = events[number - 1];
+
+    TString           iname = fname + Form("/wave_%i.dat", ch);
+    SFWaveformReader* input = nullptr;
+
+    try
+    {
+        input = new SFWaveformReader(iname, ipoints);
+    }
+    catch (const char* message)
+    {
+        std::cerr << message << std::endl;
         std::cerr << "##### Error in SFData::GetSignalKraków()! Cannot open binary file!"
                   << std::endl;
         std::cerr << iname << std::endl;
         std::abort();
     }
 
-    TString hname  = Form("S%i_ch%i_pos_%.1f_ID%i_sig_no%i", fSeriesNo, ch, position, ID, number);
-    TString htitle = hname + " " + cut;
-
-    TH1D* hsig = new TH1D(hname, htitle, ipoints, 0, ipoints);
+    Prefetch(index, Form("wave_%i.dat", ch));
 
-    int    nloop     = loop->getEntries();
-    double baseline  = 0.;
-    int    infile    = 0;
-    int    counter   = 0;
-    bool   condition = true;
+    const float* wave = input->GetEvent(event);
 
-    //SDDSamples* samples = nullptr;
-    //SDDSignal*  sigL    = nullptr;
-    //SDDSignal*  sigR    = nullptr;
-    
-    TH1*       hptr = nullptr;
-    SDDSignal* sptr = nullptr;
-    
-    for (int i = 0; i < nloop; ++i)
+    if (wave == nullptr)
     {
+        delete input;
+        return hsig;
+    }
 
-        loop->getEvent(i);
-        size_t tentries = tSig->getEntries();
-
-        for (int j = 0; j < tentries; ++j)
-        {
-            int              m, l, f;
-            SDDSamples* samples = (SDDSamples*)tSig->getObject(j);
-            SDDSignal*  sigL    = (SDDSignal*)samples->getSignalL();
-            SDDSignal*  sigR    = (SDDSignal*)samples->getSignalR();
-            samples->getAddress(m, l, f);
+    double baseline = 0.;
 
-            /*TH1**/       hptr = hsig;
-            /*SDDSignal**/ sptr = nullptr;
+    if (bl)
+    {
+        SFEventCache* cache  = GetEventCache(ID);
+        const int*    events = cache->GetInt(SFCacheCol::kEvent);
+        const float*  BL[2]  = {cache->GetFloat(SFCacheCol::kBL, 0),
+                                cache->GetFloat(SFCacheCol::kBL, 1)};
+        Long64_t      nrows  = cache->GetNrows();
 
-            if (ch == 0 && m == 0)
-            {
-                sptr = sigL;
-            }
-            else if (ch == 1 && m == 0)
-            {
-                sptr = sigR;
-            }
-            else if (ch == 2 && m == 1)
-            {
-                sptr = sigL;
-            }
-            else
-            {
-                hptr = nullptr;
-            }
+        // rows are ordered by event number
+        Long64_t row = std::lower_bound(events, events + nrows, event) - events;
 
-            if (hptr)
-            {
-//                 SFSignal* conv_sig = ConvertSignal(sptr);
-                auto conv_sig = std::unique_ptr<SFSignal>(ConvertSignal(sptr));
-                condition          = InterpretCut(conv_sig.get(), cut);
-                if (condition && conv_sig->fBLsig < BL_sigma_cut)
-                {
-                    counter++;
-                    if (counter != number) continue;
-                    infile = sizeof(x) * ipoints * i;
-                    if (bl) baseline = sptr->GetBL();
-                    input.seekg(infile);
-                    for (int ii = 1; ii < ipoints + 1; ii++)
-                    {
-                        input.read(reinterpret_cast<char*>(&x), sizeof(float));
-                        if (bl)
-                            hptr->SetBinContent(ii, (x - baseline) / gmV);
-                        else
-                            hptr->SetBinContent(ii, (x / gmV));
-                    }
-                }
-//                 delete conv_sig;
-            }
+        for (; row < nrows && events[row] == event; ++row)
+        {
+            int side = cache->GetSide(row, ch);
+            if (side >= 0) baseline = BL[side][row];
         }
     }
 
-    delete loop;
-    input.close();
+    for (int ii = 1; ii < ipoints + 1; ii++)
+        hsig->SetBinContent(ii, (wave[ii - 1] - baseline) / gmV);
+
+    delete input;
 
     return hsig;
 }
@@ -1218,57 +1807,80 @@ TH1D* SFData::GetSignalKrakow(int ch, int ID, TString cut, int number, bool bl)
 /// Returns single signal.
 /// \param ch - channel number
 /// \param ID - measurement ID
-/// \param cut - logic cut to choose signals. Syntax of this cut is explained in InterpretCut()
-/// function \param number - requested number of the signal to be drawn.
+/// \param cut - logic cut to choose signals. Syntax of this cut is explained in SFCut class
+/// \param number - requested number of the signal to be drawn.
 TH1D* SFData::GetSignalAachen(int ch, int ID, TString cut, int number)
 {
 
-    int       index   = SFTools::GetIndex(fMeasureID, ID);
-    const int ipoints = 1024;
-
-    TString   fname    = SFTools::FindData(fNames[index]);
+    int       index    = SFTools::GetIndex(fMeasureID, ID);
     double    position = fPositions[index];
-    TFile*    file     = new TFile(fname + "/results.root", "READ");
-    TTree*    tree     = (TTree*)file->Get("tree_ft");
-    DDSignal* sig      = new DDSignal();
-    tree->SetBranchAddress(Form("ch_%i", ch), &sig);
-
-    TString          iname = fname + "/waves.root";
-    TFile*           iFile = new TFile(iname, "READ");
-    TTree*           iTree = (TTree*)iFile->Get("wavetree");
-    TVectorT<float>* iVolt = new TVectorT<float>(ipoints);
-    TString          bname = Form("voltages_ch_%i", ch);
-    iTree->SetBranchAddress(bname, &iVolt);
+    const int ipoints  = 1024;
+
+    SFAachenReader* reader = GetAachenReader(ID);
+
+    if (!reader->SetChannel(ch))
+    {
+        std::cerr << "##### Error in SFData::GetSignalAachen()!" << std::endl;
+        std::abort();
+    }
+
+    SFCut sigCut;
+    if (!sigCut.SetCut(cut))
+    {
+        std::cerr << "##### Error in SFData::GetSignalAachen()!" << std::endl;
+        std::cerr << "Incorrect cut: " << cut << std::endl;
+        std::abort();
+    }
 
     TString hname  = Form("S%i_ch%i_pos_%.1f_ID%i_sig_no%i", fSeriesNo, ch, position, ID, number);
     TString htitle = hname + " " + cut;
 
     TH1D* hsig = new TH1D(hname, htitle, ipoints, 0, ipoints);
 
-    int  nentries  = tree->GetEntries();
-    int  counter   = 0;
-    bool condition = true;
+    Long64_t nentries  = reader->GetEntries();
+    int      counter   = 0;
+    bool     condition = true;
+    SFSignal conv_sig;
 
-    for (int i = 0; i < nentries; i++)
+    for (Long64_t i = 0; i < nentries; i++)
     {
-        tree->GetEntry(i);
-        iTree->GetEntry(i);
-        SFSignal* conv_sig = ConvertSignal(sig);
-        condition          = InterpretCut(conv_sig, cut);
+        DDSignal* sig = reader->GetSignal(i);
+        if (sig == nullptr) continue;
+
+        ConvertSignal(sig, conv_sig);
+        condition = sigCut.Evaluate(&conv_sig);
         if (condition)
         {
             counter++;
             if (counter != number) continue;
+
+            const TVectorT<float>* iVolt = reader->GetWaveform(i);
+            if (iVolt == nullptr) break;
+
             for (int ii = 0; ii < ipoints; ii++)
             {
                 hsig->SetBinContent(ii + 1, (*iVolt)[ii]);
             }
+            break;
         }
     }
 
     return hsig;
 }
 //------------------------------------------------------------------
+/// Removes histograms of all measurements in this series from SFHistCache,
+/// so that they are drawn from the ROOT files again.
+bool SFData::InvalidateHistCache(void)
+{
+
+    bool stat = true;
+
+    for (int i = 0; i < fNpoints; i++)
+        stat = SFHistCache::Invalidate(fFiles[i]) && stat;
+
+    return stat;
+}
+//------------------------------------------------------------------
 /// Prints details of currently analyzed experimental series.
 void SFData::Print(void)
 {
@@ -0,0 +1,386 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *           SFDecayFitter.cc            *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#include "SFDecayFitter.hh"
+#include "SFTools.hh"
+
+#include <algorithm>
+#include <cmath>
+
+ClassImp(SFDecayFitter);
+
+/// Bins of the signal included in the fit.
+struct DecayPoints
+{
+    std::vector<double> fX; ///< Bin centers
+    std::vector<double> fZ; ///< Bin contents with subtracted constant
+    std::vector<double> fW; ///< Weights, i.e. inverse squared bin errors
+};
+
+//------------------------------------------------------------------
+/// Collects bins of the signal with centers within the given range. Bins
+/// with zero uncertainty are skipped, like in ROOT chi2 fits.
+/// \param signal - averaged signal
+/// \param xmin - lower edge of the range
+/// \param xmax - upper edge of the range
+/// \param constant - value subtracted from the bin contents
+static DecayPoints GetPoints(TProfile* signal, double xmin, double xmax, double constant)
+{
+    DecayPoints points;
+
+    for (int bin = 1; bin <= signal->GetNbinsX(); bin++)
+    {
+        double x   = signal->GetBinCenter(bin);
+        double err = signal->GetBinError(bin);
+
+        if (x < xmin || x > xmax || err <= 0) continue;
+
+        points.fX.push_back(x);
+        points.fZ.push_back(signal->GetBinContent(bin) - constant);
+        points.fW.push_back(1. / (err * err));
+    }
+
+    return points;
+}
+//------------------------------------------------------------------
+/// Estimates decay time from the straight line fitted to the logarithm of
+/// the signal in the given range. Returns default value if estimation fails.
+/// \param points - fitted bins
+/// \param xmin - lower edge of the range
+/// \param xmax - upper edge of the range
+/// \param tau - default decay time
+static double EstimateDecay(const DecayPoints& points, double xmin, double xmax, double tau)
+{
+    double s = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+
+    for (size_t i = 0; i < points.fX.size(); i++)
+    {
+        if (points.fX[i] < xmin || points.fX[i] > xmax || points.fZ[i] <= 0) continue;
+
+        // uncertainty of log(z) is err/z
+        double w = points.fW[i] * points.fZ[i] * points.fZ[i];
+        double y = log(points.fZ[i]);
+        s += w;
+        sx += w * points.fX[i];
+        sy += w * y;
+        sxx += w * points.fX[i] * points.fX[i];
+        sxy += w * points.fX[i] * y;
+    }
+
+    double denom = s * sxx - sx * sx;
+    if (s == 0 || fabs(denom) < 1E-300) return tau;
+
+    double slope = (s * sxy - sx * sy) / denom;
+    if (slope >= 0) return tau;
+
+    return -1. / slope;
+}
+//------------------------------------------------------------------
+/// Calculates amplitudes minimizing chi2 for the given decay times and
+/// returns the chi2. Returns -1 if amplitudes can't be determined. If jac
+/// is given, residuals and their derivatives over decay times (with
+/// eliminated amplitudes) are also calculated.
+/// \param points - fitted bins
+/// \param t0 - time offset
+/// \param tau - decay times
+/// \param amp - calculated amplitudes
+/// \param res - calculated residuals
+/// \param jac - calculated derivatives of residuals, one vector per decay time
+static double Project(const DecayPoints& points, double t0, const std::vector<double>& tau,
+                      std::vector<double>& amp, std::vector<double>* res = nullptr,
+                      std::vector<std::vector<double>>* jac = nullptr)
+{
+    int ncomp   = tau.size();
+    int npoints = points.fX.size();
+
+    std::vector<std::vector<double>> phi(ncomp, std::vector<double>(npoints));
+
+    for (int k = 0; k < ncomp; k++)
+        for (int i = 0; i < npoints; i++)
+            phi[k][i] = exp(-(points.fX[i] - t0) / tau[k]);
+
+    std::vector<double> gram(ncomp * ncomp, 0.);
+    amp.assign(ncomp, 0.);
+
+    for (int i = 0; i < npoints; i++)
+    {
+        for (int k = 0; k < ncomp; k++)
+        {
+            amp[k] += points.fW[i] * phi[k][i] * points.fZ[i];
+            for (int l = 0; l < ncomp; l++)
+                gram[k * ncomp + l] += points.fW[i] * phi[k][i] * phi[l][i];
+        }
+    }
+
+    if (!SFTools::SolveLinear(gram, amp, ncomp)) return -1;
+
+    double chi2 = 0;
+    if (res != nullptr) res->assign(npoints, 0.);
+
+    for (int i = 0; i < npoints; i++)
+    {
+        double r = points.fZ[i];
+        for (int k = 0; k < ncomp; k++)
+            r -= amp[k] * phi[k][i];
+        chi2 += points.fW[i] * r * r;
+        if (res != nullptr) (*res)[i] = r;
+    }
+
+    if (jac == nullptr) return chi2;
+
+    //----- derivatives of the model over decay times at fixed amplitudes,
+    //----- projected on the space orthogonal to the linear functions
+    jac->assign(ncomp, std::vector<double>(npoints));
+
+    for (int k = 0; k < ncomp; k++)
+    {
+        std::vector<double> deriv(npoints);
+        std::vector<double> coeff(ncomp, 0.);
+
+        for (int i = 0; i < npoints; i++)
+        {
+            deriv[i] = amp[k] * phi[k][i] * (points.fX[i] - t0) / (tau[k] * tau[k]);
+            for (int l = 0; l < ncomp; l++)
+                coeff[l] += points.fW[i] * phi[l][i] * deriv[i];
+        }
+
+        if (!SFTools::SolveLinear(gram, coeff, ncomp)) return -1;
+
+        for (int i = 0; i < npoints; i++)
+        {
+            double proj = deriv[i];
+            for (int l = 0; l < ncomp; l++)
+                proj -= coeff[l] * phi[l][i];
+            (*jac)[k][i] = -proj;
+        }
+    }
+
+    return chi2;
+}
+//------------------------------------------------------------------
+/// Standard constructor.
+/// \param components - number of decay components: 1 or 2
+/// \param maxIter - maximal number of iterations
+/// \param tolerance - relative change of chi2 at which the fit is converged
+SFDecayFitter::SFDecayFitter(int components, int maxIter, double tolerance)
+    : fComponents(components),
+      fMaxIter(maxIter),
+      fTolerance(tolerance)
+{
+    if (fComponents != 1 && fComponents != 2)
+    {
+        std::cerr << "##### Error in SFDecayFitter constructor! Incorrect number of components: "
+                  << fComponents << std::endl;
+        throw "##### Exception in SFDecayFitter constructor!";
+    }
+}
+//------------------------------------------------------------------
+/// Default destructor.
+SFDecayFitter::~SFDecayFitter()
+{
+}
+//------------------------------------------------------------------
+/// Returns constant fitted to the signal in the given range, i.e. weighted
+/// mean of the bin contents.
+/// \param signal - averaged signal
+/// \param xmin - lower edge of the range
+/// \param xmax - upper edge of the range
+double SFDecayFitter::FitBaseLine(TProfile* signal, double xmin, double xmax)
+{
+    DecayPoints points = GetPoints(signal, xmin, xmax, 0.);
+
+    double sum  = 0;
+    double sumw = 0;
+
+    for (size_t i = 0; i < points.fX.size(); i++)
+    {
+        sum += points.fW[i] * points.fZ[i];
+        sumw += points.fW[i];
+    }
+
+    return sumw > 0 ? sum / sumw : 0.;
+}
+//------------------------------------------------------------------
+/// Fits the falling slope of the signal, from 20 ns after the maximum until
+/// the end of the signal. Base line is determined in the range 0 - 50 ns.
+/// Initial decay times are estimated from the logarithm of the signal: close
+/// to the maximum for the fast component, and after 400 ns for the slow one.
+/// \param signal - averaged signal
+SFDecayFitResult SFDecayFitter::Fit(TProfile* signal) const
+{
+    SFDecayFitResult result;
+
+    double t0       = signal->GetBinCenter(signal->GetMaximumBin());
+    double constant = FitBaseLine(signal, 0, 50);
+
+    result.fXmin = t0 + 20.;
+    result.fXmax = signal->GetBinCenter(signal->GetNbinsX());
+
+    DecayPoints points = GetPoints(signal, result.fXmin, result.fXmax, constant);
+
+    int npoints     = points.fX.size();
+    int nfree       = 2 * fComponents;
+    result.fNpoints = npoints;
+
+    if (npoints <= nfree)
+    {
+        std::cerr << "##### Error in SFDecayFitter::Fit()! Not enough points: " << npoints
+                  << std::endl;
+        return result;
+    }
+
+    //----- initial decay times
+    std::vector<double> tau(fComponents);
+
+    if (fComponents == 1)
+        tau[0] = EstimateDecay(points, result.fXmin, result.fXmin + 100, 10.);
+    else
+    {
+        tau[0] = EstimateDecay(points, result.fXmin, result.fXmin + 130, 10.);
+        tau[1] = EstimateDecay(points, 400, result.fXmax, 400.);
+        if (fabs(tau[1] - tau[0]) < 1E-3 * tau[0]) tau[1] = 10 * tau[0];
+    }
+
+    //----- Levenberg-Marquardt iterations over decay times
+    std::vector<double>              amp;
+    std::vector<double>              res;
+    std::vector<std::vector<double>> jac;
+
+    double chi2      = Project(points, t0, tau, amp, &res, &jac);
+    double lambda    = 1E-3;
+    bool   converged = false;
+
+    if (chi2 < 0)
+    {
+        std::cerr << "##### Error in SFDecayFitter::Fit()! Could not determine amplitudes!"
+                  << std::endl;
+        return result;
+    }
+
+    for (int iter = 0; iter < fMaxIter && !converged; iter++)
+    {
+        std::vector<double> alpha(fComponents * fComponents, 0.);
+        std::vector<double> beta(fComponents, 0.);
+
+        for (int i = 0; i < npoints; i++)
+        {
+            for (int k = 0; k < fComponents; k++)
+            {
+                beta[k] -= points.fW[i] * jac[k][i] * res[i];
+                for (int l = 0; l < fComponents; l++)
+                    alpha[k * fComponents + l] += points.fW[i] * jac[k][i] * jac[l][i];
+            }
+        }
+
+        bool improved = false;
+
+        while (!improved && lambda < 1E10)
+        {
+            std::vector<double> damped = alpha;
+            std::vector<double> step   = beta;
+
+            for (int k = 0; k < fComponents; k++)
+                damped[k * fComponents + k] *= 1. + lambda;
+
+            std::vector<double> trial = tau;
+            bool                valid = SFTools::SolveLinear(damped, step, fComponents);
+
+            for (int k = 0; k < fComponents && valid; k++)
+            {
+                trial[k] += step[k];
+                if (trial[k] <= 0) valid = false;
+            }
+
+            std::vector<double> trialAmp;
+            double trialChi2 = valid ? Project(points, t0, trial, trialAmp) : -1;
+
+            if (trialChi2 < 0 || trialChi2 > chi2)
+            {
+                lambda *= 10;
+                continue;
+            }
+
+            improved = true;
+
+            double maxStep = 0;
+            for (int k = 0; k < fComponents; k++)
+                maxStep = std::max(maxStep, fabs(step[k]) / trial[k]);
+
+            converged = (chi2 - trialChi2) <= fTolerance * chi2 || maxStep < 1E-9;
+
+            tau    = trial;
+            chi2   = Project(points, t0, tau, amp, &res, &jac);
+            lambda = std::max(lambda / 10, 1E-12);
+        }
+
+        // no step decreases chi2 anymore, i.e. minimum is reached
+        if (!improved) converged = true;
+    }
+
+    //----- uncertainties from the curvature of chi2 in all free parameters,
+    //----- ordered as A_1, tau_1, A_2, tau_2
+    std::vector<double> hess(nfree * nfree, 0.);
+    std::vector<double> deriv(nfree);
+
+    for (int i = 0; i < npoints; i++)
+    {
+        for (int k = 0; k < fComponents; k++)
+        {
+            double phi       = exp(-(points.fX[i] - t0) / tau[k]);
+            deriv[2 * k]     = phi;
+            deriv[2 * k + 1] = amp[k] * phi * (points.fX[i] - t0) / (tau[k] * tau[k]);
+        }
+
+        for (int p = 0; p < nfree; p++)
+            for (int q = 0; q < nfree; q++)
+                hess[p * nfree + q] += points.fW[i] * deriv[p] * deriv[q];
+    }
+
+    std::vector<double> errors(nfree, 0.);
+    bool                inverted = true;
+
+    for (int p = 0; p < nfree && inverted; p++)
+    {
+        std::vector<double> col(nfree, 0.);
+        col[p]   = 1.;
+        inverted = SFTools::SolveLinear(hess, col, nfree) && col[p] > 0;
+        if (inverted) errors[p] = sqrt(col[p]);
+    }
+
+    //----- parameters in the order of the fitted functions
+    if (fComponents == 1)
+    {
+        result.fParameters = {amp[0], t0, tau[0], constant};
+        result.fParErrors  = {errors[0], 0., errors[1], 0.};
+    }
+    else
+    {
+        result.fParameters = {amp[0], t0, tau[0], amp[1], tau[1], constant};
+        result.fParErrors  = {errors[0], 0., errors[1], errors[2], errors[3], 0.};
+    }
+
+    result.fChi2 = chi2;
+    result.fNDF  = npoints - nfree;
+    result.fStat = (converged && inverted) ? 0 : (inverted ? 4 : 3);
+
+    return result;
+}
+//------------------------------------------------------------------
+/// Prints details of the SFDecayFitter class object.
+void SFDecayFitter::Print(void)
+{
+    std::cout << "\n-------------------------------------------" << std::endl;
+    std::cout << "This is print out of SFDecayFitter class object" << std::endl;
+    std::cout << "Number of decay components: " << fComponents << std::endl;
+    std::cout << "Maximal number of iterations: " << fMaxIter << std::endl;
+    std::cout << "Tolerance: " << fTolerance << std::endl;
+    std::cout << "-------------------------------------------\n" << std::endl;
+}
+//------------------------------------------------------------------
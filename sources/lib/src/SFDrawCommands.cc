@@ -10,6 +10,9 @@
 
 #include "SFDrawCommands.hh"
 
+#include <TObjArray.h>
+#include <TObjString.h>
+
 ClassImp(SFDrawCommands);
 
 const double ampMax = 660; // maximum valid amplitude [mV] in measurements 
@@ -496,6 +499,85 @@ TString SFDrawCommands::GetCut(SFCutType cut, std::vector<double> customNum)
     return cutString;
 }
 //------------------------------------------------------------------
+/// Splits selection string returned by GetSelection() into drawn expressions
+/// and histogram binning. Expressions are returned in the TTree::Draw() order,
+/// i.e. for 2D selections "y:x" the first expression is the one on the y axis.
+/// Binning is returned as (nbins, min, max) for the x axis, followed by
+/// (nbins, min, max) for the y axis in case of 2D selections.
+/// \param selection - selection string, as returned by GetSelection()
+/// \param expressions - vector to be filled with drawn expressions
+/// \param binning - vector to be filled with binning of the histogram
+bool SFDrawCommands::ParseSelection(TString selection, std::vector<TString>& expressions,
+                                    std::vector<double>& binning)
+{
+    expressions.clear();
+    binning.clear();
+
+    int iarrow = selection.Index(">>");
+
+    if (iarrow == -1)
+    {
+        std::cerr << "##### Error in SFDrawCommands::ParseSelection()!" << std::endl;
+        std::cerr << "Missing '>>' in selection: " << selection << std::endl;
+        return false;
+    }
+
+    TString varexp = selection(0, iarrow);
+    TString target = selection(iarrow + 2, selection.Length() - iarrow - 2);
+
+    //----- splitting expressions on ':' outside of parentheses
+    int depth  = 0;
+    int istart = 0;
+
+    for (int i = 0; i < varexp.Length(); i++)
+    {
+        if (varexp[i] == '(')
+            depth++;
+        else if (varexp[i] == ')')
+            depth--;
+        else if (varexp[i] == ':' && depth == 0)
+        {
+            expressions.push_back(varexp(istart, i - istart));
+            istart = i + 1;
+        }
+    }
+
+    expressions.push_back(varexp(istart, varexp.Length() - istart));
+
+    //----- extracting binning
+    int iopen  = target.Index("(");
+    int iclose = target.Index(")");
+
+    if (iopen == -1)
+    {
+        std::cerr << "##### Error in SFDrawCommands::ParseSelection()!" << std::endl;
+        std::cerr << "Missing binning in selection: " << selection << std::endl;
+        return false;
+    }
+
+    if (iclose == -1) iclose = target.Length();
+
+    TString    bins   = target(iopen + 1, iclose - iopen - 1);
+    TObjArray* tokens = bins.Tokenize(",");
+
+    for (int i = 0; i < tokens->GetEntries(); i++)
+    {
+        binning.push_back(((TObjString*)tokens->At(i))->GetString().Atof());
+    }
+
+    delete tokens;
+
+    if (expressions.size() > 2 || binning.size() != 3 * expressions.size())
+    {
+        std::cerr << "##### Error in SFDrawCommands::ParseSelection()!" << std::endl;
+        std::cerr << "Incorrect number of expressions or binning parameters in selection: "
+                  << selection << std::endl;
+        return false;
+    }
+
+    return true;
+}
+//------------------------------------------------------------------
 /// Prints details of the SFDrawCommands class object.
 void SFDrawCommands::Print(void)
 {
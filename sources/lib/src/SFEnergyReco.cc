@@ -14,6 +14,7 @@ const double ampMax = 660;
 
 //------------------------------------------------------------------
 SFEnergyReco::SFEnergyReco(int seriesNo) : fSeriesNo(seriesNo), 
+                                           fContext(nullptr),
                                            fData(nullptr),
                                            fModel(nullptr),
                                            fMAttCh0Graph(nullptr),
@@ -28,7 +29,7 @@ SFEnergyReco::SFEnergyReco(int seriesNo) : fSeriesNo(seriesNo),
 {
     try
     {
-        fData = new SFData(fSeriesNo);
+        fContext = SFSeriesContext::Acquire(fSeriesNo);
     }
     catch (const char* message)
     {
@@ -36,25 +37,50 @@ SFEnergyReco::SFEnergyReco(int seriesNo) : fSeriesNo(seriesNo),
         throw "##### Exception in SFEnergyReco constructor!";
     }
 
-    TString desc = fData->GetDescription();
-
-    if (!desc.Contains("Regular series"))
+    if (!Init())
     {
-        std::cout << "##### Error in SFEnergyReco constructor! Non-regular series!"
-                  << std::endl;
+        fContext->Release();
         throw "##### Exception in SFEnergyReco constructor!";
     }
+}
+//------------------------------------------------------------------
+SFEnergyReco::SFEnergyReco(SFSeriesContext* context) : fSeriesNo(context->GetSeriesNo()),
+                                                       fContext(context),
+                                                       fData(nullptr),
+                                                       fModel(nullptr),
+                                                       fMAttCh0Graph(nullptr),
+                                                       fMAttCh1Graph(nullptr),
+                                                       fMAttCh0CorrGraph(nullptr),
+                                                       fMAttCh1CorrGraph(nullptr),
+                                                       fPlRecoFun(nullptr),
+                                                       fPrRecoFun(nullptr),
+                                                       fResultsExp(nullptr),
+                                                       fResultsCorr(nullptr),
+                                                       fEref(511.0)
+{
+    fContext->Retain();
 
-    try
+    if (!Init())
     {
-        fModel = new SFAttenuationModel(fSeriesNo);
+        fContext->Release();
+        throw "##### Exception in SFEnergyReco constructor!";
     }
-    catch (const char* message)
+}
+//------------------------------------------------------------------
+bool SFEnergyReco::Init(void)
+{
+    fData = fContext->GetData();
+
+    TString desc = fData->GetDescription();
+
+    if (!desc.Contains("Regular series"))
     {
-        std::cerr << message << std::endl;
-        throw "##### Exception in SFEnergyReco constructor!";
+        std::cout << "##### Error in SFEnergyReco constructor! Non-regular series!"
+                  << std::endl;
+        return false;
     }
 
+    fModel = fContext->GetAttenuationModel();
     fModel->FitModel();
     
     SFResults* model_res = fModel->GetResults();
@@ -69,12 +95,13 @@ SFEnergyReco::SFEnergyReco(int seriesNo) : fSeriesNo(seriesNo),
     
     fResultsExp  = new SFResults(Form("EnergyRecoResults_S%i_Exp", fSeriesNo));
     fResultsCorr = new SFResults(Form("EnergyRecoResults_S%i_Corr", fSeriesNo));
+
+    return true;
 }
 //------------------------------------------------------------------
 SFEnergyReco::~SFEnergyReco()
 {
-    if (fData != nullptr) 
-        delete fData;
+    if (fContext != nullptr) fContext->Release();
 };
 //------------------------------------------------------------------
 bool SFEnergyReco::CalculateAlpha(void)
@@ -299,21 +326,21 @@ bool SFEnergyReco::EnergyRecoByEvent(void)
     double eres_cor_sum    = 0;
     double eres_cor_sumerr = 0;
     
-    std::vector<double> parsForErrors(9);
-    parsForErrors[0] = fModel->GetResults()->GetValue(SFResultTypeNum::kLambda);
-    parsForErrors[1] = fModel->GetResults()->GetValue(SFResultTypeNum::kEtaR);
-    parsForErrors[2] = fModel->GetResults()->GetValue(SFResultTypeNum::kEtaL);
-    parsForErrors[3] = fModel->GetResults()->GetValue(SFResultTypeNum::kKsi);
-    parsForErrors[4] = fModel->GetResults()->GetValue(SFResultTypeNum::kLength);
-    
+    //----- model parameters bound once for all events
+    SFRecoKernel* kernel = fModel->GetRecoKernel();
+
+    //----- event caches, histograms and peak finders are prepared sequentially,
+    //----- since they are shared with other analyses of the series
+    std::vector<SFEventCache*>       caches(npointsMax);
+    std::vector<double>              sigmaSL(npointsMax), sigmaSR(npointsMax);
+    std::vector<std::vector<double>> eReco(npointsMax), eCorr(npointsMax);
+
     for (int npoint = 0; npoint < npointsMax; npoint++)
     {
         std::cout << "\t Analyzing position " << positions[npoint] << " mm..." << std::endl;
         
-        //----- getting tree
-        SLoop*     loop     = fData->GetTree(measurementsIDs[npoint]);
-        int        nloopMax = loop->getEntries();
-        SCategory* tSig     = SCategoryManager::getCategory(SCategory::CatDDSamples);
+        //----- getting event cache
+        caches[npoint] = fData->GetEventCache(measurementsIDs[npoint]);
         
         //----- setting histograms
         hname_e = Form("S%i_hEnergyRecoExp_pos%.1f", fSeriesNo, positions[npoint]);
@@ -332,84 +359,79 @@ bool SFEnergyReco::EnergyRecoByEvent(void)
         TString cutCh0 = SFDrawCommands::GetCut(SFCutType::kSpecCh0, sigma);
         TString cutCh1 = SFDrawCommands::GetCut(SFCutType::kSpecCh1, sigma);
         
-        auto specCh0 = std::unique_ptr<TH1D>(fData->GetSpectrum(0, SFSelectionType::kPE, cutCh0, measurementsIDs[npoint]));
-        auto specCh1 = std::unique_ptr<TH1D>(fData->GetSpectrum(1, SFSelectionType::kPE, cutCh1, measurementsIDs[npoint]));
+        TH1D* specCh0 = fContext->GetSpectrum(0, SFSelectionType::kPE, cutCh0, measurementsIDs[npoint]);
+        TH1D* specCh1 = fContext->GetSpectrum(1, SFSelectionType::kPE, cutCh1, measurementsIDs[npoint]);
         
-        auto peakFinCh0 = std::unique_ptr<SFPeakFinder>(new SFPeakFinder(specCh0.get(), false));
-        peakFinCh0->FindPeakFit();
+        SFPeakFinder* peakFinCh0 = fContext->GetPeakFinder(specCh0);
+        SFPeakFinder* peakFinCh1 = fContext->GetPeakFinder(specCh1);
         
-        auto peakFinCh1 = std::unique_ptr<SFPeakFinder>(new SFPeakFinder(specCh1.get(), false));
-        peakFinCh1->FindPeakFit();
-        
-        parsForErrors[7] = peakFinCh0->GetResults()->GetValue(SFResultTypeNum::kPeakSigma);
-        parsForErrors[8] = peakFinCh1->GetResults()->GetValue(SFResultTypeNum::kPeakSigma);
-        
-        //----- filling histograms
-        for (int nloop = 0; nloop < nloopMax; nloop++)
+        sigmaSL[npoint] = peakFinCh0->GetResults()->GetValue(SFResultTypeNum::kPeakSigma);
+        sigmaSR[npoint] = peakFinCh1->GetResults()->GetValue(SFResultTypeNum::kPeakSigma);
+    }
+
+    //----- event loops of the positions are independent and run in parallel
+    SFTools::ParallelFor(npointsMax, [&](int npoint) {
+        SFEventCache* cache  = caches[npoint];
+        Long64_t      nrows  = cache->GetNrows();
+        const int*    module = cache->GetInt(SFCacheCol::kModule);
+        const float*  t0Ch0  = cache->GetFloat(SFCacheCol::kT0, 0);
+        const float*  t0Ch1  = cache->GetFloat(SFCacheCol::kT0, 1);
+        const float*  peCh0  = cache->GetFloat(SFCacheCol::kPE, 0);
+        const float*  peCh1  = cache->GetFloat(SFCacheCol::kPE, 1);
+        const float*  totCh0 = cache->GetFloat(SFCacheCol::kTOT, 0);
+        const float*  totCh1 = cache->GetFloat(SFCacheCol::kTOT, 1);
+        const float*  ampCh0 = cache->GetFloat(SFCacheCol::kAmp, 0);
+        const float*  ampCh1 = cache->GetFloat(SFCacheCol::kAmp, 1);
+
+        //----- selecting events
+        std::vector<double> SL, SR;
+
+        for (Long64_t i = 0; i < nrows; ++i)
         {
-            loop->getEvent(nloop);
-            size_t tentriesMax = tSig->getEntries();
-            
-            for (int tentries = 0; tentries < tentriesMax; tentries++)
+            if (module[i] != 0) continue;
+
+            if (t0Ch0[i] > 0 && t0Ch1[i] > 0 &&
+                totCh0[i] > 0 && totCh1[i] > 0 &&
+                ampCh0[i] < ampMax && ampCh1[i] < ampMax &&
+                peCh0[i] > 0 && peCh1[i] > 0)
             {
-                int m, l, f;
-                SDDSamples* samples = (SDDSamples*)tSig->getObject(tentries);
-                samples->getAddress(m, l, f);
-                
-                if (m == 0)
-                {
-                    double t0Ch0 = samples->getSignalL()->GetT0();
-                    double t0Ch1 = samples->getSignalR()->GetT0();
-                    double peCh0  = samples->getSignalL()->GetPE();
-                    double peCh1  = samples->getSignalR()->GetPE();
-                    double blCh0  = samples->getSignalL()->GetBLSigma();
-                    double blCh1  = samples->getSignalR()->GetBLSigma();
-                    double totCh0 = samples->getSignalL()->GetTOT();
-                    double totCh1 = samples->getSignalR()->GetTOT();
-                    double ampCh0 = samples->getSignalL()->GetAmplitude();
-                    double ampCh1 = samples->getSignalR()->GetAmplitude();
-                    bool   vetoCh0 = samples->getSignalL()->GetVeto();
-                    bool   vetoCh1 = samples->getSignalR()->GetVeto();
-                    
-                    if (t0Ch0 > 0 && t0Ch1 > 0 &&
-                        totCh0 > 0 && totCh1 > 0 &&
-                        //blCh0 < BL_sigma_cut && blCh1 < BL_sigma_cut &&
-                        ampCh0 < ampMax && ampCh1 < ampMax &&
-                        peCh0 > 0 && peCh1 > 0)// &&
-                        //vetoCh0 == 0 && vetoCh1 == 0)
-                    {
-                        double e_reco = alpha * sqrt(peCh0 * peCh1);
-                        
-                        parsForErrors[5] = peCh0;
-                        parsForErrors[6] = peCh1;
-                        
-//                         for (int k=0; k<9; k++)
-//                         {
-//                             std::cout << parsForErrors[k] << "\t";
-//                         }
-//                         std::cout << std::endl;
-                        
-                        double Pl_err = fModel->CalculateUncertainty(parsForErrors, "L");
-                        double Pr_err = fModel->CalculateUncertainty(parsForErrors, "R");
-                        
-                        double q_av = sqrt(fPlRecoFun->Eval(peCh1, peCh0) *
-                                           fPrRecoFun->Eval(peCh1, peCh0));
-                        double e_corr_reco = alpha_corr * q_av;
-                        double e_reco_corr_err = sqrt(pow(q_av * alpha_corr_err, 2) + 
-                                                      pow((alpha_corr * fPrRecoFun->Eval(peCh1, peCh0)) / (2 * q_av) * Pl_err, 2) + 
-                                                      pow((alpha_corr * fPlRecoFun->Eval(peCh1, peCh0)) / (2 * q_av) * Pr_err, 2));
-                        
-                        fEnergySpectra[npoint]->Fill(e_reco);
-                        fEnergySpectraCorr[npoint]->Fill(e_corr_reco);
-                        fEnergyUncertDistCorr[npoint]->Fill(e_reco_corr_err);
-                        
-                        hEnergySpecAll->Fill(e_reco);
-                        hEnergySpecAllCorr->Fill(e_corr_reco);
-                    }
-                    
-                }
+                SL.push_back(peCh0[i]);
+                SR.push_back(peCh1[i]);
             }
         }
+
+        //----- reconstructing energy
+        int                 nsel = SL.size();
+        std::vector<double> resErr(nsel);
+
+        eReco[npoint].resize(nsel);
+        eCorr[npoint].resize(nsel);
+
+        kernel->Energy(nsel, SL.data(), SR.data(), sigmaSL[npoint], sigmaSR[npoint], alpha_corr,
+                       alpha_corr_err, eCorr[npoint].data(), resErr.data());
+
+        //----- filling histograms of this position
+        for (int i = 0; i < nsel; ++i)
+        {
+            eReco[npoint][i] = alpha * sqrt(SL[i] * SR[i]);
+
+            fEnergySpectra[npoint]->Fill(eReco[npoint][i]);
+            fEnergySpectraCorr[npoint]->Fill(eCorr[npoint][i]);
+            fEnergyUncertDistCorr[npoint]->Fill(resErr[i]);
+        }
+    });
+
+    for (int npoint = 0; npoint < npointsMax; npoint++)
+    {
+        //----- filling summed histograms
+        for (size_t i = 0; i < eReco[npoint].size(); ++i)
+        {
+            hEnergySpecAll->Fill(eReco[npoint][i]);
+            hEnergySpecAllCorr->Fill(eCorr[npoint][i]);
+        }
+
+        std::vector<double>().swap(eReco[npoint]);
+        std::vector<double>().swap(eCorr[npoint]);
         
         double mean, mean_err;
         double sigma, sigma_err;
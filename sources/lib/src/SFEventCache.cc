@@ -0,0 +1,389 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *            SFEventCache.cc            *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#include "SFEventCache.hh"
+#include "SFData.hh"
+#include "SFFilePool.hh"
+#include "SFTools.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+ClassImp(SFEventCache);
+
+/// Identifier written at the beginning of the cache file.
+static const char gCacheMagic[8] = {'S', 'F', 'C', 'A', 'C', 'H', 'E', '1'};
+/// Number of common columns (event, module, layer, fiber).
+static const int gNcommon = 4;
+/// Number of columns stored separately for each side.
+static const int gNsided = 9;
+/// Total number of columns in the cache file.
+static const int gNcols = gNcommon + 2 * gNsided;
+/// Size of the cache file header [bytes]: magic, number of columns,
+/// reserved word and number of rows.
+static const size_t gHeaderSize = 8 + 4 + 4 + 8;
+/// Fields of SDDSignal stored in the cache, for each side.
+static const std::vector<TString> gSignalFields = {"fPE",  "fCharge",   "fAmp",  "fT0",    "fTOT",
+                                                   "fBL",  "fBL_sigma", "fVeto", "fPileUp"};
+
+/// Returns names of all branches of sifi_results.root decoded into the
+/// cache. Other fields of SDDSamples are not read.
+static std::vector<TString> CachedBranches(void)
+{
+    std::vector<TString> branches = {"SDDSamples.data.module", "SDDSamples.data.layer",
+                                     "SDDSamples.data.fiber"};
+
+    for (auto side : {"signal_l", "signal_r"})
+    {
+        for (auto& field : gSignalFields)
+            branches.push_back(Form("SDDSamples.data.%s.%s", side, field.Data()));
+    }
+
+    return branches;
+}
+
+//------------------------------------------------------------------
+/// Standard constructor. Opens the cache file of the measurement stored
+/// in the given directory. If the cache file doesn't exist or is outdated
+/// it is created from sifi_results.root.
+/// \param directory - directory containing sifi_results.root
+SFEventCache::SFEventCache(TString directory) : fDirectory(directory),
+                                                fFileName(directory + "/sifi_cache.bin"),
+                                                fNrows(0),
+                                                fFD(-1),
+                                                fMap(nullptr),
+                                                fMapSize(0),
+                                                fColumns(nullptr)
+{
+    SetColumns();
+
+    if (!Open() && !Build())
+    {
+        std::cerr << "##### Error in SFEventCache constructor! Cannot create event cache!"
+                  << std::endl;
+        std::cerr << fDirectory << std::endl;
+        throw "##### Exception in SFEventCache constructor!";
+    }
+}
+//------------------------------------------------------------------
+/// Default destructor. Unmaps and closes the cache file.
+SFEventCache::~SFEventCache()
+{
+    Close();
+}
+//------------------------------------------------------------------
+/// Opens and maps existing cache file. Returns false if the file doesn't
+/// exist, is older than sifi_results.root or its header doesn't match.
+bool SFEventCache::Open(void)
+{
+    struct stat stCache, stData;
+
+    if (stat(fFileName.Data(), &stCache) != 0) return false;
+
+    TString dname = fDirectory + "/sifi_results.root";
+    if (stat(dname.Data(), &stData) == 0 && stData.st_mtime > stCache.st_mtime) return false;
+
+    fFD = open(fFileName.Data(), O_RDONLY);
+
+    if (fFD < 0) return false;
+
+    char    magic[8];
+    int32_t ncols    = 0;
+    int32_t reserved = 0;
+    int64_t nrows    = 0;
+
+    if (read(fFD, magic, 8) != 8 || read(fFD, &ncols, 4) != 4 ||
+        read(fFD, &reserved, 4) != 4 || read(fFD, &nrows, 8) != 8 ||
+        memcmp(magic, gCacheMagic, 8) != 0 || ncols != gNcols || nrows < 0 ||
+        static_cast<size_t>(stCache.st_size) !=
+            gHeaderSize + sizeof(int) * gNcols * static_cast<size_t>(nrows))
+    {
+        Close();
+        return false;
+    }
+
+    fNrows   = nrows;
+    fMapSize = stCache.st_size;
+    fMap     = mmap(nullptr, fMapSize, PROT_READ, MAP_PRIVATE, fFD, 0);
+
+    if (fMap == MAP_FAILED)
+    {
+        fMap = nullptr;
+        Close();
+        return false;
+    }
+
+    madvise(fMap, fMapSize, MADV_SEQUENTIAL);
+    fColumns = static_cast<const char*>(fMap) + gHeaderSize;
+    SetColumns();
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Decodes all SDDSamples objects from sifi_results.root and stores
+/// their fields in columns. Columns are written to the cache file and
+/// the file is mapped. If writing fails columns are kept in memory.
+bool SFEventCache::Build(void)
+{
+    Close();
+
+    std::string fname = std::string(fDirectory) + "/sifi_results.root";
+
+    // SLoop opens the file by itself
+    SFFilePool::Evict(fname);
+
+    SLoop loop;
+    loop.addFile(fname);
+    loop.setInput({});
+
+    if (!SFTools::SelectBranches(loop.getChain(), CachedBranches()))
+    {
+        std::cout << "##### Warning in SFEventCache::Build()! Reading all branches of " << fname
+                  << std::endl;
+    }
+
+    SCategory* tSig = SCategoryManager::getCategory(SCategory::CatDDSamples);
+
+    if (tSig == nullptr) return false;
+
+    std::vector<std::vector<int>> columns(gNcols);
+
+    int n = loop.getEntries();
+
+    for (int i = 0; i < n; ++i)
+    {
+        loop.nextEvent();
+        size_t tentries = tSig->getEntries();
+
+        for (int j = 0; j < tentries; ++j)
+        {
+            int         m, l, f;
+            SDDSamples* samples = (SDDSamples*)tSig->getObject(j);
+            samples->getAddress(m, l, f);
+
+            columns[0].push_back(i);
+            columns[1].push_back(m);
+            columns[2].push_back(l);
+            columns[3].push_back(f);
+
+            for (int side = 0; side < 2; ++side)
+            {
+                SDDSignal* sig = side == 0 ? (SDDSignal*)samples->getSignalL()
+                                           : (SDDSignal*)samples->getSignalR();
+                float values[gNsided - 2] = {(float)sig->GetPE(),  (float)sig->GetCharge(),
+                                             (float)sig->GetAmplitude(), (float)sig->GetT0(),
+                                             (float)sig->GetTOT(), (float)sig->GetBL(),
+                                             (float)sig->GetBLSigma()};
+                int    col = gNcommon + side * gNsided;
+
+                for (int k = 0; k < gNsided - 2; ++k)
+                {
+                    int bits;
+                    memcpy(&bits, &values[k], sizeof(int));
+                    columns[col + k].push_back(bits);
+                }
+
+                columns[col + gNsided - 2].push_back(sig->GetVeto());
+                columns[col + gNsided - 1].push_back(sig->GetPileUp());
+            }
+        }
+    }
+
+    Long64_t rows = columns[0].size();
+    fNrows        = rows;
+
+    //----- writing cache file
+    int32_t ncols    = gNcols;
+    int32_t reserved = 0;
+    int64_t nrows    = fNrows;
+
+    // temporary name is unique for the process, so that processes building
+    // the same cache concurrently never write to the same file
+    TString tmpname = fFileName + Form(".%i.tmp", (int)getpid());
+    int     fd      = open(tmpname.Data(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool    written = fd >= 0;
+
+    if (written)
+    {
+        written = write(fd, gCacheMagic, 8) == 8 && write(fd, &ncols, 4) == 4 &&
+                  write(fd, &reserved, 4) == 4 && write(fd, &nrows, 8) == 8;
+
+        for (int c = 0; c < gNcols && written; ++c)
+        {
+            const char* src   = reinterpret_cast<const char*>(columns[c].data());
+            size_t      size  = sizeof(int) * columns[c].size();
+            size_t      nsave = 0;
+
+            while (nsave < size)
+            {
+                ssize_t k = write(fd, src + nsave, size - nsave);
+                if (k <= 0)
+                {
+                    written = false;
+                    break;
+                }
+                nsave += k;
+            }
+        }
+
+        close(fd);
+        written = written && rename(tmpname.Data(), fFileName.Data()) == 0;
+        if (!written) unlink(tmpname.Data());
+    }
+
+    if (written && Open()) return true;
+
+    //----- cache file not available, keeping columns in memory
+    std::cout << "##### Warning in SFEventCache::Build()! Could not write cache file "
+              << fFileName << ". Columns will be kept in memory only." << std::endl;
+
+    fNrows = rows;
+    fBuffer.resize(static_cast<size_t>(gNcols) * fNrows);
+
+    for (int c = 0; c < gNcols; ++c)
+        std::copy(columns[c].begin(), columns[c].end(), fBuffer.begin() + c * fNrows);
+
+    fColumns = reinterpret_cast<const char*>(fBuffer.data());
+    SetColumns();
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Unmaps and closes the cache file, releases the buffer.
+void SFEventCache::Close(void)
+{
+    if (fMap != nullptr) munmap(fMap, fMapSize);
+    if (fFD >= 0) close(fFD);
+
+    fMap     = nullptr;
+    fMapSize = 0;
+    fFD      = -1;
+    fColumns = nullptr;
+    fNrows   = 0;
+    std::vector<int>().swap(fBuffer);
+    SetColumns();
+}
+//------------------------------------------------------------------
+/// Resolves pointers to the columns used by GetSide() and GetSignal(),
+/// so that per-row access is a plain indexed load. Pointers are reset
+/// if no columns are available.
+void SFEventCache::SetColumns(void)
+{
+    auto ints = [this](SFCacheCol col, int side) -> const int* {
+        if (fColumns == nullptr) return nullptr;
+        return reinterpret_cast<const int*>(fColumns) + GetColumnIndex(col, side) * fNrows;
+    };
+
+    fModuleCol = ints(SFCacheCol::kModule, 0);
+
+    for (int side = 0; side < 2; side++)
+    {
+        for (int c = 0; c < 7; c++)
+        {
+            auto col = static_cast<SFCacheCol>(static_cast<int>(SFCacheCol::kPE) + c);
+            fFloatCols[side][c] = reinterpret_cast<const float*>(ints(col, side));
+        }
+
+        fVetoCol[side]   = ints(SFCacheCol::kVeto, side);
+        fPileUpCol[side] = ints(SFCacheCol::kPileUp, side);
+    }
+}
+//------------------------------------------------------------------
+/// Returns index of the requested column in the cache file.
+/// \param col - column
+/// \param side - side of the fiber: 0 - left, 1 - right
+size_t SFEventCache::GetColumnIndex(SFCacheCol col, int side)
+{
+    int c = static_cast<int>(col);
+
+    if (c < gNcommon) return c;
+
+    if (side != 0 && side != 1)
+    {
+        std::cerr << "##### Error in SFEventCache::GetColumnIndex()! Incorrect side: " << side
+                  << std::endl;
+        std::abort();
+    }
+
+    return gNcommon + side * gNsided + (c - gNcommon);
+}
+//------------------------------------------------------------------
+/// Returns pointer to the first element of the integer column. Available
+/// columns: kEvent, kModule, kLayer, kFiber, kVeto and kPileUp. Number
+/// of elements is equal to GetNrows().
+/// \param col - column
+/// \param side - side of the fiber: 0 - left, 1 - right
+const int* SFEventCache::GetInt(SFCacheCol col, int side)
+{
+    if (col != SFCacheCol::kEvent && col != SFCacheCol::kModule &&
+        col != SFCacheCol::kLayer && col != SFCacheCol::kFiber &&
+        col != SFCacheCol::kVeto && col != SFCacheCol::kPileUp)
+    {
+        std::cerr << "##### Error in SFEventCache::GetInt()! Column "
+                  << static_cast<int>(col) << " is not of integer type!" << std::endl;
+        std::abort();
+    }
+
+    return reinterpret_cast<const int*>(fColumns) + GetColumnIndex(col, side) * fNrows;
+}
+//------------------------------------------------------------------
+/// Returns pointer to the first element of the floating point column.
+/// Available columns: kPE, kCharge, kAmp, kT0, kTOT, kBL and kBLSigma.
+/// Number of elements is equal to GetNrows().
+/// \param col - column
+/// \param side - side of the fiber: 0 - left, 1 - right
+const float* SFEventCache::GetFloat(SFCacheCol col, int side)
+{
+    int c = static_cast<int>(col);
+
+    if (c < static_cast<int>(SFCacheCol::kPE) || c > static_cast<int>(SFCacheCol::kBLSigma))
+    {
+        std::cerr << "##### Error in SFEventCache::GetFloat()! Column " << c
+                  << " is not of floating point type!" << std::endl;
+        std::abort();
+    }
+
+    return reinterpret_cast<const float*>(fColumns) + GetColumnIndex(col, side) * fNrows;
+}
+//------------------------------------------------------------------
+/// Fills SFSignal object with values stored in the given row.
+/// \param row - row number
+/// \param side - side of the fiber: 0 - left, 1 - right
+/// \param sig - filled signal
+void SFEventCache::GetSignal(Long64_t row, int side, SFSignal& sig)
+{
+    const float* const* cols = fFloatCols[side];
+
+    sig.fPE        = cols[0][row];
+    sig.fCharge    = cols[1][row];
+    sig.fAmp       = cols[2][row];
+    sig.fT0        = cols[3][row];
+    sig.fTOT       = cols[4][row];
+    sig.fBL        = cols[5][row];
+    sig.fBLsig     = cols[6][row];
+    sig.fPileUp    = fPileUpCol[side][row];
+    sig.fVeto      = fVetoCol[side][row];
+    sig.fSDDSignal = true;
+}
+//------------------------------------------------------------------
+/// Prints details of the SFEventCache class object.
+void SFEventCache::Print(void)
+{
+    std::cout << "\n-------------------------------------------" << std::endl;
+    std::cout << "This is print out of SFEventCache class object" << std::endl;
+    std::cout << "Directory: " << fDirectory << std::endl;
+    std::cout << "Cache file: " << fFileName << std::endl;
+    std::cout << "Number of rows: " << fNrows << std::endl;
+    std::cout << "Memory-mapped: " << (IsMapped() ? "yes" : "no") << std::endl;
+    std::cout << "-------------------------------------------\n" << std::endl;
+}
+//------------------------------------------------------------------
@@ -0,0 +1,229 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *            SFFilePool.cc              *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#include "SFFilePool.hh"
+
+#include <TDirectory.h>
+
+#include <cstdlib>
+#include <list>
+#include <map>
+#include <mutex>
+#include <vector>
+
+ClassImp(SFFilePool);
+
+/// Opened file and the number of its current users.
+struct PooledFile
+{
+    TString fName;      ///< Name of the file
+    TFile*  fFile;      ///< Opened file
+    int     fUsers = 0; ///< Number of Acquire() calls not followed by Release()
+};
+
+/// Opened files, the most recently used first.
+static std::list<PooledFile> gFiles;
+/// Positions of the opened files in gFiles, accessed by file name. The same
+/// file can be opened more than once, if it is used by many threads.
+static std::multimap<TString, std::list<PooledFile>::iterator> gFilesIndex;
+/// Mutex protecting gFiles and gFilesIndex.
+static std::mutex gFilesMutex;
+/// Maximal number of files kept open.
+static int gCapacity = 16;
+/// Flag indicating whether CloseAll() has been registered to be called at exit.
+static bool gCloseRegistered = false;
+
+//------------------------------------------------------------------
+/// Closes the given file and removes it from the pool. Returns position of
+/// the next file in gFiles. Has to be called with gFilesMutex locked.
+/// \param it - position of the file in gFiles
+static std::list<PooledFile>::iterator Close(std::list<PooledFile>::iterator it)
+{
+    auto range = gFilesIndex.equal_range(it->fName);
+
+    for (auto idx = range.first; idx != range.second; ++idx)
+    {
+        if (idx->second == it)
+        {
+            gFilesIndex.erase(idx);
+            break;
+        }
+    }
+
+    delete it->fFile;
+
+    return gFiles.erase(it);
+}
+//------------------------------------------------------------------
+/// Closes the least recently used files which are not in use, until the
+/// number of opened files doesn't exceed the capacity of the pool. Has to
+/// be called with gFilesMutex locked.
+static void Trim(void)
+{
+    auto it = gFiles.end();
+
+    while ((int)gFiles.size() > gCapacity && it != gFiles.begin())
+    {
+        --it;
+
+        if (it->fUsers > 0) continue;
+
+        it = Close(it);
+    }
+}
+//------------------------------------------------------------------
+/// Returns opened file of the given name. The file is opened at the first
+/// call and reused by the subsequent ones. Returned file is in use until
+/// Release() is called and it is neither closed nor returned to other
+/// callers before, so that it can be read without locking. If the file is
+/// already in use, it is opened once more. If the file can't be opened,
+/// nullptr is returned.
+/// \param fname - name of the ROOT file
+TFile* SFFilePool::Acquire(TString fname)
+{
+    std::lock_guard<std::mutex> lock(gFilesMutex);
+
+    auto range = gFilesIndex.equal_range(fname);
+
+    for (auto idx = range.first; idx != range.second; ++idx)
+    {
+        if (idx->second->fUsers > 0) continue;
+
+        gFiles.splice(gFiles.begin(), gFiles, idx->second);
+        idx->second->fUsers++;
+        return idx->second->fFile;
+    }
+
+    if (!gCloseRegistered)
+    {
+        std::atexit(CloseAll);
+        gCloseRegistered = true;
+    }
+
+    TFile* file = nullptr;
+
+    {
+        // TFile constructor changes the current directory
+        TDirectory::TContext context;
+        file = new TFile(fname, "READ");
+    }
+
+    if (!file->IsOpen() || file->IsZombie())
+    {
+        std::cerr << "##### Error in SFFilePool::Acquire()!" << std::endl;
+        std::cerr << "Couldn't open: " << fname << std::endl;
+        delete file;
+        return nullptr;
+    }
+
+    PooledFile pooled;
+    pooled.fName  = fname;
+    pooled.fFile  = file;
+    pooled.fUsers = 1;
+
+    gFiles.push_front(pooled);
+    gFilesIndex.emplace(fname, gFiles.begin());
+
+    Trim();
+
+    return file;
+}
+//------------------------------------------------------------------
+/// Marks file returned by Acquire() as no longer used by the caller. The
+/// file stays open until it is closed to keep the number of opened files
+/// within the capacity of the pool. Objects read from the file mustn't be
+/// used after this call.
+/// \param file - file returned by Acquire()
+void SFFilePool::Release(TFile* file)
+{
+    if (file == nullptr) return;
+
+    std::lock_guard<std::mutex> lock(gFilesMutex);
+
+    for (auto& pooled : gFiles)
+    {
+        if (pooled.fFile == file)
+        {
+            if (pooled.fUsers > 0) pooled.fUsers--;
+            break;
+        }
+    }
+
+    Trim();
+}
+//------------------------------------------------------------------
+/// Closes the given file if it is opened and not in use.
+/// \param fname - name of the ROOT file
+void SFFilePool::Evict(TString fname)
+{
+    std::lock_guard<std::mutex> lock(gFilesMutex);
+
+    std::vector<std::list<PooledFile>::iterator> unused;
+    auto range = gFilesIndex.equal_range(fname);
+
+    for (auto idx = range.first; idx != range.second; ++idx)
+    {
+        if (idx->second->fUsers == 0) unused.push_back(idx->second);
+    }
+
+    for (auto it : unused)
+        Close(it);
+}
+//------------------------------------------------------------------
+/// Closes all opened files. Called automatically at the end of the program.
+void SFFilePool::CloseAll(void)
+{
+    std::lock_guard<std::mutex> lock(gFilesMutex);
+
+    for (auto& pooled : gFiles)
+    {
+        if (pooled.fUsers > 0)
+            std::cout << "##### Warning in SFFilePool::CloseAll()! Closing file in use: "
+                      << pooled.fName << std::endl;
+        delete pooled.fFile;
+    }
+
+    gFiles.clear();
+    gFilesIndex.clear();
+}
+//------------------------------------------------------------------
+/// Sets maximal number of files kept open. Files in use are never closed,
+/// so the limit can be temporarily exceeded, e.g. when many measurements
+/// are processed in parallel.
+/// \param capacity - maximal number of opened files
+void SFFilePool::SetCapacity(int capacity)
+{
+    if (capacity < 1)
+    {
+        std::cout << "##### Warning in SFFilePool::SetCapacity()! Incorrect capacity: "
+                  << capacity << ". Using 1." << std::endl;
+        capacity = 1;
+    }
+
+    std::lock_guard<std::mutex> lock(gFilesMutex);
+
+    gCapacity = capacity;
+    Trim();
+}
+//------------------------------------------------------------------
+/// Returns maximal number of files kept open.
+int SFFilePool::GetCapacity(void)
+{
+    std::lock_guard<std::mutex> lock(gFilesMutex);
+    return gCapacity;
+}
+//------------------------------------------------------------------
+/// Returns number of currently opened files.
+int SFFilePool::GetNOpened(void)
+{
+    std::lock_guard<std::mutex> lock(gFilesMutex);
+    return gFiles.size();
+}
+//------------------------------------------------------------------
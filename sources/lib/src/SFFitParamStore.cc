@@ -0,0 +1,205 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *          SFFitParamStore.cc           *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#include "SFFitParamStore.hh"
+#include "SFSeriesContext.hh"
+
+#include <cstdlib>
+#include <mutex>
+
+ClassImp(SFFitParamStore);
+
+/// Stores which have already been created, accessed by series number.
+static std::map<int, SFFitParamStore*> gStores;
+/// Fit parameters, accessed by directory containing fitconfig.txt and fitparams.out.
+static std::map<TString, FitterFactory*> gFactories;
+/// Directories with updated fit parameters, which have not been written yet.
+static std::set<TString> gModified;
+/// Flag indicating whether Flush() has been registered to be called at exit.
+static bool gFlushRegistered = false;
+/// Mutex protecting all maps of the store, since peak finders are used
+/// from many threads.
+static std::recursive_mutex gStoreMutex;
+
+/// Writes all updated fit parameters at the end of the program.
+static void FlushAtExit(void)
+{
+    SFFitParamStore::Flush();
+}
+//------------------------------------------------------------------
+/// Standard constructor. Reads details of the experimental series.
+/// Usually SFFitParamStore::GetStore() should be used instead.
+/// \param seriesNo - number of the experimental series.
+SFFitParamStore::SFFitParamStore(int seriesNo) : fSeriesNo(seriesNo),
+                                                 fDesc(""),
+                                                 fCollimator("")
+{
+    SFSeriesContext* context = nullptr;
+
+    try
+    {
+        context = SFSeriesContext::Acquire(fSeriesNo);
+    }
+    catch (const char* message)
+    {
+        std::cerr << message << std::endl;
+        throw "##### Exception in SFFitParamStore constructor!";
+    }
+
+    SFData* data = context->GetData();
+
+    fNames      = data->GetNames();
+    fMeasureID  = data->GetMeasurementsIDs();
+    fPositions  = data->GetPositions();
+    fDesc       = data->GetDescription();
+    fCollimator = data->GetCollimator();
+
+    context->Release();
+}
+//------------------------------------------------------------------
+/// Default destructor.
+SFFitParamStore::~SFFitParamStore()
+{
+}
+//------------------------------------------------------------------
+/// Returns store of the requested series. The store is created at the
+/// first call and kept until the end of the program.
+/// \param seriesNo - number of the experimental series.
+SFFitParamStore* SFFitParamStore::GetStore(int seriesNo)
+{
+    std::lock_guard<std::recursive_mutex> lock(gStoreMutex);
+
+    auto it = gStores.find(seriesNo);
+    if (it != gStores.end()) return it->second;
+
+    SFFitParamStore* store = nullptr;
+
+    try
+    {
+        store = new SFFitParamStore(seriesNo);
+    }
+    catch (const char* message)
+    {
+        std::cerr << message << std::endl;
+        std::cerr << "##### Error in SFFitParamStore::GetStore()!" << std::endl;
+        std::abort();
+    }
+
+    gStores[seriesNo] = store;
+
+    return store;
+}
+//------------------------------------------------------------------
+/// Returns fit parameters stored in the given directory. At the first
+/// call FitterFactory is initialized from fitconfig.txt and fitparams.out,
+/// subsequent calls return the same object.
+/// \param path - directory containing fitting configuration
+FitterFactory* SFFitParamStore::GetFactory(TString path)
+{
+    std::lock_guard<std::recursive_mutex> lock(gStoreMutex);
+
+    auto it = gFactories.find(path);
+    if (it != gFactories.end()) return it->second;
+
+    if (!gFlushRegistered)
+    {
+        std::atexit(FlushAtExit);
+        gFlushRegistered = true;
+    }
+
+    FitterFactory* fitter = new FitterFactory();
+    fitter->initFactoryFromFile((path + "/fitconfig.txt").Data(),
+                                (path + "/fitparams.out").Data());
+    gFactories[path] = fitter;
+
+    return fitter;
+}
+//------------------------------------------------------------------
+/// Marks fit parameters of the given directory as updated. They will
+/// be written to fitparams.out with Flush().
+/// \param path - directory containing fitting configuration
+void SFFitParamStore::SetModified(TString path)
+{
+    std::lock_guard<std::recursive_mutex> lock(gStoreMutex);
+    gModified.insert(path);
+}
+//------------------------------------------------------------------
+/// Writes updated fit parameters of the given directory to fitparams.out.
+/// \param path - directory containing fitting configuration
+bool SFFitParamStore::Flush(TString path)
+{
+    std::lock_guard<std::recursive_mutex> lock(gStoreMutex);
+
+    if (gModified.find(path) == gModified.end()) return true;
+
+    auto it = gFactories.find(path);
+
+    if (it == gFactories.end())
+    {
+        std::cerr << "##### Error in SFFitParamStore::Flush()! Fit parameters of " << path
+                  << " not loaded!" << std::endl;
+        gModified.erase(path);
+        return false;
+    }
+
+    it->second->exportFactoryToFile();
+    gModified.erase(path);
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Writes all updated fit parameters to the corresponding fitparams.out files.
+bool SFFitParamStore::Flush(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(gStoreMutex);
+
+    bool stat = true;
+
+    std::set<TString> modified = gModified;
+
+    for (auto& path : modified)
+        stat = Flush(path) && stat;
+
+    return stat;
+}
+//------------------------------------------------------------------
+/// Writes updated fit parameters of the given directory and removes them
+/// from the store, so that they are read from the files again at the next
+/// GetFactory() call. Should be used if the files have been modified.
+/// \param path - directory containing fitting configuration
+void SFFitParamStore::Drop(TString path)
+{
+    std::lock_guard<std::recursive_mutex> lock(gStoreMutex);
+
+    Flush(path);
+
+    auto it = gFactories.find(path);
+    if (it == gFactories.end()) return;
+
+    delete it->second;
+    gFactories.erase(it);
+}
+//------------------------------------------------------------------
+/// Prints details of the SFFitParamStore class object.
+void SFFitParamStore::Print(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(gStoreMutex);
+
+    std::cout << "\n-------------------------------------------" << std::endl;
+    std::cout << "This is print out of SFFitParamStore class object" << std::endl;
+    std::cout << "Experimental series number " << fSeriesNo << std::endl;
+    std::cout << "Description: " << fDesc << std::endl;
+    std::cout << "Collimator: " << fCollimator << std::endl;
+    std::cout << "Number of measurements: " << fNames.size() << std::endl;
+    std::cout << "Number of loaded fit configurations: " << gFactories.size() << std::endl;
+    std::cout << "Number of modified fit configurations: " << gModified.size() << std::endl;
+    std::cout << "-------------------------------------------\n" << std::endl;
+}
+//------------------------------------------------------------------
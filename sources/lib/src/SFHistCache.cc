@@ -0,0 +1,255 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *           SFHistCache.cc              *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#include "SFHistCache.hh"
+
+#include <TDirectory.h>
+#include <TFile.h>
+#include <TNamed.h>
+#include <TSystem.h>
+
+#include <cstdlib>
+#include <mutex>
+
+ClassImp(SFHistCache);
+
+/// Flag indicating whether histograms are read from and written to the cache.
+static bool gEnabled = true;
+/// Directory containing cached histograms. Empty means $SFDATA/HistCache.
+static TString gCachePath = "";
+/// Mutex protecting the cache settings and the cache directory.
+static std::mutex gCacheMutex;
+
+//------------------------------------------------------------------
+/// Returns 64-bit FNV-1a hash of the given string as a hexadecimal string.
+/// Unlike TString::Hash() it is the same on all platforms and in all ROOT
+/// versions, so that the cache can be shared.
+/// \param text - hashed string
+static TString Hash(TString text)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+
+    for (int i = 0; i < text.Length(); i++)
+    {
+        hash ^= (unsigned char)text[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return Form("%016llx", hash);
+}
+//------------------------------------------------------------------
+/// Returns directory containing cached histograms. Has to be called with
+/// gCacheMutex locked.
+static TString CachePath(void)
+{
+    if (gCachePath != "") return gCachePath;
+
+    const char* data = getenv("SFDATA");
+    return TString(data == nullptr ? "." : data) + "/HistCache";
+}
+//------------------------------------------------------------------
+/// Returns directory containing histograms drawn from the given data file.
+/// Has to be called with gCacheMutex locked.
+/// \param dataFile - name of the data file
+static TString EntryDirectory(TString dataFile)
+{
+    return CachePath() + "/" + Hash(dataFile);
+}
+//------------------------------------------------------------------
+/// Returns full key of the histogram, containing name, size and modification
+/// time of the data file. Returns empty string if the data file doesn't exist.
+/// \param dataFile - name of the data file
+/// \param key - key of the histogram
+static TString FullKey(TString dataFile, TString key)
+{
+    FileStat_t stat;
+    if (gSystem->GetPathInfo(dataFile, stat) != 0) return "";
+
+    return Form("%s|%lld|%ld|", dataFile.Data(), stat.fSize, stat.fMtime) + key;
+}
+//------------------------------------------------------------------
+/// Removes all files from the given directory and its subdirectories, and
+/// the directory itself.
+/// \param dir - removed directory
+static bool RemoveDirectory(TString dir)
+{
+    void* dirp = gSystem->OpenDirectory(dir);
+    if (dirp == nullptr) return true;
+
+    bool        stat  = true;
+    const char* entry = nullptr;
+
+    while ((entry = gSystem->GetDirEntry(dirp)) != nullptr)
+    {
+        TString name = entry;
+        if (name == "." || name == "..") continue;
+
+        TString    path = dir + "/" + name;
+        FileStat_t info;
+
+        if (gSystem->GetPathInfo(path, info) == 0 && R_ISDIR(info.fMode))
+            stat = RemoveDirectory(path) && stat;
+        else
+            stat = (gSystem->Unlink(path) == 0) && stat;
+    }
+
+    gSystem->FreeDirectory(dirp);
+
+    return (gSystem->Unlink(dir) == 0) && stat;
+}
+//------------------------------------------------------------------
+/// Returns cached histogram drawn from the given data file, or nullptr if it
+/// is not in the cache. Like newly created histograms, returned TH1 belongs
+/// to the current directory. Returned histogram is owned by the caller.
+/// \param dataFile - name of the data file
+/// \param key - key of the histogram, e.g. selection and cut
+TObject* SFHistCache::Get(TString dataFile, TString key)
+{
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+
+    if (!gEnabled) return nullptr;
+
+    TString fullKey = FullKey(dataFile, key);
+    if (fullKey == "") return nullptr;
+
+    TString path = EntryDirectory(dataFile) + "/" + Hash(fullKey) + ".root";
+    if (gSystem->AccessPathName(path)) return nullptr;
+
+    TDirectory* dir  = gDirectory;
+    TFile*      file = nullptr;
+    TObject*    hist = nullptr;
+
+    {
+        // TFile constructor changes the current directory
+        TDirectory::TContext context;
+        file = new TFile(path, "READ");
+    }
+
+    if (file->IsOpen() && !file->IsZombie())
+    {
+        TNamed* stored = (TNamed*)file->Get("key");
+
+        if (stored != nullptr && fullKey == stored->GetTitle())
+        {
+            hist = file->Get("hist");
+            if (hist != nullptr && hist->InheritsFrom(TH1::Class()))
+                ((TH1*)hist)->SetDirectory(TH1::AddDirectoryStatus() ? dir : nullptr);
+        }
+
+        delete stored;
+    }
+
+    delete file;
+
+    return hist;
+}
+//------------------------------------------------------------------
+/// Writes histogram drawn from the given data file to the cache. The
+/// histogram itself is not modified.
+/// \param dataFile - name of the data file
+/// \param key - key of the histogram, e.g. selection and cut
+/// \param hist - cached histogram
+bool SFHistCache::Put(TString dataFile, TString key, TObject* hist)
+{
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+
+    if (!gEnabled || hist == nullptr) return false;
+
+    TString fullKey = FullKey(dataFile, key);
+    if (fullKey == "") return false;
+
+    TString dir = EntryDirectory(dataFile);
+
+    if (gSystem->AccessPathName(dir) && gSystem->mkdir(dir, true) != 0)
+    {
+        std::cout << "##### Warning in SFHistCache::Put()! Could not create directory " << dir
+                  << ". Histogram cache disabled." << std::endl;
+        gEnabled = false;
+        return false;
+    }
+
+    TString path = dir + "/" + Hash(fullKey) + ".root";
+    TString temp = path + Form(".%i.tmp", gSystem->GetPid());
+    bool    stat = false;
+
+    {
+        // TFile constructor changes the current directory
+        TDirectory::TContext context;
+        TFile file(temp, "RECREATE");
+
+        if (file.IsOpen() && !file.IsZombie())
+        {
+            TNamed stored("key", fullKey);
+            stat = stored.Write("key") > 0 && hist->Write("hist") > 0;
+            file.Close();
+        }
+    }
+
+    if (!stat || gSystem->Rename(temp, path) != 0)
+    {
+        std::cout << "##### Warning in SFHistCache::Put()! Could not write " << path
+                  << std::endl;
+        gSystem->Unlink(temp);
+        return false;
+    }
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Removes cached histograms drawn from the given data file. If no data
+/// file is given, the whole cache is removed.
+/// \param dataFile - name of the data file
+bool SFHistCache::Invalidate(TString dataFile)
+{
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+
+    TString dir = dataFile == "" ? CachePath() : EntryDirectory(dataFile);
+
+    if (!RemoveDirectory(dir))
+    {
+        std::cerr << "##### Error in SFHistCache::Invalidate()! Could not remove " << dir
+                  << std::endl;
+        return false;
+    }
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Enables or disables the cache. If the cache is disabled histograms are
+/// neither read from nor written to it.
+/// \param enabled - flag enabling the cache
+void SFHistCache::SetEnabled(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+    gEnabled = enabled;
+}
+//------------------------------------------------------------------
+/// Returns true if the cache is enabled.
+bool SFHistCache::IsEnabled(void)
+{
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+    return gEnabled;
+}
+//------------------------------------------------------------------
+/// Sets directory containing cached histograms.
+/// \param path - cache directory
+void SFHistCache::SetPath(TString path)
+{
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+    gCachePath = path;
+}
+//------------------------------------------------------------------
+/// Returns directory containing cached histograms.
+TString SFHistCache::GetPath(void)
+{
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+    return CachePath();
+}
+//------------------------------------------------------------------
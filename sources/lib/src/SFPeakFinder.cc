@@ -12,6 +12,9 @@
 
 ClassImp(SFPeakFinder);
 
+/// Method of the 511 keV peak fit used by newly created peak finders.
+static SFPeakFitMode gDefaultFitMode = SFPeakFitMode::kFormula;
+
 //------------------------------------------------------------------
 /// Default constructor.
 SFPeakFinder::SFPeakFinder() : fSpectrum(nullptr),
@@ -20,7 +23,8 @@ SFPeakFinder::SFPeakFinder() : fSpectrum(nullptr),
                                fID(-1),
                                fVerbose(false),
                                fTests(false),
-                               fResults(new SFResults("PeakFinderResults_tmp"))
+                               fResults(new SFResults("PeakFinderResults_tmp")),
+                               fFitMode(gDefaultFitMode)
 {
     std::cout << "#### Warning in SFPeakFinder constructor!" << std::endl;
     std::cout << "You are using default constructor!" << std::endl;
@@ -37,7 +41,8 @@ SFPeakFinder::SFPeakFinder(TH1D* spectrum, bool verbose, bool tests) : fSpectrum
                                                                        fID(-1),
                                                                        fVerbose(verbose),
                                                                        fTests(tests),
-                                                                       fResults(new SFResults("PeakFinderResults_tmp"))
+                                                                       fResults(new SFResults("PeakFinderResults_tmp")),
+                                                                       fFitMode(gDefaultFitMode)
 {
 }
 //------------------------------------------------------------------
@@ -48,7 +53,8 @@ SFPeakFinder::SFPeakFinder(TH1D* spectrum, int ID, bool verbose, bool tests) : f
                                                                                fID(ID),
                                                                                fVerbose(verbose),
                                                                                fTests(tests),
-                                                                               fResults(new SFResults("PeakFinderResults_tmp"))
+                                                                               fResults(new SFResults("PeakFinderResults_tmp")),
+                                                                               fFitMode(gDefaultFitMode)
 {
 }
 //------------------------------------------------------------------
@@ -61,7 +67,8 @@ SFPeakFinder::SFPeakFinder(TH1D* spectrum, bool verbose) : fSpectrum(spectrum),
                                                            fID(-1),
                                                            fVerbose(verbose),
                                                            fTests(false),
-                                                           fResults(new SFResults("PeakFinderResults_tmp"))
+                                                           fResults(new SFResults("PeakFinderResults_tmp")),
+                                                           fFitMode(gDefaultFitMode)
 {
 }
 //------------------------------------------------------------------
@@ -74,7 +81,8 @@ SFPeakFinder::SFPeakFinder(TH1D* spectrum) : fSpectrum(spectrum),
                                              fID(-1),
                                              fVerbose(false),
                                              fTests(false),
-                                             fResults(new SFResults("PeakFinderResults_tmp"))
+                                             fResults(new SFResults("PeakFinderResults_tmp")),
+                                             fFitMode(gDefaultFitMode)
 {
     std::cout << "##### Warning in SFPeakFinder constructor. Quiet mode on, no print outs."
               << std::endl;
@@ -106,20 +114,11 @@ TString SFPeakFinder::InitSpectrumPerPosition(int seriesNo)
     if (fID == -1)
         fID = SFTools::GetMeasurementID(fSpectrum->GetName());
     
-    SFData* data;
-    try
-    {
-        data = new SFData(seriesNo);
-    }
-    catch (const char* message)
-    {
-        std::cerr << message << std::endl;
-        std::cerr << "##### Error in SFPeakFinder::Init()!" << std::endl;
-    }
+    SFFitParamStore* store = SFFitParamStore::GetStore(seriesNo);
     
-    std::vector<TString> names     = data->GetNames();
-    std::vector<int>     measureID = data->GetMeasurementsIDs();
-    std::vector<double>  positions = data->GetPositions();
+    std::vector<TString> names     = store->GetNames();
+    std::vector<int>     measureID = store->GetMeasurementsIDs();
+    std::vector<double>  positions = store->GetPositions();
     int                  index     = SFTools::GetIndex(measureID, fID);
     TString              dir_name  = names[index];
     TString              full_path = SFTools::FindData(dir_name);
@@ -180,7 +179,7 @@ TString SFPeakFinder::InitSpectrumPerPosition(int seriesNo)
                    << par2_max << " " << par3 << " " << par4 << " " << par5 << " " << par6 << "\n";
         }
         
-        TString desc = data->GetDescription();
+        TString desc = store->GetDescription();
         
         if(desc.Contains("Regular series"))
         {
@@ -218,32 +217,14 @@ TString SFPeakFinder::InitSpectrumPerSeries(int seriesNo)
     TString data_path = std::getenv("SFDATA"); 
     TString full_path = std::string(data_path) + "DB/"; 
     
-    std::fstream params(full_path + "fitparams.out", std::ios::in);
-    
-    std::string line;
-    bool flag = false;
-    
-    while (params.good())
-    {
-        getline(params, line);
-        TString tstr = line;
-        
-        if (tstr.Contains(Form("S%i_hEnergyRecoAll", seriesNo)))
-        {
-            flag = true;
-            params.close();
-            break;
-        }
-        else
-        {
-            flag = false;
-        }
-    }
-    
-    params.close();
+    FitterFactory* fitter = SFFitParamStore::GetFactory(full_path);
+    bool           flag   = fitter->findParams(Form("S%i_hEnergyRecoAllExp", seriesNo)) != nullptr;
     
     if (!flag)
     {
+        // updated parameters need to be written before the file is extended
+        SFFitParamStore::Flush(full_path);
+        
         std::fstream params(full_path + "fitparams.out", std::ios::app);
         
         TString functions = "gaus(0) pol0(3)+[4]*TMath::Exp((x-[5])*[6])";
@@ -268,6 +249,9 @@ TString SFPeakFinder::InitSpectrumPerSeries(int seriesNo)
             << par2_max << " " << par3 << " " << par4 << " " << par5 << " " << par6 << "\n";
         }
         params.close();
+        
+        // fit parameters are read again with the new entries at the next use
+        SFFitParamStore::Drop(full_path);
     }
     
     return full_path;
@@ -311,21 +295,7 @@ bool SFPeakFinder::FindPeakRange(double& min, double& max)
 
     // Getting series attributes
     int     seriesNo = SFTools::GetSeriesNo(fSpectrum->GetName());
-    SFData* data;
-
-    try
-    {
-        data = new SFData(seriesNo);
-    }
-    catch (const char* message)
-    {
-        std::cerr << message << std::endl;
-        std::cerr << "##### Exception in SFPeakFinder::FindPeakRange()!" << std::endl;
-        std::abort();
-    }
-
-    TString type = data->GetCollimator();
-    delete data;
+    TString type     = SFFitParamStore::GetStore(seriesNo)->GetCollimator();
 
     // Calculating peak range
     const double delta = 1E-8;
@@ -381,33 +351,38 @@ bool SFPeakFinder::FindPeakFit(void)
     
     fSpectrum->Print();
     
-    FitterFactory fitter;
-    fitter.initFactoryFromFile((data_path + "/fitconfig.txt").Data(),
-                               (data_path + "/fitparams.out").Data());
-    HistogramFitParams *histFP = fitter.findParams(fSpectrum->GetName());
+    FitterFactory* fitter = SFFitParamStore::GetFactory(data_path);
+    HistogramFitParams *histFP = fitter->findParams(fSpectrum->GetName());
+    double chi2NDF = -1;
+
+    if (fFitMode != SFPeakFitMode::kCompiled ||
+        !FindPeakFitCompiled(fitter, histFP, chi2NDF))
+    {
 //     printf("fl = %d for %s\n", fl, fSpectrum->GetName());
-    auto res = fitter.fit(histFP, fSpectrum);
-    printf("fit result res = %d\n", res);
+        auto res = fitter->fit(histFP, fSpectrum);
+        printf("fit result res = %d\n", res);
 //     fitter.updateParams(fSpectrum, histFP);
-    fitter.exportFactoryToFile();
-    fFittedFun = (TF1*)histFP->function_sum.Clone();
+        fFittedFun = (TF1*)histFP->function_sum.Clone();
 
-    if (fFittedFun == nullptr)
-    {
-        std::cerr << "##### Error in SFPeakFinder::FindPeak()! Function is null pointer"
-                  << std::endl;
-        std::abort();
-    }
+        if (fFittedFun == nullptr)
+        {
+            std::cerr << "##### Error in SFPeakFinder::FindPeak()! Function is null pointer"
+                      << std::endl;
+            std::abort();
+        }
 
-    TF1 *tmpfun = fSpectrum->GetFunction(fFittedFun->GetName());
+        TF1 *tmpfun = fSpectrum->GetFunction(fFittedFun->GetName());
 
-    if (!tmpfun) {
-        std::cerr << "##### Error in SFPeakFinder::FindPeak()! tmpfun is null pointer"
-                  << std::endl;
-        std::abort();
+        if (!tmpfun) {
+            std::cerr << "##### Error in SFPeakFinder::FindPeak()! tmpfun is null pointer"
+                      << std::endl;
+            std::abort();
+        }
+
+        chi2NDF = tmpfun->GetChisquare() / tmpfun->GetNDF();
     }
 
-    double chi2NDF = tmpfun->GetChisquare() / tmpfun->GetNDF();
+    SFFitParamStore::SetModified(data_path);
     
     fResults->AddResult(SFResultTypeNum::kPeakConst, fFittedFun->GetParameter(0),
                         fFittedFun->GetParError(0));
@@ -485,6 +460,94 @@ bool SFPeakFinder::FindPeakFit(void)
     return true;
 }
 //------------------------------------------------------------------
+/// Fits 511 keV peak with the compiled function (see SFPeakFitter). Initial
+/// parameters, limits and fitting range are taken from the FitterFactory
+/// configuration, and fitted parameters are written back to it, like after
+/// FitterFactory::fit(). Fitted function is stored with the spectrum, like
+/// after TH1::Fit(). Returns false if configured function can't be fitted
+/// this way, e.g. if it has different number of parameters, or if the
+/// fit fails or doesn't converge.
+/// \param fitter - fitting configuration
+/// \param histFP - fitting configuration of the analyzed spectrum
+/// \param chi2NDF - reduced chi2 of the fit
+bool SFPeakFinder::FindPeakFitCompiled(FitterFactory* fitter, HistogramFitParams* histFP,
+                                       double& chi2NDF)
+{
+
+    TF1*            fun = (TF1*)histFP->function_sum.Clone();
+    SFPeakFitResult fit;
+
+    try
+    {
+        SFPeakFitter peakFitter(fun);
+        fit = peakFitter.Fit(fSpectrum);
+    }
+    catch (const char* message)
+    {
+        std::cout << message << std::endl;
+        std::cout << "##### Warning in SFPeakFinder::FindPeakFitCompiled()! "
+                  << "Using fit of the formula instead." << std::endl;
+        delete fun;
+        return false;
+    }
+
+    if (fVerbose)
+        std::cout << "Compiled fit of " << fSpectrum->GetName() << ", status: " << fit.fStat
+                  << std::endl;
+
+    // fit of the formula is used if the spectrum couldn't be fitted, e.g. it
+    // has too few points, or if the fit didn't converge, so that parameters
+    // written back to the configuration are never worse than before
+    if (fit.fParameters.empty() || fit.fStat != 0)
+    {
+        std::cout << "##### Warning in SFPeakFinder::FindPeakFitCompiled()! Spectrum "
+                  << fSpectrum->GetName() << " not fitted (status " << fit.fStat << "). "
+                  << "Using fit of the formula instead." << std::endl;
+        delete fun;
+        return false;
+    }
+
+    for (int i = 0; i < SFPeakFitter::kNpar; i++)
+    {
+        fun->SetParameter(i, fit.fParameters[i]);
+        fun->SetParError(i, fit.fParErrors[i]);
+    }
+
+    fun->SetChisquare(fit.fChi2);
+    fun->SetNDF(fit.fNDF);
+    fun->SetNumberFitPoints(fit.fNpoints);
+
+    TObject* old = fSpectrum->GetListOfFunctions()->FindObject(fun->GetName());
+
+    if (old != nullptr)
+    {
+        fSpectrum->GetListOfFunctions()->Remove(old);
+        delete old;
+    }
+
+    fSpectrum->GetListOfFunctions()->Add(fun->Clone());
+    fitter->updateParams(fSpectrum, histFP);
+
+    fFittedFun = fun;
+    chi2NDF    = fit.fChi2 / fit.fNDF;
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Sets method of the 511 keV peak fit used by the peak finders created
+/// afterwards.
+/// \param mode - method of the fit
+void SFPeakFinder::SetDefaultFitMode(SFPeakFitMode mode)
+{
+    gDefaultFitMode = mode;
+}
+//------------------------------------------------------------------
+/// Returns method of the 511 keV peak fit used by newly created peak finders.
+SFPeakFitMode SFPeakFinder::GetDefaultFitMode(void)
+{
+    return gDefaultFitMode;
+}
+//------------------------------------------------------------------
 /// Finds 511 keV peak via SFPeakFinder::FindPeakFit() method and
 /// performs background subtraction. Exponential function is fitted on
 /// the left sige of the peak and pol0 function - on the right side. For
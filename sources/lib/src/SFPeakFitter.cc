@@ -0,0 +1,283 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *            SFPeakFitter.cc            *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#include "SFPeakFitter.hh"
+#include "SFTools.hh"
+
+#include <algorithm>
+#include <cmath>
+
+ClassImp(SFPeakFitter);
+
+//------------------------------------------------------------------
+/// Standard constructor. Reads initial parameters, their limits and the
+/// fitting range from the given function.
+/// \param fun - function gaus(0) pol0(3)+[4]*TMath::Exp((x-[5])*[6]) with
+/// set parameters and range
+/// \param maxIter - maximal number of iterations
+/// \param tolerance - relative change of chi2 at which the fit is converged
+SFPeakFitter::SFPeakFitter(TF1* fun, int maxIter, double tolerance) : fInit(kNpar, 0.),
+                                                                      fLower(kNpar, 0.),
+                                                                      fUpper(kNpar, 0.),
+                                                                      fFixed(kNpar, false),
+                                                                      fXmin(0),
+                                                                      fXmax(0),
+                                                                      fMaxIter(maxIter),
+                                                                      fTolerance(tolerance)
+{
+    if (fun == nullptr || fun->GetNpar() != kNpar)
+    {
+        std::cerr << "##### Error in SFPeakFitter constructor! Incorrect function!" << std::endl;
+        throw "##### Exception in SFPeakFitter constructor!";
+    }
+
+    fun->GetRange(fXmin, fXmax);
+
+    for (int p = 0; p < kNpar; p++)
+    {
+        fInit[p] = fun->GetParameter(p);
+        fun->GetParLimits(p, fLower[p], fUpper[p]);
+        // convention of TF1::FixParameter()
+        fFixed[p] = fLower[p] * fUpper[p] != 0 && fLower[p] >= fUpper[p];
+    }
+}
+//------------------------------------------------------------------
+/// Default destructor.
+SFPeakFitter::~SFPeakFitter()
+{
+}
+//------------------------------------------------------------------
+/// Evaluates fitted function for n points.
+/// \param x - arguments
+/// \param y - calculated values
+/// \param n - number of points
+/// \param par - parameters of the function
+void SFPeakFitter::Eval(const double* x, double* y, int n, const double* par)
+{
+    const double inv = 1. / par[2];
+
+    for (int i = 0; i < n; i++)
+    {
+        double u = (x[i] - par[1]) * inv;
+        y[i]     = par[0] * exp(-0.5 * u * u) + par[3] + par[4] * exp((x[i] - par[5]) * par[6]);
+    }
+}
+//------------------------------------------------------------------
+/// Calculates derivatives of the fitted function over all parameters for
+/// n points. Derivative over parameter p at point i is stored in
+/// deriv[p * n + i].
+/// \param x - arguments
+/// \param deriv - calculated derivatives, kNpar * n values
+/// \param n - number of points
+/// \param par - parameters of the function
+void SFPeakFitter::Derivatives(const double* x, double* deriv, int n, const double* par)
+{
+    const double inv = 1. / par[2];
+
+    for (int i = 0; i < n; i++)
+    {
+        double u     = (x[i] - par[1]) * inv;
+        double gaus  = exp(-0.5 * u * u);
+        double expo  = exp((x[i] - par[5]) * par[6]);
+        double dgaus = par[0] * gaus * u * inv;
+
+        deriv[0 * n + i] = gaus;
+        deriv[1 * n + i] = dgaus;
+        deriv[2 * n + i] = dgaus * u;
+        deriv[3 * n + i] = 1.;
+        deriv[4 * n + i] = expo;
+        deriv[5 * n + i] = -par[4] * par[6] * expo;
+        deriv[6 * n + i] = par[4] * (x[i] - par[5]) * expo;
+    }
+}
+//------------------------------------------------------------------
+/// Fits the function to the given spectrum with chi2 method. Only bins with
+/// centers within the fitting range are used and empty bins are skipped,
+/// like in ROOT chi2 fits. Number of degrees of freedom is calculated with
+/// all parameters which are not fixed in the function, like in TF1.
+/// \param spectrum - fitted spectrum
+SFPeakFitResult SFPeakFitter::Fit(TH1D* spectrum) const
+{
+    SFPeakFitResult result;
+
+    //----- bins within the fitting range
+    std::vector<double> x, y, w;
+
+    for (int bin = 1; bin <= spectrum->GetNbinsX(); bin++)
+    {
+        double center = spectrum->GetBinCenter(bin);
+        double err    = spectrum->GetBinError(bin);
+
+        if (center < fXmin || center > fXmax || err <= 0) continue;
+
+        x.push_back(center);
+        y.push_back(spectrum->GetBinContent(bin));
+        w.push_back(1. / (err * err));
+    }
+
+    int n           = x.size();
+    result.fNpoints = n;
+
+    //----- fitted parameters; [5] is degenerate with [4]
+    std::vector<int> free;
+    int              nfreeFun = 0;
+
+    for (int p = 0; p < kNpar; p++)
+    {
+        if (fFixed[p]) continue;
+        nfreeFun++;
+        if (p != 5) free.push_back(p);
+    }
+
+    int nfree = free.size();
+
+    if (n <= nfreeFun)
+    {
+        std::cerr << "##### Error in SFPeakFitter::Fit()! Not enough points: " << n << std::endl;
+        return result;
+    }
+
+    std::vector<double> par = fInit;
+
+    for (int p = 0; p < kNpar; p++)
+        if (!fFixed[p] && fLower[p] < fUpper[p])
+            par[p] = std::min(std::max(par[p], fLower[p]), fUpper[p]);
+
+    std::vector<double> model(n);
+    std::vector<double> deriv(kNpar * n);
+
+    auto getChi2 = [&](const std::vector<double>& p) {
+        Eval(x.data(), model.data(), n, p.data());
+        double chi2 = 0;
+        for (int i = 0; i < n; i++)
+            chi2 += w[i] * (y[i] - model[i]) * (y[i] - model[i]);
+        return chi2;
+    };
+
+    //----- Levenberg-Marquardt iterations
+    std::vector<double> alpha(nfree * nfree);
+    std::vector<double> beta(nfree);
+
+    auto getCurvature = [&](const std::vector<double>& p) {
+        Eval(x.data(), model.data(), n, p.data());
+        Derivatives(x.data(), deriv.data(), n, p.data());
+        std::fill(alpha.begin(), alpha.end(), 0.);
+        std::fill(beta.begin(), beta.end(), 0.);
+
+        for (int a = 0; a < nfree; a++)
+        {
+            const double* da = &deriv[free[a] * n];
+
+            for (int i = 0; i < n; i++)
+                beta[a] += w[i] * da[i] * (y[i] - model[i]);
+
+            for (int b = 0; b <= a; b++)
+            {
+                const double* db  = &deriv[free[b] * n];
+                double        sum = 0;
+                for (int i = 0; i < n; i++)
+                    sum += w[i] * da[i] * db[i];
+                alpha[a * nfree + b] = sum;
+                alpha[b * nfree + a] = sum;
+            }
+        }
+    };
+
+    double chi2      = getChi2(par);
+    double lambda    = 1E-3;
+    bool   converged = false;
+
+    for (int iter = 0; iter < fMaxIter && !converged; iter++)
+    {
+        getCurvature(par);
+
+        bool improved = false;
+
+        while (!improved && lambda < 1E10)
+        {
+            std::vector<double> damped = alpha;
+            std::vector<double> step   = beta;
+
+            for (int a = 0; a < nfree; a++)
+                damped[a * nfree + a] *= 1. + lambda;
+
+            if (!SFTools::SolveLinear(damped, step, nfree))
+            {
+                lambda *= 10;
+                continue;
+            }
+
+            std::vector<double> trial = par;
+
+            for (int a = 0; a < nfree; a++)
+            {
+                int p = free[a];
+                trial[p] += step[a];
+                if (fLower[p] < fUpper[p])
+                    trial[p] = std::min(std::max(trial[p], fLower[p]), fUpper[p]);
+            }
+
+            double trialChi2 = getChi2(trial);
+
+            if (!std::isfinite(trialChi2) || trialChi2 > chi2)
+            {
+                lambda *= 10;
+                continue;
+            }
+
+            improved  = true;
+            converged = (chi2 - trialChi2) <= fTolerance * chi2;
+            par       = trial;
+            chi2      = trialChi2;
+            lambda    = std::max(lambda / 10, 1E-12);
+        }
+
+        // no step decreases chi2 anymore, i.e. minimum is reached
+        if (!improved) converged = true;
+    }
+
+    //----- uncertainties from the curvature of chi2
+    getCurvature(par);
+
+    std::vector<double> errors(kNpar, 0.);
+    bool                inverted = true;
+
+    for (int a = 0; a < nfree && inverted; a++)
+    {
+        std::vector<double> col(nfree, 0.);
+        col[a]   = 1.;
+        inverted = SFTools::SolveLinear(alpha, col, nfree) && col[a] > 0;
+        if (inverted) errors[free[a]] = sqrt(col[a]);
+    }
+
+    result.fParameters = par;
+    result.fParErrors  = errors;
+    result.fChi2       = chi2;
+    result.fNDF        = n - nfreeFun;
+    result.fStat       = (converged && inverted) ? 0 : (inverted ? 4 : 3);
+
+    return result;
+}
+//------------------------------------------------------------------
+/// Prints details of the SFPeakFitter class object.
+void SFPeakFitter::Print(void)
+{
+    std::cout << "\n-------------------------------------------" << std::endl;
+    std::cout << "This is print out of SFPeakFitter class object" << std::endl;
+    std::cout << "Fitting range: " << fXmin << " - " << fXmax << std::endl;
+    std::cout << "Initial parameters:";
+    for (int p = 0; p < kNpar; p++)
+        std::cout << " " << fInit[p] << (fFixed[p] ? " (fixed)" : "");
+    std::cout << std::endl;
+    std::cout << "Maximal number of iterations: " << fMaxIter << std::endl;
+    std::cout << "Tolerance: " << fTolerance << std::endl;
+    std::cout << "-------------------------------------------\n" << std::endl;
+}
+//------------------------------------------------------------------
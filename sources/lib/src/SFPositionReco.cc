@@ -14,6 +14,7 @@ const double ampMax = 660.;
 
 //------------------------------------------------------------------
 SFPositionReco::SFPositionReco(int seriesNo) : fSeriesNo(seriesNo), 
+                                               fContext(nullptr),
                                                fData(nullptr),
                                                fModel(nullptr),
                                                fMAttCh0CorrGraph(nullptr),
@@ -36,7 +37,7 @@ SFPositionReco::SFPositionReco(int seriesNo) : fSeriesNo(seriesNo),
 {
     try
     {
-       fData = new SFData(fSeriesNo);
+        fContext = SFSeriesContext::Acquire(fSeriesNo);
     }
     catch (const char* message)
     {
@@ -44,57 +45,73 @@ SFPositionReco::SFPositionReco(int seriesNo) : fSeriesNo(seriesNo),
         throw "##### Exception in SFPositionReco constructor!";
     }
 
+    if (!Init())
+    {
+        fContext->Release();
+        throw "##### Exception in SFPositionReco constructor!";
+    }
+}
+//------------------------------------------------------------------
+SFPositionReco::SFPositionReco(SFSeriesContext* context)
+    : fSeriesNo(context->GetSeriesNo()),
+      fContext(context),
+      fData(nullptr),
+      fModel(nullptr),
+      fMAttCh0CorrGraph(nullptr),
+      fMAttCh1CorrGraph(nullptr),
+      fMLRGraph(nullptr),
+      fMLRCorrGraph(nullptr),
+      fPosRecoGraph(nullptr),
+      fPosRecoCorrGraph(nullptr),
+      fPosResiduals(nullptr),
+      fPosResidualsCorr(nullptr),
+      fPosRecoDiff(nullptr),
+      fPosRecoDiffCorr(nullptr),
+      fPosResGraph(nullptr),
+      fPosResCorrGraph(nullptr),
+      fPlRecoFun(nullptr),
+      fPrRecoFun(nullptr),
+      fPosRecoAll(nullptr),
+      fResultsExp(nullptr),
+      fResultsCorr(nullptr)
+{
+    fContext->Retain();
+
+    if (!Init())
+    {
+        fContext->Release();
+        throw "##### Exception in SFPositionReco constructor!";
+    }
+}
+//------------------------------------------------------------------
+bool SFPositionReco::Init(void)
+{
+    fData = fContext->GetData();
+
     TString desc = fData->GetDescription();
 
     if (!desc.Contains("Regular series"))
     {
         std::cout << "##### Error in SFPositionReco constructor! Non-regular series!"
                   << std::endl;
-        throw "##### Exception in SFPositionReco constructor!";
+        return false;
     }
 
     fResultsExp  = new SFResults(Form("PositionRecoResults_S%i_Exp", fSeriesNo));
     fResultsCorr = new SFResults(Form("PositionRecoResults_S%i_Corr", fSeriesNo));
     
     //----- accessing attenuation analysis results
-    SFAttenuation* att;
-     
-    try
-    {
-        att = new SFAttenuation(fSeriesNo);
-    }
-    catch (const char* message)
-    {
-        std::cerr << message << std::endl;
-        throw "##### Exception in SFPositionReco constructor!";
-    }
+    SFAttenuation* att = fContext->GetAttenuation();
 
     att->AttCombinedCh();
 
     std::vector<SFResults*> att_results = att->GetResults();
     
     fMLRGraph = (TGraphErrors*)att_results[2]->GetObject(SFResultTypeObj::kAttGraph);
-    
-    delete att;
-    delete att_results[0];
-    delete att_results[1];
-    delete att_results[3];
-    delete att_results[4];
     //-----
     
     //----- accessing attenuation model results
-    //SFAttenuationModel* fModel;
-    
-    try
-    {
-        fModel = new SFAttenuationModel(fSeriesNo);
-    }
-    catch (const char* message)
-    {
-        std::cerr << message << std::endl;
-        throw "##### Exception in SFPositionReco constructor!";
-    }
-    
+    fModel = fContext->GetAttenuationModel();
     fModel->FitModel();
     
     SFResults *model_results = fModel->GetResults();
@@ -103,8 +120,6 @@ SFPositionReco::SFPositionReco(int seriesNo) : fSeriesNo(seriesNo),
     fPrRecoFun = (TF2*)model_results->GetObject(SFResultTypeObj::kPrRecoFun);
     fMAttCh0CorrGraph = (TGraphErrors*)model_results->GetObject(SFResultTypeObj::kPlVsPosGraph);
     fMAttCh1CorrGraph = (TGraphErrors*)model_results->GetObject(SFResultTypeObj::kPrVsPosGraph);
-    
-    //delete model_results;
     //-----
     
     //----- accessing position resolution analysis results 
@@ -112,12 +127,12 @@ SFPositionReco::SFPositionReco(int seriesNo) : fSeriesNo(seriesNo),
     
     try
     {
-        posres = new SFPositionRes(fSeriesNo);
+        posres = new SFPositionRes(fContext);
     }
     catch (const char* message)
     {
         std::cerr << message << std::endl;
-        throw "##### Exception in SFPositionReco constructor!";
+        return false;
     }
     
     posres->AnalyzePositionRes();
@@ -135,14 +150,15 @@ SFPositionReco::SFPositionReco(int seriesNo) : fSeriesNo(seriesNo),
     
     fResultsExp->AddResult(SFResultTypeNum::kPositionRes, posres_results[0]->GetValue(SFResultTypeNum::kPositionRes),
                            posres_results[0]->GetUncertainty(SFResultTypeNum::kPositionRes));
-    //delete posres;
-    //delete posres_results;
+    delete posres;
     //-----
+
+    return true;
 }
 //------------------------------------------------------------------
 SFPositionReco::~SFPositionReco()
 {
-    if (fData != nullptr) delete fData;
+    if (fContext != nullptr) fContext->Release();
 };
 //------------------------------------------------------------------
 bool SFPositionReco::CalculateMLR(void)
@@ -334,7 +350,6 @@ bool SFPositionReco::PositionReco(void)
     TString cut = SFDrawCommands::GetCut(SFCutType::kCombCh0Ch1, sigmas);
    
     //-----
-    double xmin, xmax;
     double A     = fResultsCorr->GetValue(SFResultTypeNum::kACoeff);
     double A_err = fResultsCorr->GetUncertainty(SFResultTypeNum::kACoeff);
     double B     = fResultsCorr->GetValue(SFResultTypeNum::kBCoeff);
@@ -348,27 +363,25 @@ bool SFPositionReco::PositionReco(void)
     hPosRecoAll->GetXaxis()->SetTitle("reconstructed position - source position [mm]");
     hPosRecoAll->GetYaxis()->SetTitle("counts");
     
-    std::vector<double> parsForErrors(9);
-    parsForErrors[0] = fModel->GetResults()->GetValue(SFResultTypeNum::kLambda);
-    parsForErrors[1] = fModel->GetResults()->GetValue(SFResultTypeNum::kEtaR);
-    parsForErrors[2] = fModel->GetResults()->GetValue(SFResultTypeNum::kEtaL);
-    parsForErrors[3] = fModel->GetResults()->GetValue(SFResultTypeNum::kKsi);
-    parsForErrors[4] = fModel->GetResults()->GetValue(SFResultTypeNum::kLength);
-    
+    //----- model parameters bound once for all events
+    SFRecoKernel* kernel = fModel->GetRecoKernel();
+
+    //----- setting up all positions in the calling thread
+    std::vector<SFEventCache*>       caches(npointsMax);
+    std::vector<double>              xmins(npointsMax), xmaxs(npointsMax);
+    std::vector<double>              sigmaSL(npointsMax), sigmaSR(npointsMax);
+    std::vector<std::vector<double>> posReco(npointsMax);
+
     for (int npoint = 0; npoint < npointsMax; npoint++)
     {
         std::cout << "\t Analyzing position " << positions[npoint] << " mm..." << std::endl;
 
-        SLoop* loop = fData->GetTree(measurementsIDs[npoint]);
-
-        int        nloopMax = loop->getEntries();
-        SCategory* tSig     = SCategoryManager::getCategory(SCategory::CatDDSamples);
+        //----- getting event cache
+        caches[npoint] = fData->GetEventCache(measurementsIDs[npoint]);
 
         //----- setting energy cut
-        auto specAv = std::unique_ptr<TH1D>(fData->GetCustomHistogram(SFSelectionType::kPEAverage, cut, measurementsIDs[npoint]));
-        
-        auto peakFinAv = std::unique_ptr<SFPeakFinder>(new SFPeakFinder(specAv.get(), false));
-        peakFinAv->FindPeakRange(xmin, xmax);
+        TH1D* specAv = fContext->GetCustomHistogram(SFSelectionType::kPEAverage, cut, measurementsIDs[npoint]);
+        fContext->GetPeakFinder(specAv)->FindPeakRange(xmins[npoint], xmaxs[npoint]);
         
         //----- setting histograms
         hname = Form("hRecoPositionsCorr_S%i_pos%.1f", fSeriesNo, positions[npoint]);
@@ -382,82 +395,72 @@ bool SFPositionReco::PositionReco(void)
         TString cutCh0 = SFDrawCommands::GetCut(SFCutType::kSpecCh0, sigma);
         TString cutCh1 = SFDrawCommands::GetCut(SFCutType::kSpecCh1, sigma);
         
-        auto specCh0 = std::unique_ptr<TH1D>(fData->GetSpectrum(0, SFSelectionType::kPE, cutCh0, measurementsIDs[npoint]));
-        auto specCh1 = std::unique_ptr<TH1D>(fData->GetSpectrum(1, SFSelectionType::kPE, cutCh1, measurementsIDs[npoint]));
-        
-        auto peakFinCh0 = std::unique_ptr<SFPeakFinder>(new SFPeakFinder(specCh0.get(), false));
-        peakFinCh0->FindPeakFit();
+        TH1D* specCh0 = fContext->GetSpectrum(0, SFSelectionType::kPE, cutCh0, measurementsIDs[npoint]);
+        TH1D* specCh1 = fContext->GetSpectrum(1, SFSelectionType::kPE, cutCh1, measurementsIDs[npoint]);
         
-        auto peakFinCh1 = std::unique_ptr<SFPeakFinder>(new SFPeakFinder(specCh1.get(), false));
-        peakFinCh1->FindPeakFit();
+        SFPeakFinder* peakFinCh0 = fContext->GetPeakFinder(specCh0);
+        SFPeakFinder* peakFinCh1 = fContext->GetPeakFinder(specCh1);
         
-        parsForErrors[7] = peakFinCh0->GetResults()->GetValue(SFResultTypeNum::kPeakSigma);
-        parsForErrors[8] = peakFinCh1->GetResults()->GetValue(SFResultTypeNum::kPeakSigma);
-        
-        //----- filling histograms
-        for (int nloop = 0; nloop < nloopMax; nloop++)
+        sigmaSL[npoint] = peakFinCh0->GetResults()->GetValue(SFResultTypeNum::kPeakSigma);
+        sigmaSR[npoint] = peakFinCh1->GetResults()->GetValue(SFResultTypeNum::kPeakSigma);
+    }
+
+    //----- reconstructing positions event by event, one task per position
+    SFTools::ParallelFor(npointsMax, [&](int npoint) {
+        SFEventCache* cache  = caches[npoint];
+        Long64_t      nrows  = cache->GetNrows();
+        const int*    module = cache->GetInt(SFCacheCol::kModule);
+        const float*  t0Ch0  = cache->GetFloat(SFCacheCol::kT0, 0);
+        const float*  t0Ch1  = cache->GetFloat(SFCacheCol::kT0, 1);
+        const float*  peCh0  = cache->GetFloat(SFCacheCol::kPE, 0);
+        const float*  peCh1  = cache->GetFloat(SFCacheCol::kPE, 1);
+        const float*  totCh0 = cache->GetFloat(SFCacheCol::kTOT, 0);
+        const float*  totCh1 = cache->GetFloat(SFCacheCol::kTOT, 1);
+        const float*  ampCh0 = cache->GetFloat(SFCacheCol::kAmp, 0);
+        const float*  ampCh1 = cache->GetFloat(SFCacheCol::kAmp, 1);
+
+        //----- selecting events
+        std::vector<double> SL, SR;
+
+        for (Long64_t i = 0; i < nrows; ++i)
         {
-            loop->getEvent(nloop);
-            size_t tentriesMax = tSig->getEntries();
-            
-            for (int tentries = 0; tentries < tentriesMax; tentries++)
+            if (module[i] != 0) continue;
+
+            if (t0Ch0[i] > 0 && t0Ch1[i] > 0 &&
+                totCh0[i] > 0 && totCh1[i] > 0 &&
+                ampCh0[i] < ampMax && ampCh1[i] < ampMax &&
+                sqrt(peCh0[i] * peCh1[i]) > xmins[npoint] &&
+                sqrt(peCh0[i] * peCh1[i]) < xmaxs[npoint])
             {
-                int m, l, f;
-                SDDSamples* samples = (SDDSamples*)tSig->getObject(tentries);
-                samples->getAddress(m, l, f);
-                
-                if (m == 0)
-                {
-                    double t0Ch0 = samples->getSignalL()->GetT0();
-                    double t0Ch1 = samples->getSignalR()->GetT0();
-                    double peCh0  = samples->getSignalL()->GetPE();
-                    double peCh1  = samples->getSignalR()->GetPE();
-                    //double blCh0  = samples->getSignalL()->GetBLSigma();
-                    //double blCh1  = samples->getSignalR()->GetBLSigma();
-                    double totCh0 = samples->getSignalL()->GetTOT();
-                    double totCh1 = samples->getSignalR()->GetTOT();
-                    double ampCh0 = samples->getSignalL()->GetAmplitude();
-                    double ampCh1 = samples->getSignalR()->GetAmplitude();
-                    //bool   vetoCh0 = samples->getSignalL()->GetVeto();
-                    //bool   vetoCh1 = samples->getSignalR()->GetVeto();
-                    
-                    if (t0Ch0 > 0 && t0Ch1 > 0 &&
-                        totCh0 > 0 && totCh1 > 0 &&
-                        //blCh0 < BL_sigma_cut && blCh1 < BL_sigma_cut &&
-                        ampCh0 < ampMax && ampCh1 < ampMax &&
-                        sqrt(peCh0 * peCh1) > xmin &&
-                        sqrt(peCh0 * peCh1) < xmax)// &&
-                        //vetoCh0 == 0 && vetoCh1 == 0)
-                    {
-                        parsForErrors[5] = peCh0;
-                        parsForErrors[6] = peCh1;
-                        
-                        //for (int k=0; k<9; k++)
-                        //{
-                        //    std::cout << parsForErrors[k] << "\t";
-                        //}
-                        //std::cout << std::endl;
-                        
-                        double MLR = log(sqrt(fPrRecoFun->Eval(peCh1, peCh0) /
-                                              fPlRecoFun->Eval(peCh1, peCh0)));
-                        double pos = A * MLR + B;
-                        double Pr_err = fModel->CalculateUncertainty(parsForErrors, "R");
-                        double Pl_err = fModel->CalculateUncertainty(parsForErrors, "L");
-                        double pos_err = sqrt(pow(MLR * A_err, 2) +
-                                              pow(A / (2 * fPrRecoFun->Eval(peCh1, peCh0)) * Pr_err, 2) +
-                                              pow(-A / (2 * fPlRecoFun->Eval(peCh1, peCh0)) * Pl_err, 2) + 
-                                              pow(B_err, 2));
-                        fRecoPositionsCorrHist[npoint]->Fill(pos);
-                        fRecoPositionsUncertCorrHist[npoint]->Fill(pos_err);
-                        hPosRecoAll->Fill(pos - positions[npoint]);
-                    }
-                    
-                }
+                SL.push_back(peCh0[i]);
+                SR.push_back(peCh1[i]);
             }
+        }
 
+        //----- reconstructing position
+        int                 nsel = SL.size();
+        std::vector<double> resErr(nsel);
+
+        posReco[npoint].resize(nsel);
+
+        kernel->Position(nsel, SL.data(), SR.data(), sigmaSL[npoint], sigmaSR[npoint], A, A_err, B,
+                         B_err, posReco[npoint].data(), resErr.data());
+
+        //----- filling histograms of this position
+        for (int i = 0; i < nsel; ++i)
+        {
+            fRecoPositionsCorrHist[npoint]->Fill(posReco[npoint][i]);
+            fRecoPositionsUncertCorrHist[npoint]->Fill(resErr[i]);
         }
+    });
+
+    for (int npoint = 0; npoint < npointsMax; npoint++)
+    {
+        //----- filling summed histogram
+        for (size_t i = 0; i < posReco[npoint].size(); ++i)
+            hPosRecoAll->Fill(posReco[npoint][i] - positions[npoint]);
 
-        delete loop;
+        std::vector<double>().swap(posReco[npoint]);
 
         double mean, mean_err, fwhm, fwhm_err;
         
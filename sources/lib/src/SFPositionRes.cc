@@ -16,6 +16,7 @@ const double ampMax = 660;
 
 //------------------------------------------------------------------
 SFPositionRes::SFPositionRes(int seriesNo) : fSeriesNo(seriesNo),
+                                             fContext(nullptr),
                                              fData(nullptr),
                                              fAtt(nullptr),
                                              fPosVsMLRGraph(nullptr),
@@ -25,7 +26,7 @@ SFPositionRes::SFPositionRes(int seriesNo) : fSeriesNo(seriesNo),
 
     try
     {
-        fData = new SFData(fSeriesNo);
+        fContext = SFSeriesContext::Acquire(fSeriesNo);
     }
     catch (const char* message)
     {
@@ -33,39 +34,58 @@ SFPositionRes::SFPositionRes(int seriesNo) : fSeriesNo(seriesNo),
         throw "##### Exception in SFPositionRes constructor!";
     }
 
-    TString desc = fData->GetDescription();
-
-    if (!desc.Contains("Regular series"))
+    if (!Init())
     {
-        std::cerr << "##### Error in SFPositionRes constructor! Non-regular series!" << std::endl;
+        fContext->Release();
         throw "##### Exception in SFPositionRes constructor!";
     }
+}
+//------------------------------------------------------------------
+SFPositionRes::SFPositionRes(SFSeriesContext* context) : fSeriesNo(context->GetSeriesNo()),
+                                                         fContext(context),
+                                                         fData(nullptr),
+                                                         fAtt(nullptr),
+                                                         fPosVsMLRGraph(nullptr),
+                                                         fResultsPol3(nullptr),
+                                                         fResultsPol1(nullptr)
+{
+    fContext->Retain();
 
-    try
+    if (!Init())
     {
-        fAtt = new SFAttenuation(fSeriesNo);
+        fContext->Release();
+        throw "##### Exception in SFPositionRes constructor!";
     }
-    catch (const char* message)
+}
+//------------------------------------------------------------------
+bool SFPositionRes::Init(void)
+{
+    fData = fContext->GetData();
+
+    TString desc = fData->GetDescription();
+
+    if (!desc.Contains("Regular series"))
     {
-        std::cerr << message << std::endl;
-        std::cerr << "##### Error in SFPositionRes constructor! Problem with SFAttenuation!"
-                  << std::endl;
-        throw "##### Exception in SFPositionRes constructor!";
+        std::cerr << "##### Error in SFPositionRes constructor! Non-regular series!" << std::endl;
+        return false;
     }
 
+    fAtt = fContext->GetAttenuation();
+
     double              s      = SFTools::GetSigmaBL(fData->GetSiPM());
     std::vector<double> sigmas = {s, s};
     TString             cut    = SFDrawCommands::GetCut(SFCutType::kCombCh0Ch1, sigmas);
-    fSpecAv                    = fData->GetCustomHistograms(SFSelectionType::kPEAverage, cut);
+    fSpecAv                    = fContext->GetCustomHistograms(SFSelectionType::kPEAverage, cut);
 
     fResultsPol3 = new SFResults(Form("PositionResResultsPol3_S%i", fSeriesNo));
     fResultsPol1 = new SFResults(Form("PositionResResultsPol1_S%i", fSeriesNo));
+
+    return true;
 }
 //------------------------------------------------------------------
 SFPositionRes::~SFPositionRes()
 {
-    if (fAtt != nullptr) delete fAtt;
-    if (fData != nullptr) delete fData;
+    if (fContext != nullptr) fContext->Release();
 }
 //------------------------------------------------------------------
 bool SFPositionRes::AnalyzePositionRes(void)
@@ -119,12 +139,10 @@ bool SFPositionRes::AnalyzePositionRes(void)
     
     double mean, sigma;
     double meanErr;
-    double MLR, pos_pol1, pos_pol3;
     double posResAv_p1    = 0;
     double posResAvErr_p1 = 0;
     double posResAv_p3    = 0;
     double posResAvErr_p3 = 0;
-    double xmin, xmax;
 
     //-----
     fAtt->AttCombinedCh();
@@ -176,21 +194,31 @@ bool SFPositionRes::AnalyzePositionRes(void)
     hPosRecoPol1All->GetXaxis()->SetTitle("reconstructed position - source position [mm]");
     hPosRecoPol1All->GetYaxis()->SetTitle("counts");
     
+    //----- parameters of the fitted functions, so that they can be evaluated
+    //----- concurrently with TF1::EvalPar()
+    std::vector<double> parPol3(funPol3->GetParameters(),
+                                funPol3->GetParameters() + funPol3->GetNpar());
+    std::vector<double> parPol1(funPol1->GetParameters(),
+                                funPol1->GetParameters() + funPol1->GetNpar());
+
+    //----- energy cuts come from peak finders shared by the series context,
+    //----- so they are set up before the parallel part
+    std::vector<SFEventCache*>       caches(npointsMax);
+    std::vector<double>              xmins(npointsMax), xmaxs(npointsMax);
+    std::vector<std::vector<double>> posPol3(npointsMax), posPol1(npointsMax);
+
     for (int npoint = 0; npoint < npointsMax; npoint++)
     {
 
         std::cout << "\t Analyzing position " << positions[npoint] << " mm..." << std::endl;
 
-        //----- geting tree
-        SLoop* loop = fData->GetTree(measurementsIDs[npoint]);
-        int        nloopMax = loop->getEntries();
-        SCategory* tSig     = SCategoryManager::getCategory(SCategory::CatDDSamples);
+        //----- getting event cache
+        caches[npoint] = fData->GetEventCache(measurementsIDs[npoint]);
 
         //----- setting energy cut
         //peakFinAv.push_back(new SFPeakFinder(fSpecAv[npoint], false));
         //peakFinAv[npoint]->FindPeakRange(xmin, xmax);
-        auto peakFinAv = std::unique_ptr<SFPeakFinder>(new SFPeakFinder(fSpecAv[npoint], false));
-        peakFinAv->FindPeakRange(xmin, xmax);
+        fContext->GetPeakFinder(fSpecAv[npoint])->FindPeakRange(xmins[npoint], xmaxs[npoint]);
         
         //----- setting histogram
         hname = Form("hPosRecoPol3_S%i_pos%.1f", fSeriesNo, positions[npoint]);
@@ -200,56 +228,56 @@ bool SFPositionRes::AnalyzePositionRes(void)
         hname = Form("hPosRecoPol1_S%i_pos%.1f", fSeriesNo, positions[npoint]);
         fPosRecoPol1Dist.push_back(new TH1D(hname, hname, 300, -100, 200));
         fPosRecoPol1Dist[npoint]->SetTitle(Form("Reconstructed Position Pol1 S%i %1f mm", fSeriesNo, positions[npoint]));
+    }
 
-        //----- filling histogram
-        for (int nloop = 0; nloop < nloopMax; ++nloop)
+    //----- each task fills only histograms of its own position
+    SFTools::ParallelFor(npointsMax, [&](int npoint) {
+        SFEventCache* cache  = caches[npoint];
+        Long64_t      nrows  = cache->GetNrows();
+        const int*    module = cache->GetInt(SFCacheCol::kModule);
+        const float*  t0Ch0  = cache->GetFloat(SFCacheCol::kT0, 0);
+        const float*  t0Ch1  = cache->GetFloat(SFCacheCol::kT0, 1);
+        const float*  peCh0  = cache->GetFloat(SFCacheCol::kPE, 0);
+        const float*  peCh1  = cache->GetFloat(SFCacheCol::kPE, 1);
+        const float*  totCh0 = cache->GetFloat(SFCacheCol::kTOT, 0);
+        const float*  totCh1 = cache->GetFloat(SFCacheCol::kTOT, 1);
+        const float*  ampCh0 = cache->GetFloat(SFCacheCol::kAmp, 0);
+        const float*  ampCh1 = cache->GetFloat(SFCacheCol::kAmp, 1);
+
+        //----- filling histogram of this position
+        for (Long64_t i = 0; i < nrows; ++i)
         {
-            loop->getEvent(nloop);
-            size_t tentriesMax = tSig->getEntries();
+            if (module[i] != 0) continue;
 
-            for (int tentries = 0; tentries < tentriesMax; ++tentries)
+            if (t0Ch0[i] > 0 && t0Ch1[i] > 0 &&
+                totCh0[i] > 0 && totCh1[i] > 0 &&
+                ampCh0[i] < ampMax && ampCh1[i] < ampMax &&
+                sqrt(peCh0[i] * peCh1[i]) > xmins[npoint] &&
+                sqrt(peCh0[i] * peCh1[i]) < xmaxs[npoint])
             {
-
-                int              m, l, f;
-                SDDSamples*      samples = (SDDSamples*)tSig->getObject(tentries);
-                samples->getAddress(m, l, f);
-
-                if (m == 0)
-                {
-                    double t0Ch0  = samples->getSignalL()->GetT0();
-                    double t0Ch1  = samples->getSignalR()->GetT0();
-                    double peCh0  = samples->getSignalL()->GetPE();
-                    double peCh1  = samples->getSignalR()->GetPE();
-                    //double blCh0  = samples->getSignalL()->GetBLSigma();
-                    //double blCh1  = samples->getSignalR()->GetBLSigma();
-                    double totCh0 = samples->getSignalL()->GetTOT();
-                    double totCh1 = samples->getSignalR()->GetTOT();
-                    double ampCh0 = samples->getSignalL()->GetAmplitude();
-                    double ampCh1 = samples->getSignalR()->GetAmplitude();
-                    //bool   vetoCh0 = samples->getSignalL()->GetVeto();
-                    //bool   vetoCh1 = samples->getSignalR()->GetVeto();
-                    
-                    if (t0Ch0 > 0 && t0Ch1 > 0 && 
-                        totCh0 > 0 && totCh1 > 0 &&
-                        //blCh0 < BL_sigma_cut && blCh1 < BL_sigma_cut &&
-                        ampCh0 < ampMax && ampCh1 < ampMax && 
-                        sqrt(peCh0 * peCh1) > xmin && sqrt(peCh0 * peCh1) < xmax)// &&
-                        //vetoCh0 == 0 && vetoCh1 == 0)
-                    {
-                        MLR = log(sqrt(peCh1 / peCh0));
-                        pos_pol3 = funPol3->Eval(MLR);
-                        fPosRecoPol3Dist[npoint]->Fill(pos_pol3);
-                        hPosRecoPol3All->Fill(pos_pol3 - positions[npoint]);
-                        
-                        pos_pol1 = funPol1->Eval(MLR);
-                        fPosRecoPol1Dist[npoint]->Fill(pos_pol1);
-                        hPosRecoPol1All->Fill(pos_pol1 - positions[npoint]);
-                    }
-                }
+                double MLR      = log(sqrt(peCh1[i] / peCh0[i]));
+                double pos_pol3 = funPol3->EvalPar(&MLR, parPol3.data());
+                fPosRecoPol3Dist[npoint]->Fill(pos_pol3);
+                posPol3[npoint].push_back(pos_pol3);
+
+                double pos_pol1 = funPol1->EvalPar(&MLR, parPol1.data());
+                fPosRecoPol1Dist[npoint]->Fill(pos_pol1);
+                posPol1[npoint].push_back(pos_pol1);
             }
         }
+    });
+
+    for (int npoint = 0; npoint < npointsMax; npoint++)
+    {
+        //----- filling summed histograms
+        for (size_t i = 0; i < posPol3[npoint].size(); ++i)
+        {
+            hPosRecoPol3All->Fill(posPol3[npoint][i] - positions[npoint]);
+            hPosRecoPol1All->Fill(posPol1[npoint][i] - positions[npoint]);
+        }
 
-        delete loop;
+        std::vector<double>().swap(posPol3[npoint]);
+        std::vector<double>().swap(posPol1[npoint]);
 
         //----- fitting histogram and calculating position resolution /pol3/
         mean        = fPosRecoPol3Dist[npoint]->GetMean();
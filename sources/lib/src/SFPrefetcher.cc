@@ -0,0 +1,207 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *           SFPrefetcher.cc             *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#include "SFPrefetcher.hh"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+ClassImp(SFPrefetcher);
+
+/// Size of the block read at once [bytes].
+static const size_t gBlockSize = 4 * 1024 * 1024;
+
+/// State of the background thread. Threads are not inherited by forked
+/// processes and the state of the synchronization objects copied from the
+/// parent process can't be trusted, therefore each process has its own
+/// worker. Workers are never deleted.
+struct SFPrefetchWorker
+{
+    pid_t                   fPid;             ///< Process of the thread
+    std::deque<TString>     fQueue;           ///< Files waiting to be read
+    std::set<TString>       fScheduled;       ///< Files already scheduled, each read only once
+    bool                    fBusy    = false; ///< Flag indicating that a file is being read
+    bool                    fRunning = true;  ///< Flag indicating that the thread is running
+    std::atomic<bool>       fStop{false};     ///< Flag requesting the thread to finish
+    std::mutex              fMutex;           ///< Mutex protecting the worker
+    std::condition_variable fCond;            ///< Condition variable signalling changes
+};
+
+/// Number of measurements read ahead of the analyzed one.
+static int gDepth = 1;
+/// Worker of the current process, nullptr if not started yet.
+static SFPrefetchWorker* gWorker = nullptr;
+/// Flag indicating whether Stop() has been registered to be called at exit.
+static bool gStopRegistered = false;
+/// Mutex protecting gDepth and gWorker. Never locked by the background thread.
+static std::mutex gPrefetcherMutex;
+
+//------------------------------------------------------------------
+/// Reads the whole file, so that it is kept in the page cache. Data
+/// is discarded. Reading is interrupted by Stop().
+/// \param worker - worker reading the file
+/// \param fname - name of the file
+static void ReadFile(SFPrefetchWorker* worker, TString fname)
+{
+    int fd = open(fname.Data(), O_RDONLY);
+    if (fd < 0) return;
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+
+    std::vector<char> buffer(gBlockSize);
+    while (!worker->fStop && read(fd, buffer.data(), buffer.size()) > 0)
+    {
+    }
+
+    close(fd);
+}
+//------------------------------------------------------------------
+/// Main loop of the background thread: reads scheduled files one after
+/// another until Stop() is called.
+/// \param worker - state of the thread
+static void Run(SFPrefetchWorker* worker)
+{
+    std::unique_lock<std::mutex> lock(worker->fMutex);
+
+    while (true)
+    {
+        worker->fCond.wait(lock, [worker] { return worker->fStop || !worker->fQueue.empty(); });
+        if (worker->fStop) break;
+
+        TString fname = worker->fQueue.front();
+        worker->fQueue.pop_front();
+        worker->fBusy = true;
+
+        lock.unlock();
+        ReadFile(worker, fname);
+        lock.lock();
+
+        worker->fBusy = false;
+        worker->fCond.notify_all();
+    }
+
+    worker->fRunning = false;
+    worker->fCond.notify_all();
+}
+//------------------------------------------------------------------
+/// Returns worker of the current process or nullptr if it hasn't been
+/// started. Has to be called with gPrefetcherMutex locked.
+static SFPrefetchWorker* CurrentWorker(void)
+{
+    if (gWorker == nullptr || gWorker->fPid != getpid()) return nullptr;
+    return gWorker;
+}
+//------------------------------------------------------------------
+/// Schedules reading of the given file on the background thread. Files
+/// which have already been scheduled are ignored. The thread is started
+/// at the first call.
+/// \param fname - name of the file
+void SFPrefetcher::Schedule(TString fname)
+{
+    SFPrefetchWorker* worker = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(gPrefetcherMutex);
+
+        if (gDepth <= 0) return;
+
+        worker = CurrentWorker();
+
+        if (worker == nullptr)
+        {
+            if (!gStopRegistered)
+            {
+                std::atexit(Stop);
+                gStopRegistered = true;
+            }
+
+            // worker of the parent process is abandoned
+            worker       = new SFPrefetchWorker();
+            worker->fPid = getpid();
+            gWorker      = worker;
+            std::thread(Run, worker).detach();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(worker->fMutex);
+
+    if (worker->fStop || worker->fScheduled.count(fname) > 0) return;
+
+    worker->fScheduled.insert(fname);
+    worker->fQueue.push_back(fname);
+    worker->fCond.notify_all();
+}
+//------------------------------------------------------------------
+/// Waits until all scheduled files are read.
+void SFPrefetcher::Wait(void)
+{
+    SFPrefetchWorker* worker = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(gPrefetcherMutex);
+        worker = CurrentWorker();
+    }
+
+    if (worker == nullptr) return;
+
+    std::unique_lock<std::mutex> lock(worker->fMutex);
+    worker->fCond.wait(lock, [worker] {
+        return !worker->fRunning || (worker->fQueue.empty() && !worker->fBusy);
+    });
+}
+//------------------------------------------------------------------
+/// Removes files waiting in the queue, interrupts reading of the current
+/// file and waits until the background thread finishes. Called at the end
+/// of the program.
+void SFPrefetcher::Stop(void)
+{
+    SFPrefetchWorker* worker = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(gPrefetcherMutex);
+        worker = CurrentWorker();
+    }
+
+    if (worker == nullptr) return;
+
+    std::unique_lock<std::mutex> lock(worker->fMutex);
+
+    worker->fQueue.clear();
+    worker->fStop = true;
+    worker->fCond.notify_all();
+    worker->fCond.wait(lock, [worker] { return !worker->fRunning; });
+}
+//------------------------------------------------------------------
+/// Sets number of measurements whose files are read ahead of the analyzed
+/// one. 0 disables prefetching.
+/// \param depth - number of measurements
+void SFPrefetcher::SetDepth(int depth)
+{
+    std::lock_guard<std::mutex> lock(gPrefetcherMutex);
+    gDepth = depth < 0 ? 0 : depth;
+}
+//------------------------------------------------------------------
+/// Returns number of measurements whose files are read ahead of the
+/// analyzed one.
+int SFPrefetcher::GetDepth(void)
+{
+    std::lock_guard<std::mutex> lock(gPrefetcherMutex);
+    return gDepth;
+}
+//------------------------------------------------------------------
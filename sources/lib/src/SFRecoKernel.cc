@@ -0,0 +1,288 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *            SFRecoKernel.cc            *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#include "SFRecoKernel.hh"
+#include "SFAttenuationModel.hh"
+
+ClassImp(SFRecoKernel);
+
+//------------------------------------------------------------------
+/// Standard constructor. Binds parameters and covariance matrix of
+/// the fitted attenuation model.
+/// \param model - attenuation model analysis, SFAttenuationModel::FitModel()
+/// must have been called before
+SFRecoKernel::SFRecoKernel(SFAttenuationModel* model)
+{
+    if (model == nullptr || model->GetResults() == nullptr)
+    {
+        std::cerr << "##### Error in SFRecoKernel constructor! Attenuation model not available!"
+                  << std::endl;
+        throw "##### Exception in SFRecoKernel constructor!";
+    }
+
+    SFResults* results = model->GetResults();
+
+    Bind(results->GetValue(SFResultTypeNum::kLambda), results->GetValue(SFResultTypeNum::kEtaR),
+         results->GetValue(SFResultTypeNum::kEtaL), results->GetValue(SFResultTypeNum::kKsi),
+         results->GetValue(SFResultTypeNum::kLength), model->GetCovMatrix());
+}
+//------------------------------------------------------------------
+/// Constructor binding given model parameters.
+/// \param lambda - attenuation length [mm]
+/// \param etaR - reflection coefficient on the right end of the fiber
+/// \param etaL - reflection coefficient on the left end of the fiber
+/// \param ksi - ratio of the right and left side light collection
+/// \param length - fiber length [mm]
+/// \param cov - covariance matrix of the fitted parameters (6 x 6)
+SFRecoKernel::SFRecoKernel(double lambda, double etaR, double etaL, double ksi, double length,
+                           const TMatrixD& cov)
+{
+    Bind(lambda, etaR, etaL, ksi, length, cov);
+}
+//------------------------------------------------------------------
+/// Calculates coefficients of the reconstructed primary components and
+/// of their model variance. Partial derivatives of Pl and Pr with respect
+/// to the fitted parameters ([0] - S0, [1] - lambda, [2] - eta right,
+/// [3] - eta left, [4] - ksi, [5] - fiber length) have the form
+/// a * SL + b * SR, so variance d^T * cov * d is a quadratic form of
+/// SL and SR.
+void SFRecoKernel::Bind(double lambda, double etaR, double etaL, double ksi, double length,
+                        const TMatrixD& cov)
+{
+    if (cov.GetNrows() != 6 || cov.GetNcols() != 6)
+    {
+        std::cerr << "##### Error in SFRecoKernel::Bind()! Incorrect size of the covariance "
+                  << "matrix!" << std::endl;
+        throw "##### Exception in SFRecoKernel constructor!";
+    }
+
+    double e   = exp(length / lambda);
+    double e2  = e * e;
+    double den = e2 - etaR * etaL;
+    double d2  = den * den;
+    double l2  = lambda * lambda;
+
+    fPlCoeff[0] = e2 / den;
+    fPlCoeff[1] = -e * etaR / (ksi * den);
+    fPrCoeff[0] = -e * etaL / den;
+    fPrCoeff[1] = e2 / (ksi * den);
+
+    double aL[6] = {0,
+                    2 * e2 * length * etaR * etaL / (l2 * d2),
+                    e2 * etaL / d2,
+                    e2 * etaR / d2,
+                    0,
+                    0};
+    double bL[6] = {0,
+                    -e * length * etaR * (e2 + etaR * etaL) / (l2 * ksi * d2),
+                    -e * e2 / (ksi * d2),
+                    -e * etaR * etaR / (ksi * d2),
+                    e * etaR / (ksi * ksi * den),
+                    0};
+    double aR[6] = {0,
+                    -e * length * etaL * (e2 + etaR * etaL) / (l2 * d2),
+                    -e * etaL * etaL / d2,
+                    -e * e2 / d2,
+                    0,
+                    0};
+    double bR[6] = {0,
+                    2 * e2 * length * etaL * etaR / (l2 * ksi * d2),
+                    e2 * etaL / (ksi * d2),
+                    e2 * etaR / (ksi * d2),
+                    -e2 / (ksi * ksi * den),
+                    0};
+
+    for (int k = 0; k < 3; k++)
+    {
+        fPlVar[k] = 0;
+        fPrVar[k] = 0;
+    }
+
+    for (int i = 0; i < 6; i++)
+    {
+        for (int j = 0; j < 6; j++)
+        {
+            double c = cov(i, j);
+            fPlVar[0] += c * aL[i] * aL[j];
+            fPlVar[1] += c * (aL[i] * bL[j] + bL[i] * aL[j]);
+            fPlVar[2] += c * bL[i] * bL[j];
+            fPrVar[0] += c * aR[i] * aR[j];
+            fPrVar[1] += c * (aR[i] * bR[j] + bR[i] * aR[j]);
+            fPrVar[2] += c * bR[i] * bR[j];
+        }
+    }
+}
+//------------------------------------------------------------------
+/// Aborts if negative model variance was found in the processed events.
+/// \param nneg - number of events with negative variance
+/// \param method - name of the calling method
+void SFRecoKernel::CheckVariance(int nneg, TString method)
+{
+    if (nneg == 0) return;
+
+    std::cerr << "##### Error in SFRecoKernel::" << method << "()! Negative variance!"
+              << std::endl;
+    std::cerr << "Number of affected events: " << nneg << std::endl;
+    std::abort();
+}
+//------------------------------------------------------------------
+/// Reconstructs primary components for an array of events.
+/// \param n - number of events
+/// \param SL - signals of the left side (ch0) [P.E.]
+/// \param SR - signals of the right side (ch1) [P.E.]
+/// \param Pl - reconstructed primary components of the left side
+/// \param Pr - reconstructed primary components of the right side
+void SFRecoKernel::Primary(int n, const double* SL, const double* SR, double* Pl, double* Pr)
+{
+    const double l0 = fPlCoeff[0], l1 = fPlCoeff[1];
+    const double r0 = fPrCoeff[0], r1 = fPrCoeff[1];
+
+    for (int i = 0; i < n; i++)
+    {
+        Pl[i] = l0 * SL[i] + l1 * SR[i];
+        Pr[i] = r0 * SL[i] + r1 * SR[i];
+    }
+}
+//------------------------------------------------------------------
+/// Calculates uncertainties of the reconstructed primary components for
+/// an array of events.
+/// \param n - number of events
+/// \param SL - signals of the left side (ch0) [P.E.]
+/// \param SR - signals of the right side (ch1) [P.E.]
+/// \param sigmaSL - uncertainty of the left side signal
+/// \param sigmaSR - uncertainty of the right side signal
+/// \param PlErr - uncertainties of the left side primary components
+/// \param PrErr - uncertainties of the right side primary components
+void SFRecoKernel::PrimaryUncertainty(int n, const double* SL, const double* SR,
+                                      double sigmaSL, double sigmaSR, double* PlErr,
+                                      double* PrErr)
+{
+    const double vl0 = fPlVar[0], vl1 = fPlVar[1], vl2 = fPlVar[2];
+    const double vr0 = fPrVar[0], vr1 = fPrVar[1], vr2 = fPrVar[2];
+    const double statL = pow(fPlCoeff[0] * sigmaSL, 2) + pow(fPlCoeff[1] * sigmaSR, 2);
+    const double statR = pow(fPrCoeff[0] * sigmaSL, 2) + pow(fPrCoeff[1] * sigmaSR, 2);
+
+    int nneg = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        double varL = (vl0 * SL[i] + vl1 * SR[i]) * SL[i] + vl2 * SR[i] * SR[i];
+        double varR = (vr0 * SL[i] + vr1 * SR[i]) * SL[i] + vr2 * SR[i] * SR[i];
+        nneg += (varL < 0) | (varR < 0);
+        PlErr[i] = sqrt(varL + statL);
+        PrErr[i] = sqrt(varR + statR);
+    }
+
+    CheckVariance(nneg, "PrimaryUncertainty");
+}
+//------------------------------------------------------------------
+/// Reconstructs energy and its uncertainty for an array of events. Energy
+/// is equal to alpha * sqrt(Pl * Pr).
+/// \param n - number of events
+/// \param SL - signals of the left side (ch0) [P.E.]
+/// \param SR - signals of the right side (ch1) [P.E.]
+/// \param sigmaSL - uncertainty of the left side signal
+/// \param sigmaSR - uncertainty of the right side signal
+/// \param alpha - energy calibration coefficient
+/// \param alphaErr - uncertainty of the energy calibration coefficient
+/// \param E - reconstructed energy
+/// \param EErr - uncertainty of the reconstructed energy
+void SFRecoKernel::Energy(int n, const double* SL, const double* SR, double sigmaSL,
+                          double sigmaSR, double alpha, double alphaErr, double* E, double* EErr)
+{
+    const double l0 = fPlCoeff[0], l1 = fPlCoeff[1];
+    const double r0 = fPrCoeff[0], r1 = fPrCoeff[1];
+    const double vl0 = fPlVar[0], vl1 = fPlVar[1], vl2 = fPlVar[2];
+    const double vr0 = fPrVar[0], vr1 = fPrVar[1], vr2 = fPrVar[2];
+    const double statL = pow(l0 * sigmaSL, 2) + pow(l1 * sigmaSR, 2);
+    const double statR = pow(r0 * sigmaSL, 2) + pow(r1 * sigmaSR, 2);
+
+    int nneg = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        double Pl   = l0 * SL[i] + l1 * SR[i];
+        double Pr   = r0 * SL[i] + r1 * SR[i];
+        double varL = (vl0 * SL[i] + vl1 * SR[i]) * SL[i] + vl2 * SR[i] * SR[i];
+        double varR = (vr0 * SL[i] + vr1 * SR[i]) * SL[i] + vr2 * SR[i] * SR[i];
+        nneg += (varL < 0) | (varR < 0);
+
+        double q   = sqrt(Pl * Pr);
+        double aux = alpha / (2 * q);
+
+        E[i]    = alpha * q;
+        EErr[i] = sqrt(q * q * alphaErr * alphaErr + aux * aux * Pr * Pr * (varL + statL) +
+                       aux * aux * Pl * Pl * (varR + statR));
+    }
+
+    CheckVariance(nneg, "Energy");
+}
+//------------------------------------------------------------------
+/// Reconstructs position and its uncertainty for an array of events.
+/// Position is equal to A * ln(sqrt(Pr / Pl)) + B.
+/// \param n - number of events
+/// \param SL - signals of the left side (ch0) [P.E.]
+/// \param SR - signals of the right side (ch1) [P.E.]
+/// \param sigmaSL - uncertainty of the left side signal
+/// \param sigmaSR - uncertainty of the right side signal
+/// \param A - slope of the position calibration
+/// \param AErr - uncertainty of the slope
+/// \param B - offset of the position calibration
+/// \param BErr - uncertainty of the offset
+/// \param pos - reconstructed position [mm]
+/// \param posErr - uncertainty of the reconstructed position [mm]
+void SFRecoKernel::Position(int n, const double* SL, const double* SR, double sigmaSL,
+                            double sigmaSR, double A, double AErr, double B, double BErr,
+                            double* pos, double* posErr)
+{
+    const double l0 = fPlCoeff[0], l1 = fPlCoeff[1];
+    const double r0 = fPrCoeff[0], r1 = fPrCoeff[1];
+    const double vl0 = fPlVar[0], vl1 = fPlVar[1], vl2 = fPlVar[2];
+    const double vr0 = fPrVar[0], vr1 = fPrVar[1], vr2 = fPrVar[2];
+    const double statL = pow(l0 * sigmaSL, 2) + pow(l1 * sigmaSR, 2);
+    const double statR = pow(r0 * sigmaSL, 2) + pow(r1 * sigmaSR, 2);
+    const double BErr2 = BErr * BErr;
+
+    int nneg = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        double Pl   = l0 * SL[i] + l1 * SR[i];
+        double Pr   = r0 * SL[i] + r1 * SR[i];
+        double varL = (vl0 * SL[i] + vl1 * SR[i]) * SL[i] + vl2 * SR[i] * SR[i];
+        double varR = (vr0 * SL[i] + vr1 * SR[i]) * SL[i] + vr2 * SR[i] * SR[i];
+        nneg += (varL < 0) | (varR < 0);
+
+        double MLR = 0.5 * log(Pr / Pl);
+        double dPr = A / (2 * Pr);
+        double dPl = A / (2 * Pl);
+
+        pos[i]    = A * MLR + B;
+        posErr[i] = sqrt(MLR * MLR * AErr * AErr + dPr * dPr * (varR + statR) +
+                         dPl * dPl * (varL + statL) + BErr2);
+    }
+
+    CheckVariance(nneg, "Position");
+}
+//------------------------------------------------------------------
+/// Prints details of the SFRecoKernel class object.
+void SFRecoKernel::Print(void)
+{
+    std::cout << "\n-------------------------------------------" << std::endl;
+    std::cout << "This is print out of SFRecoKernel class object" << std::endl;
+    std::cout << "Pl = " << fPlCoeff[0] << " * SL + " << fPlCoeff[1] << " * SR" << std::endl;
+    std::cout << "Pr = " << fPrCoeff[0] << " * SL + " << fPrCoeff[1] << " * SR" << std::endl;
+    std::cout << "Model variance Pl: " << fPlVar[0] << " * SL^2 + " << fPlVar[1]
+              << " * SL * SR + " << fPlVar[2] << " * SR^2" << std::endl;
+    std::cout << "Model variance Pr: " << fPrVar[0] << " * SL^2 + " << fPrVar[1]
+              << " * SL * SR + " << fPrVar[2] << " * SR^2" << std::endl;
+    std::cout << "-------------------------------------------\n" << std::endl;
+}
+//------------------------------------------------------------------
@@ -0,0 +1,318 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *           SFResultsSink.cc            *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#include "SFResultsSink.hh"
+#include "SFTools.hh"
+
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+
+ClassImp(SFResultsSink);
+
+/// Sinks which have already been opened, accessed by data base name.
+static std::map<TString, SFResultsSink*> gSinks;
+/// Mutex protecting gSinks and all writes to the results data bases.
+static std::recursive_mutex gSinksMutex;
+/// Flag indicating whether CloseAll() has been registered to be called at exit.
+static bool gCloseRegistered = false;
+
+//------------------------------------------------------------------
+/// Standard constructor. Opens connection to the results data base and
+/// switches it to WAL journal mode. Usually SFResultsSink::Open() should
+/// be used instead, so that the connection is shared.
+/// \param database - name of the results data base file
+/// \param busyTimeout - maximal time of waiting for the data base locked
+/// by other processes [ms]
+SFResultsSink::SFResultsSink(TString database, int busyTimeout) : fDatabase(database),
+                                                                  fBusyTimeout(busyTimeout),
+                                                                  fDB(nullptr)
+{
+    int status = sqlite3_open_v2(fDatabase, &fDB,
+                                 SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
+                                 nullptr);
+
+    if (status != SQLITE_OK)
+    {
+        std::cerr << "##### Error in SFResultsSink constructor! Could not open data base "
+                  << fDatabase << std::endl;
+        std::cerr << sqlite3_errmsg(fDB) << std::endl;
+        sqlite3_close(fDB);
+        fDB = nullptr;
+        throw "##### Exception in SFResultsSink constructor!";
+    }
+
+    sqlite3_busy_timeout(fDB, fBusyTimeout);
+
+    if (!Execute("PRAGMA journal_mode=WAL"))
+    {
+        std::cout << "##### Warning in SFResultsSink constructor! WAL journal mode not available, "
+                  << "using default journal mode." << std::endl;
+    }
+}
+//------------------------------------------------------------------
+/// Default destructor. Finalizes prepared statements and closes the data base.
+SFResultsSink::~SFResultsSink()
+{
+    for (auto& stmt : fStatements)
+        sqlite3_finalize(stmt.second);
+
+    if (fDB != nullptr)
+    {
+        int status = sqlite3_close_v2(fDB);
+        if (status != SQLITE_OK)
+            std::cerr << "In SFResultsSink destructor. Data base corrupted!" << std::endl;
+    }
+}
+//------------------------------------------------------------------
+/// Returns sink of the given results data base. The sink is created at the
+/// first call and kept until the end of the program, when it is closed by
+/// SFResultsSink::CloseAll(). If the data base can't be opened, nullptr is
+/// returned.
+/// \param database - name of the results data base file
+SFResultsSink* SFResultsSink::Open(TString database)
+{
+    std::lock_guard<std::recursive_mutex> lock(gSinksMutex);
+
+    auto it = gSinks.find(database);
+    if (it != gSinks.end()) return it->second;
+
+    if (!gCloseRegistered)
+    {
+        std::atexit(CloseAll);
+        gCloseRegistered = true;
+    }
+
+    SFResultsSink* sink = nullptr;
+
+    try
+    {
+        sink = new SFResultsSink(database);
+    }
+    catch (const char* message)
+    {
+        std::cerr << message << std::endl;
+        std::cerr << "##### Error in SFResultsSink::Open()!" << std::endl;
+        return nullptr;
+    }
+
+    gSinks[database] = sink;
+
+    return sink;
+}
+//------------------------------------------------------------------
+/// Closes all opened results data bases.
+void SFResultsSink::CloseAll(void)
+{
+    std::lock_guard<std::recursive_mutex> lock(gSinksMutex);
+
+    for (auto& sink : gSinks)
+        delete sink.second;
+
+    gSinks.clear();
+}
+//------------------------------------------------------------------
+/// Checks status returned by the SQLite function. Prints error message
+/// if the status indicates an error.
+/// \param status - status returned by the SQLite function
+/// \param method - name of the calling method
+bool SFResultsSink::Check(int status, TString method)
+{
+    if (status == SQLITE_OK || status == SQLITE_ROW || status == SQLITE_DONE) return true;
+
+    std::cerr << "##### Error in SFResultsSink::" << method << "()!" << std::endl;
+    std::cerr << "Data base: " << fDatabase << ", status: " << status << std::endl;
+    std::cerr << sqlite3_errmsg(fDB) << std::endl;
+
+    return false;
+}
+//------------------------------------------------------------------
+/// Returns prepared statement of the given query. Statements are prepared
+/// at the first use and reused by the subsequent calls.
+/// \param query - SQL query
+sqlite3_stmt* SFResultsSink::Prepare(TString query)
+{
+    auto it = fStatements.find(query);
+    if (it != fStatements.end()) return it->second;
+
+    sqlite3_stmt* stmt   = nullptr;
+    int           status = sqlite3_prepare_v2(fDB, query, -1, &stmt, nullptr);
+
+    if (!Check(status, "Prepare"))
+    {
+        std::cerr << query << std::endl;
+        return nullptr;
+    }
+
+    fStatements[query] = stmt;
+
+    return stmt;
+}
+//------------------------------------------------------------------
+/// Executes the given query without preparing it for reuse.
+/// \param query - SQL query
+bool SFResultsSink::Execute(TString query)
+{
+    int status = sqlite3_exec(fDB, query, nullptr, nullptr, nullptr);
+    return Check(status, "Execute");
+}
+//------------------------------------------------------------------
+/// Checks whether the given table exists in the data base and creates
+/// it if it doesn't. Has to be called inside of the transaction.
+/// \param table - name of the table
+bool SFResultsSink::CheckTable(TString table)
+{
+    if (fTables.count(table) > 0) return true;
+
+    sqlite3_stmt* stmt = Prepare("SELECT name FROM sqlite_master WHERE type='table' AND name=?");
+    if (stmt == nullptr) return false;
+
+    sqlite3_bind_text(stmt, 1, table.Data(), -1, SQLITE_TRANSIENT);
+    int status = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    if (!Check(status, "CheckTable")) return false;
+
+    if (status != SQLITE_ROW)
+    {
+        std::cout << "----- Creating new table: " << table << std::endl;
+        std::cout << "----- Data base: " << fDatabase << std::endl;
+
+        TString query = SFTools::GetTableSchema(table);
+        if (query == "" || !Execute(query)) return false;
+    }
+
+    fTables.insert(table);
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Writes an entry to the results data base. Table is created if it
+/// doesn't exist and the entry is inserted (or replaced) together with
+/// the current date, all in a single transaction.
+/// \param table - name of the table
+/// \param seriesNo - number of the experimental series of the entry
+/// \param resultsFile - name of the ROOT file with the results
+/// \param values - names of the numerical columns and their values
+/// \param text - names of the text columns and their values
+bool SFResultsSink::Save(TString table, int seriesNo, TString resultsFile,
+                         const std::vector<std::pair<TString, double>>&  values,
+                         const std::vector<std::pair<TString, TString>>& text)
+{
+    std::lock_guard<std::recursive_mutex> lock(gSinksMutex);
+
+    std::cout << "----- Saving results in the databse: " << fDatabase << std::endl;
+    std::cout << "----- Accessing table: " << table << std::endl;
+
+    TString query  = Form("INSERT OR REPLACE INTO %s (SERIES_ID, RESULTS_FILE", table.Data());
+    TString params = "?, ?";
+
+    for (auto& v : values)
+    {
+        query += ", " + v.first;
+        params += ", ?";
+    }
+
+    for (auto& t : text)
+    {
+        query += ", " + t.first;
+        params += ", ?";
+    }
+
+    query += ", DATE) VALUES (" + params + ", ?)";
+
+    if (!Execute("BEGIN IMMEDIATE")) return false;
+
+    sqlite3_stmt* stmt = nullptr;
+
+    if (!CheckTable(table) || (stmt = Prepare(query)) == nullptr)
+    {
+        Execute("ROLLBACK");
+        return false;
+    }
+
+    int col = 1;
+    sqlite3_bind_int(stmt, col++, seriesNo);
+    sqlite3_bind_text(stmt, col++, resultsFile.Data(), -1, SQLITE_TRANSIENT);
+
+    for (auto& v : values)
+        sqlite3_bind_double(stmt, col++, v.second);
+
+    for (auto& t : text)
+        sqlite3_bind_text(stmt, col++, t.second.Data(), -1, SQLITE_TRANSIENT);
+
+    sqlite3_bind_int64(stmt, col++, (sqlite3_int64)time(nullptr));
+
+    int status = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    if (!Check(status, "Save") || !Execute("COMMIT"))
+    {
+        Execute("ROLLBACK");
+        return false;
+    }
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Executes the given insert query and sets the date of the entry, in a
+/// single transaction. Table is created if it doesn't exist. Used by
+/// SFTools::SaveResultsDB(); Save() should be preferred.
+/// \param table - name of the table
+/// \param query - SQL query inserting the entry
+/// \param seriesNo - number of the experimental series of the entry
+bool SFResultsSink::SaveQuery(TString table, TString query, int seriesNo)
+{
+    std::lock_guard<std::recursive_mutex> lock(gSinksMutex);
+
+    std::cout << "----- Saving results in the databse: " << fDatabase << std::endl;
+    std::cout << "----- Accessing table: " << table << std::endl;
+
+    if (!Execute("BEGIN IMMEDIATE")) return false;
+
+    sqlite3_stmt* stmt = nullptr;
+
+    if (!CheckTable(table) || !Execute(query) ||
+        (stmt = Prepare(Form("UPDATE %s SET DATE = ? WHERE SERIES_ID = ?", table.Data()))) ==
+            nullptr)
+    {
+        Execute("ROLLBACK");
+        return false;
+    }
+
+    sqlite3_bind_int64(stmt, 1, (sqlite3_int64)time(nullptr));
+    sqlite3_bind_int(stmt, 2, seriesNo);
+
+    int status = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    if (!Check(status, "SaveQuery") || !Execute("COMMIT"))
+    {
+        Execute("ROLLBACK");
+        return false;
+    }
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Prints details of the SFResultsSink class object.
+void SFResultsSink::Print(void)
+{
+    std::cout << "\n-------------------------------------------" << std::endl;
+    std::cout << "This is print out of SFResultsSink class object" << std::endl;
+    std::cout << "Data base: " << fDatabase << std::endl;
+    std::cout << "Busy timeout: " << fBusyTimeout << " ms" << std::endl;
+    std::cout << "Number of prepared statements: " << fStatements.size() << std::endl;
+    std::cout << "-------------------------------------------\n" << std::endl;
+}
+//------------------------------------------------------------------
@@ -0,0 +1,249 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *          SFSeriesContext.cc           *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#include "SFSeriesContext.hh"
+#include "SFAttenuation.hh"
+#include "SFAttenuationModel.hh"
+
+#include <mutex>
+
+ClassImp(SFSeriesContext);
+
+/// Contexts which are currently in use, accessed by series number.
+static std::map<int, SFSeriesContext*> gContexts;
+/// Mutex protecting gContexts and reference counters of the contexts.
+static std::mutex gContextsMutex;
+
+//------------------------------------------------------------------
+/// Standard constructor. Creates SFData object of the series. Usually
+/// SFSeriesContext::Acquire() should be used instead, so that the context
+/// is shared between all analysis classes.
+/// \param seriesNo - number of the experimental series.
+SFSeriesContext::SFSeriesContext(int seriesNo) : fSeriesNo(seriesNo),
+                                                 fRefCount(0),
+                                                 fData(nullptr),
+                                                 fAtt(nullptr),
+                                                 fModel(nullptr)
+{
+    try
+    {
+        fData = new SFData(fSeriesNo);
+    }
+    catch (const char* message)
+    {
+        std::cerr << message << std::endl;
+        throw "##### Exception in SFSeriesContext constructor!";
+    }
+}
+//------------------------------------------------------------------
+/// Destructor. Deletes all objects owned by the context.
+SFSeriesContext::~SFSeriesContext()
+{
+    if (fModel != nullptr) delete fModel;
+    if (fAtt != nullptr) delete fAtt;
+
+    for (auto& pf : fPeakFin)
+        delete pf.second;
+
+    for (auto& spectra : fSpectra)
+    {
+        for (auto h : spectra.second)
+            delete h;
+    }
+
+    if (fData != nullptr) delete fData;
+}
+//------------------------------------------------------------------
+/// Returns context of the requested series and increments its reference
+/// counter. If the context doesn't exist yet it is created. Each call
+/// has to be balanced with SFSeriesContext::Release().
+/// \param seriesNo - number of the experimental series.
+SFSeriesContext* SFSeriesContext::Acquire(int seriesNo)
+{
+    std::lock_guard<std::mutex> lock(gContextsMutex);
+
+    SFSeriesContext* context = nullptr;
+
+    auto it = gContexts.find(seriesNo);
+
+    if (it == gContexts.end())
+    {
+        context             = new SFSeriesContext(seriesNo);
+        gContexts[seriesNo] = context;
+    }
+    else
+        context = it->second;
+
+    context->fRefCount++;
+
+    return context;
+}
+//------------------------------------------------------------------
+/// Increments reference counter of the context.
+void SFSeriesContext::Retain(void)
+{
+    std::lock_guard<std::mutex> lock(gContextsMutex);
+    fRefCount++;
+}
+//------------------------------------------------------------------
+/// Decrements reference counter of the context. Context is deleted when
+/// the last reference is released.
+void SFSeriesContext::Release(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(gContextsMutex);
+
+        fRefCount--;
+
+        if (fRefCount > 0) return;
+
+        auto it = gContexts.find(fSeriesNo);
+        if (it != gContexts.end() && it->second == this) gContexts.erase(it);
+    }
+
+    // deleted outside of the lock, destructors of owned objects may use contexts
+    delete this;
+}
+//------------------------------------------------------------------
+/// Returns spectra of the requested type for all measurements of the series.
+/// Spectra are drawn only once, subsequent calls return the same histograms.
+/// \param ch - channel number
+/// \param sel_type - predefined selection type (see SFDrawCommands)
+/// \param cut - cut for drawn events
+std::vector<TH1D*> SFSeriesContext::GetSpectra(int ch, SFSelectionType sel_type, TString cut)
+{
+    TString key = Form("spec_ch%i_sel%i_", ch, static_cast<int>(sel_type)) + cut;
+
+    auto it = fSpectra.find(key);
+    if (it != fSpectra.end()) return it->second;
+
+    std::vector<TH1D*> spectra = fData->GetSpectra(ch, sel_type, cut);
+    fSpectra[key]              = spectra;
+
+    return spectra;
+}
+//------------------------------------------------------------------
+/// Returns custom histograms of the requested type for all measurements of
+/// the series. Histograms are drawn only once, subsequent calls return the
+/// same histograms.
+/// \param sel_type - predefined selection type (see SFDrawCommands)
+/// \param cut - cut for drawn events
+std::vector<TH1D*> SFSeriesContext::GetCustomHistograms(SFSelectionType sel_type, TString cut)
+{
+    TString key = Form("custom_sel%i_", static_cast<int>(sel_type)) + cut;
+
+    auto it = fSpectra.find(key);
+    if (it != fSpectra.end()) return it->second;
+
+    std::vector<TH1D*> hists = fData->GetCustomHistograms(sel_type, cut);
+    fSpectra[key]            = hists;
+
+    return hists;
+}
+//------------------------------------------------------------------
+/// Returns single spectrum of the requested measurement. Spectra of all
+/// measurements of the series are drawn at the first call.
+/// \param ch - channel number
+/// \param sel_type - predefined selection type (see SFDrawCommands)
+/// \param cut - cut for drawn events
+/// \param ID - ID of the requested measurement
+TH1D* SFSeriesContext::GetSpectrum(int ch, SFSelectionType sel_type, TString cut, int ID)
+{
+    int index = SFTools::GetIndex(fData->GetMeasurementsIDs(), ID);
+    return GetSpectra(ch, sel_type, cut)[index];
+}
+//------------------------------------------------------------------
+/// Returns single custom histogram of the requested measurement. Histograms
+/// of all measurements of the series are drawn at the first call.
+/// \param sel_type - predefined selection type (see SFDrawCommands)
+/// \param cut - cut for drawn events
+/// \param ID - ID of the requested measurement
+TH1D* SFSeriesContext::GetCustomHistogram(SFSelectionType sel_type, TString cut, int ID)
+{
+    int index = SFTools::GetIndex(fData->GetMeasurementsIDs(), ID);
+    return GetCustomHistograms(sel_type, cut)[index];
+}
+//------------------------------------------------------------------
+/// Returns peak finder of the given spectrum. The 511 keV peak is fitted with
+/// SFPeakFinder::FindPeakFit() only once per spectrum.
+/// \param spectrum - analyzed spectrum
+SFPeakFinder* SFSeriesContext::GetPeakFinder(TH1D* spectrum)
+{
+    if (spectrum == nullptr)
+    {
+        std::cerr << "##### Error in SFSeriesContext::GetPeakFinder()!" << std::endl;
+        std::cerr << "Empty spectrum pointer!" << std::endl;
+        std::abort();
+    }
+
+    auto it = fPeakFin.find(spectrum);
+    if (it != fPeakFin.end()) return it->second;
+
+    SFPeakFinder* pf = new SFPeakFinder(spectrum, false);
+    pf->FindPeakFit();
+    fPeakFin[spectrum] = pf;
+
+    return pf;
+}
+//------------------------------------------------------------------
+/// Returns attenuation analysis of the series. The object is created at
+/// the first call and owned by the context.
+SFAttenuation* SFSeriesContext::GetAttenuation(void)
+{
+    if (fAtt != nullptr) return fAtt;
+
+    try
+    {
+        // owned objects must not keep the context alive
+        fAtt = new SFAttenuation(this, false);
+    }
+    catch (const char* message)
+    {
+        std::cerr << message << std::endl;
+        std::cerr << "##### Exception in SFSeriesContext::GetAttenuation()!" << std::endl;
+        std::abort();
+    }
+
+    return fAtt;
+}
+//------------------------------------------------------------------
+/// Returns attenuation model analysis of the series. The object is created
+/// at the first call and owned by the context.
+SFAttenuationModel* SFSeriesContext::GetAttenuationModel(void)
+{
+    if (fModel != nullptr) return fModel;
+
+    try
+    {
+        // owned objects must not keep the context alive
+        fModel = new SFAttenuationModel(this, false);
+    }
+    catch (const char* message)
+    {
+        std::cerr << message << std::endl;
+        std::cerr << "##### Exception in SFSeriesContext::GetAttenuationModel()!" << std::endl;
+        std::abort();
+    }
+
+    return fModel;
+}
+//------------------------------------------------------------------
+/// Prints details of the SFSeriesContext class object.
+void SFSeriesContext::Print(void)
+{
+    std::cout << "\n-------------------------------------------" << std::endl;
+    std::cout << "This is print out of SFSeriesContext class object" << std::endl;
+    std::cout << "Experimental series number " << fSeriesNo << std::endl;
+    std::cout << "Number of references: " << fRefCount << std::endl;
+    std::cout << "Number of cached histogram sets: " << fSpectra.size() << std::endl;
+    std::cout << "Number of fitted peaks: " << fPeakFin.size() << std::endl;
+    std::cout << "-------------------------------------------\n" << std::endl;
+}
+//------------------------------------------------------------------
@@ -16,7 +16,9 @@ ClassImp(SFTemperature);
 /// Standard constructor.
 /// \param seriesNo - number of the experimental series
 SFTemperature::SFTemperature(int seriesNo) : fSeriesNo(seriesNo),
-                                             fData(nullptr)
+                                             fData(nullptr),
+                                             fSeriesLoaded(false),
+                                             fDB(nullptr)
 {
 
     try
@@ -66,43 +68,85 @@ bool SFTemperature::OpenDataBase(void)
     return true;
 }
 //------------------------------------------------------------------
-/// Loads temperature readings saved in the data base for requested
-/// sensor and measurement. Loaded values are saved in fTime and 
-/// fTemperature vectors.
-/// \param sensor - sensor ID
-/// \param name - name of the measurement; if value "all" is given
-/// all temperature values for this series will be loaded
-bool SFTemperature::LoadFromDB(TString sensor, TString name)
+/// Loads all temperature readings of the series, for all sensors and
+/// all measurements, with a single query. Readings are grouped in memory
+/// by sensor ID and measurement name; additionally all readings of each
+/// sensor are stored in the order of the data base under the name "all".
+bool SFTemperature::LoadSeriesFromDB(void)
 {
 
     int           status = 0;
     sqlite3_stmt* statement;
 
-    if (!fTime.empty()) fTime.clear();
-    if (!fTemperatures.empty()) fTemperatures.clear();
+    status = sqlite3_prepare_v2(fDB,
+                                "SELECT SENSOR_ID, MEASUREMENT_NAME, TIME, TEMPERATURE "
+                                "FROM TEMPERATURES WHERE SERIES_ID = ?",
+                                -1, &statement, nullptr);
 
-    TString query;
-
-    if (name == "all")
-        query = Form("SELECT TIME, TEMPERATURE FROM TEMPERATURES WHERE SERIES_ID "
-                     "= %i AND SENSOR_ID = '%s'", fSeriesNo, sensor.Data());
-    else
-        query = Form("SELECT TIME, TEMPERATURE FROM TEMPERATURES WHERE SERIES_ID = %i AND "
-                     "SENSOR_ID = '%s' AND MEASUREMENT_NAME = '%s'",
-                     fSeriesNo, sensor.Data(), name.Data());
+    if (!SFTools::CheckDBStatus(status, fDB))
+    {
+        std::cerr << "##### Error in SFTemperature::LoadSeriesFromDB()!" << std::endl;
+        return false;
+    }
 
-    status = sqlite3_prepare_v2(fDB, query, -1, &statement, nullptr);
-    SFTools::CheckDBStatus(status, fDB);
+    sqlite3_bind_int(statement, 1, fSeriesNo);
 
     while ((status = sqlite3_step(statement)) == SQLITE_ROW)
     {
-        fTime.push_back(sqlite3_column_int(statement, 0));
-        fTemperatures.push_back(sqlite3_column_double(statement, 1));
+        const unsigned char* sensorText = sqlite3_column_text(statement, 0);
+        const unsigned char* nameText   = sqlite3_column_text(statement, 1);
+
+        TString sensor = sensorText == nullptr ? "" : reinterpret_cast<const char*>(sensorText);
+        TString name   = nameText == nullptr ? "" : reinterpret_cast<const char*>(nameText);
+        int     time   = sqlite3_column_int(statement, 2);
+        double  temp   = sqlite3_column_double(statement, 3);
+
+        fTimeSeries[sensor][name].push_back(time);
+        fTempSeries[sensor][name].push_back(temp);
+        fTimeSeries[sensor]["all"].push_back(time);
+        fTempSeries[sensor]["all"].push_back(temp);
     }
 
-    SFTools::CheckDBStatus(status, fDB);
     sqlite3_finalize(statement);
 
+    if (!SFTools::CheckDBStatus(status, fDB))
+    {
+        std::cerr << "##### Error in SFTemperature::LoadSeriesFromDB()!" << std::endl;
+        fTimeSeries.clear();
+        fTempSeries.clear();
+        return false;
+    }
+
+    fSeriesLoaded = true;
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Loads temperature readings saved in the data base for requested
+/// sensor and measurement. Loaded values are saved in fTime and
+/// fTemperature vectors. All readings of the series are fetched from
+/// the data base at the first call (see LoadSeriesFromDB()), subsequent
+/// calls only select them from memory.
+/// \param sensor - sensor ID
+/// \param name - name of the measurement; if value "all" is given
+/// all temperature values for this series will be loaded
+bool SFTemperature::LoadFromDB(TString sensor, TString name)
+{
+
+    if (!fTime.empty()) fTime.clear();
+    if (!fTemperatures.empty()) fTemperatures.clear();
+
+    if (!fSeriesLoaded && !LoadSeriesFromDB()) return false;
+
+    auto itrSensor = fTimeSeries.find(sensor);
+    if (itrSensor == fTimeSeries.end()) return true;
+
+    auto itrName = itrSensor->second.find(name);
+    if (itrName == itrSensor->second.end()) return true;
+
+    fTime         = itrName->second;
+    fTemperatures = fTempSeries[sensor][name];
+
     return true;
 }
 //------------------------------------------------------------------
@@ -93,21 +93,32 @@ bool SFTimeConst::SetDetails(int seriesNo, double PE, bool verb)
         return false;
     }
 
+    // signals of both channels are averaged in a single scan of each measurement
+    std::vector<SFSignalRequest> requests(2);
+
+    for (int ch = 0; ch < 2; ch++)
+    {
+        requests[ch].fCh     = ch;
+        requests[ch].fCut    = selection;
+        requests[ch].fNumber = nsig;
+        requests[ch].fBL     = true;
+    }
+
     for (int i = 0; i < npoints; i++)
     {
-        fSignalsCh0.push_back(fData->GetSignalAverage(0, measurementsIDs[i], selection, nsig, true));
+        fData->GetSignalAverages(measurementsIDs[i], requests);
+
+        fSignalsCh0.push_back(requests[0].fSignal);
         results_name = fSignalsCh0[i]->GetName();
         fFitResultsCh0.push_back(new SFFitResults(results_name));
 
-        fSignalsCh1.push_back(fData->GetSignalAverage(1, measurementsIDs[i], selection, nsig, true));
+        fSignalsCh1.push_back(requests[1].fSignal);
         results_name = fSignalsCh1[i]->GetName();
         fFitResultsCh1.push_back(new SFFitResults(results_name));
     }
     
     fResults = new SFResults(Form("TimeConstResults_S%i_PE%.2f", fSeriesNo, PE));
 
-    ROOT::Math::MinimizerOptions::SetDefaultMaxFunctionCalls(100000);
-
     return true;
 }
 //------------------------------------------------------------------
@@ -128,23 +139,15 @@ double funDecaySingle(double* x, double* par)
     return dec + constant;
 }
 //------------------------------------------------------------------
-/// This function performs fitting to the given TProfile signal.
-/// Single decay function if fitted to the falling slope of the signal.
-/// Results of the fit are subsequently written in the SFFitResults
-/// class object. Function returns true if fitting was successful and
-/// fit results are valid.
+/// Writes result of the decay fit of the given signal in the corresponding
+/// SFFitResults object. Fitted function is created from the fit result.
 /// \param signal - averaged signal (TProfile)
 /// \param ID - measurement ID
-bool SFTimeConst::FitDecayTimeSingle(TProfile* signal, int ID)
+/// \param fit - result of the fit (see SFDecayFitter)
+bool SFTimeConst::SetFitResults(TProfile* signal, int ID, const SFDecayFitResult& fit)
 {
 
-    TString opt;
-    if (fVerb)
-        opt = "R0";
-    else
-        opt = "QR0";
-
-    int ch = -1;
+    int     ch    = -1;
     TString hname = signal->GetName();
     if (hname.Contains("ch0"))
         ch = 0;
@@ -152,135 +155,111 @@ bool SFTimeConst::FitDecayTimeSingle(TProfile* signal, int ID)
         ch = 1;
     else
     {
-        std::cerr << "Error in SFTimeConst::FitDecayTimeSingle()!" << std::endl;
+        std::cerr << "##### Error in SFTimeConst::SetFitResults()!" << std::endl;
         std::cerr << "Could not interpret signal name!" << std::endl;
         return false;
     }
 
-    std::vector<int> measurementsIDs = fData->GetMeasurementsIDs();
-    int    index = SFTools::GetIndex(measurementsIDs, ID);
-    double xmin  = signal->GetBinCenter(signal->GetMaximumBin()) + 20.;
-    double xmax  = signal->GetBinCenter(signal->GetNbinsX());
-
-    TF1* fun_BL = new TF1("fun_BL", "pol0", 0, 50);
-    signal->Fit(fun_BL, opt);
-
-    TF1* fun_dec = new TF1("fun_dec", "[0]*exp(-(x-[1])/[2])", xmin, xmin + 100);
-    fun_dec->SetParameters(100., 100., 10.);
-    fun_dec->SetParNames("A", "t0", "tau");
-    signal->Fit(fun_dec, opt);
+    if (fit.fParameters.empty())
+    {
+        std::cerr << "##### Error in SFTimeConst::SetFitResults()!" << std::endl;
+        std::cerr << "Signal " << hname << " could not be fitted!" << std::endl;
+        return false;
+    }
 
-    TF1* fun_all = new TF1("fall", funDecaySingle, xmin, xmax, 4);
+    std::vector<int> measurementsIDs = fData->GetMeasurementsIDs();
+    int              index           = SFTools::GetIndex(measurementsIDs, ID);
+    int              npar            = fit.fParameters.size();
 
-    fun_all->SetParNames("A", "t0", "tau", "const");
-    fun_all->SetParameter(0, fun_dec->GetParameter(0));
-    fun_all->SetParameter(1, fun_dec->GetParameter(1));
-    fun_all->SetParameter(2, fun_dec->GetParameter(2));
-    fun_all->FixParameter(3, fun_BL->GetParameter(0));
-    int fitStat = signal->Fit(fun_all, opt);
+    TF1* fun_all = nullptr;
 
-    if (fitStat != 0)
+    if (npar == 4)
+    {
+        fun_all = new TF1("fall", funDecaySingle, fit.fXmin, fit.fXmax, npar);
+        fun_all->SetParNames("A", "t0", "tau", "const");
+    }
+    else
     {
-        std::cerr << "##### Warning in SFTimeConst::FitDecayTimeSingle()" << std::endl;
-        std::cerr << "\t fit status: " << fitStat << std::endl;
+        fun_all = new TF1("fall", funDecayDouble, fit.fXmin, fit.fXmax, npar);
+        fun_all->SetParNames("A_fast", "t0", "tau_fast", "A_slow", "tau_slow", "const");
     }
 
-    if (ch == 0)
+    for (int i = 0; i < npar; i++)
     {
-        fFitResultsCh0[index]->SetFromFunction(fun_all);
-        if (fitStat != 0) fFitResultsCh0[index]->SetStat(-1);
-        fFitResultsCh0[index]->Print();
+        fun_all->SetParameter(i, fit.fParameters[i]);
+        fun_all->SetParError(i, fit.fParErrors[i]);
     }
-    else if (ch == 1)
+
+    fun_all->FixParameter(1, fit.fParameters[1]);
+    fun_all->FixParameter(npar - 1, fit.fParameters[npar - 1]);
+    fun_all->SetChisquare(fit.fChi2);
+    fun_all->SetNDF(fit.fNDF);
+    fun_all->SetNumberFitPoints(fit.fNpoints);
+
+    if (fit.fStat != 0)
     {
-        fFitResultsCh1[index]->SetFromFunction(fun_all);
-        if (fitStat != 0) fFitResultsCh1[index]->SetStat(-1);
-        fFitResultsCh1[index]->Print();
+        std::cerr << "##### Warning in SFTimeConst::SetFitResults()" << std::endl;
+        std::cerr << "\t fit status: " << fit.fStat << std::endl;
     }
 
+    SFFitResults* results = ch == 0 ? fFitResultsCh0[index] : fFitResultsCh1[index];
+
+    results->SetFromFunction(fun_all);
+    if (fit.fStat != 0) results->SetStat(-1);
+    results->Print();
+
     return true;
 }
 //------------------------------------------------------------------
-/// This function performs fitting to the given TProfile signal.
-/// Double decay function if fitted to the falling slope of the signal.
-/// Results of the fit are subsequently written in the SFFitResults
-/// class object. Function returns true if fitting was successful and
-/// fit results are valid.
-/// \param signal - averaged signal (TProfile)
-/// \param ID - measurement ID
-bool SFTimeConst::FitDecayTimeDouble(TProfile* signal, int ID)
+/// Fits decay function to all given signals. Signals are fitted in
+/// parallel (see SFTools::SetNThreads()) and results are written in the
+/// SFFitResults objects afterwards.
+/// \param signals - averaged signals
+/// \param IDs - measurement IDs of the signals
+/// \param components - number of decay components: 1 or 2
+bool SFTimeConst::FitSignals(std::vector<TProfile*> signals, std::vector<int> IDs,
+                             int components)
 {
 
-    TString opt;
-    if (fVerb)
-        opt = "R0";
-    else
-        opt = "QR0";
+    SFDecayFitter                 fitter(components);
+    std::vector<SFDecayFitResult> fits(signals.size());
 
-    int     ch    = -1;
-    TString hname = signal->GetName();
-    if (hname.Contains("ch0"))
-        ch = 0;
-    else if (hname.Contains("ch1"))
-        ch = 1;
-    else
-    {
-        std::cerr << "##### Error in SFTimeConst::FitDecayTimeDouble()!" << std::endl;
-        std::cerr << "Could not interpret signal name!" << std::endl;
-        return false;
-    }
+    SFTools::ParallelFor(signals.size(), [&](int i) { fits[i] = fitter.Fit(signals[i]); });
 
-    std::vector<int> measurementsIDs = fData->GetMeasurementsIDs();
-    int              index           = SFTools::GetIndex(measurementsIDs, ID);
-    double           xmin            = signal->GetBinCenter(signal->GetMaximumBin()) + 20;
-    double           xmax            = signal->GetBinCenter(signal->GetNbinsX());
-
-    TF1* fun_BL = new TF1("fun_BL", "pol0", 0, 50);
-    signal->Fit(fun_BL, opt);
-
-    TF1* fun_fast = new TF1("fun_fast", "[0]*exp(-(x-[1])/[2])", xmin, xmin + 130);
-    fun_fast->SetParameters(100., 100., 10.);
-    fun_fast->SetParNames("A", "t0", "tau");
-    signal->Fit(fun_fast, opt);
-
-    TF1* fun_slow = new TF1("fun_slow", "[0]*exp(-(x-[1])/[2])", 400, xmax);
-    fun_slow->SetParameters(100., 100., 400.);
-    fun_slow->SetParNames("A", "t0", "tau");
-    fun_slow->FixParameter(1, fun_fast->GetParameter(1));
-    signal->Fit(fun_slow, opt);
-
-    TF1* fun_all = new TF1("fall", funDecayDouble, xmin, xmax, 6);
-
-    fun_all->SetParNames("A_fast", "t0", "tau_fast", "A_slow", "tau_slow", "const");
-    fun_all->SetParameter(0, fun_fast->GetParameter(0));
-    fun_all->FixParameter(1, fun_fast->GetParameter(1));
-    fun_all->SetParameter(2, fun_fast->GetParameter(2));
-    fun_all->SetParameter(3, fun_slow->GetParameter(0));
-    fun_all->SetParameter(4, fun_slow->GetParameter(2));
-    fun_all->FixParameter(5, fun_BL->GetParameter(0));
-    fun_all->FixParameter(1, xmin - 20);
-    int fitStat = signal->Fit(fun_all, opt);
-
-    if (fitStat != 0)
-    {
-        std::cerr << "##### Warning in SFTimeConst::FitDecayTimeDouble()" << std::endl;
-        std::cerr << "\t fit status: " << fitStat << std::endl;
-    }
+    bool stat = true;
 
-    if (ch == 0)
-    {
-        fFitResultsCh0[index]->SetFromFunction(fun_all);
-        if (fitStat != 0) fFitResultsCh0[index]->SetStat(-1);
-        fFitResultsCh0[index]->Print();
-    }
-    else if (ch == 1)
-    {
-        fFitResultsCh1[index]->SetFromFunction(fun_all);
-        if (fitStat != 0) fFitResultsCh1[index]->SetStat(-1);
-        fFitResultsCh1[index]->Print();
-    }
+    for (size_t i = 0; i < signals.size(); i++)
+        stat = SetFitResults(signals[i], IDs[i], fits[i]) && stat;
 
-    return true;
+    return stat;
+}
+//------------------------------------------------------------------
+/// This function performs fitting to the given TProfile signal.
+/// Single decay function if fitted to the falling slope of the signal
+/// (see SFDecayFitter). Results of the fit are subsequently written in
+/// the SFFitResults class object. Function returns true if fitting was
+/// successful and fit results are valid.
+/// \param signal - averaged signal (TProfile)
+/// \param ID - measurement ID
+bool SFTimeConst::FitDecayTimeSingle(TProfile* signal, int ID)
+{
+
+    SFDecayFitter fitter(1);
+    return SetFitResults(signal, ID, fitter.Fit(signal));
+}
+//------------------------------------------------------------------
+/// This function performs fitting to the given TProfile signal.
+/// Double decay function if fitted to the falling slope of the signal
+/// (see SFDecayFitter). Results of the fit are subsequently written in
+/// the SFFitResults class object. Function returns true if fitting was
+/// successful and fit results are valid.
+/// \param signal - averaged signal (TProfile)
+/// \param ID - measurement ID
+bool SFTimeConst::FitDecayTimeDouble(TProfile* signal, int ID)
+{
+
+    SFDecayFitter fitter(2);
+    return SetFitResults(signal, ID, fitter.Fit(signal));
 }
 //------------------------------------------------------------------
 /// Fits all signals of the analyzed series from both channels.
@@ -293,21 +272,19 @@ bool SFTimeConst::FitAllSignals(void)
     std::vector<int> measurementsIDs = fData->GetMeasurementsIDs();
     TString          fiber           = fData->GetFiber();
 
+    //----- signals of both channels are fitted together
+    std::vector<TProfile*> signals = fSignalsCh0;
+    std::vector<int>       IDs     = measurementsIDs;
+    signals.insert(signals.end(), fSignalsCh1.begin(), fSignalsCh1.end());
+    IDs.insert(IDs.end(), measurementsIDs.begin(), measurementsIDs.end());
+
     if (fiber.Contains("LuAG") || fiber.Contains("GAGG"))
     {
-        for (int i = 0; i < n; i++)
-        {
-            FitDecayTimeDouble(fSignalsCh0[i], measurementsIDs[i]);
-            FitDecayTimeDouble(fSignalsCh1[i], measurementsIDs[i]);
-        }
+        FitSignals(signals, IDs, 2);
     }
     else if (fiber.Contains("LYSO"))
     {
-        for (int i = 0; i < n; i++)
-        {
-            FitDecayTimeSingle(fSignalsCh0[i], measurementsIDs[i]);
-            FitDecayTimeSingle(fSignalsCh1[i], measurementsIDs[i]);
-        }
+        FitSignals(signals, IDs, 1);
     }
     else
     {
@@ -472,36 +449,25 @@ bool SFTimeConst::FitAllSignals(void)
 bool SFTimeConst::FitAllSignals(int ch)
 {
 
-    int              n               = fData->GetNpoints();
     std::vector<int> measurementsIDs = fData->GetMeasurementsIDs();
     TString          fiber           = fData->GetFiber();
 
-    if (ch != 0 || ch != 1)
+    if (ch != 0 && ch != 1)
     {
         std::cerr << "##### Error in SFTimeConst::FitAllSignals()!" << std::endl;
         std::cerr << "Incorrect channel number. Possible options: 0 or 1" << std::endl;
         return false;
     }
 
+    std::vector<TProfile*> signals = ch == 0 ? fSignalsCh0 : fSignalsCh1;
+
     if (fiber.Contains("LuAG") || fiber.Contains("GAGG"))
     {
-        for (int i = 0; i < n; i++)
-        {
-            if (ch == 0)
-                FitDecayTimeDouble(fSignalsCh0[i], measurementsIDs[i]);
-            else if (ch == 1)
-                FitDecayTimeDouble(fSignalsCh1[i], measurementsIDs[i]);
-        }
+        FitSignals(signals, measurementsIDs, 2);
     }
     else if (fiber.Contains("LYSO"))
     {
-        for (int i = 0; i < n; i++)
-        {
-            if (ch == 0)
-                FitDecayTimeSingle(fSignalsCh0[i], measurementsIDs[i]);
-            else if (ch == 1)
-                FitDecayTimeSingle(fSignalsCh1[i], measurementsIDs[i]);
-        }
+        FitSignals(signals, measurementsIDs, 1);
     }
     else
     {
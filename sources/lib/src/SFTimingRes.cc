@@ -50,7 +50,6 @@ SFTimingRes::~SFTimingRes()
 /// is fitted to the histograms.
 bool SFTimingRes::LoadRatios(void)
 {
-    int     npoints    = fData->GetNpoints();
     TString collimator = fData->GetCollimator();
     TString sipm       = fData->GetSiPM();
     TString testBench  = fData->GetTestBench();
@@ -70,19 +69,14 @@ bool SFTimingRes::LoadRatios(void)
         fRatios = fData->GetCustomHistograms(SFSelectionType::kLogSqrtPERatio, cut);
     }
 
-    std::vector<TF1*> fun;
-
-    for (int i = 0; i < npoints; i++)
+    if (collimator.Contains("Lead")) { SFTools::RatiosFitDoubleGauss(fRatios, 5); }
+    else if (collimator.Contains("Electronic") && sipm.Contains("SensL"))
     {
-        if (collimator.Contains("Lead")) { SFTools::RatiosFitDoubleGauss(fRatios, 5); }
-        else if (collimator.Contains("Electronic") && sipm.Contains("SensL"))
-        {
-            SFTools::RatiosFitDoubleGauss(fRatios, 2);
-        }
-        else if (collimator.Contains("Electronic") && sipm.Contains("Hamamatsu"))
-        {
-            SFTools::RatiosFitGauss(fRatios, 1);
-        }
+        SFTools::RatiosFitDoubleGauss(fRatios, 2);
+    }
+    else if (collimator.Contains("Electronic") && sipm.Contains("Hamamatsu"))
+    {
+        SFTools::RatiosFitGauss(fRatios, 1);
     }
 
     return true;
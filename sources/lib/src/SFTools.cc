@@ -9,6 +9,25 @@
 // *****************************************
 
 #include "SFTools.hh"
+#include "SFResultsSink.hh"
+
+#include <Fit/BinData.h>
+#include <Fit/Fitter.h>
+#include <HFitInterface.h>
+#include <Math/WrappedMultiTF1.h>
+#include <TROOT.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+/// Number of threads used for processing of independent measurements.
+static int gNThreads = 1;
+
+/// Size of TTreeCache of trees read with selected branches [bytes].
+static const Long64_t gTreeCacheSize = 64 * 1024 * 1024;
+/// Number of entries after which TTreeCache stops learning read branches.
+static const int gTreeCacheLearnEntries = 10;
 
 //------------------------------------------------------------------
 /// Returns index of given measurement. Index is found based on measurement
@@ -315,7 +334,10 @@ bool SFTools::CheckDBStatus(int status, sqlite3* database)
     return stat;
 }
 //------------------------------------------------------------------
-/// Adds an entry to the results data base.
+/// Adds an entry to the results data base. Entry is written via
+/// SFResultsSink, i.e. with the shared connection and in a single
+/// transaction together with the date. New code should use
+/// SFResultsSink::Save() directly.
 /// \param database - results data base
 /// \param table - name of the table in the data base where the entry
 /// will be written; if table doesn't exist in the given data base
@@ -324,111 +346,62 @@ bool SFTools::CheckDBStatus(int status, sqlite3* database)
 /// \param seriesNo - number of the experimental series of the entry
 bool SFTools::SaveResultsDB(TString database, TString table, TString query, int seriesNo)
 {
+    SFResultsSink* sink = SFResultsSink::Open(database);
+    if (sink == nullptr) return false;
 
-    std::cout << "----- Saving results in the databse: " << database << std::endl;
-    std::cout << "----- Accessing table: " << table << std::endl;
+    return sink->SaveQuery(table, query, seriesNo);
+}
+//------------------------------------------------------------------
+/// Adds a table in the given results data base.
+/// \param database - results data base
+/// \param table - name of the table
+bool SFTools::CreateTable(TString database, TString table)
+{
 
-    sqlite3* resultsDB;
-    int      status = -1;
+    std::cout << "----- Creating new table: " << table << std::endl;
+    std::cout << "----- Data base: " << database << std::endl;
 
+    sqlite3*      resultsDB;
+    int           status = -1;
     sqlite3_stmt* statement;
-    time_t        now = time(nullptr);
-    ctime(&now);
+    TString       query;
 
-    //--- opening data base
+    query = GetTableSchema(table);
+    if (query == "") return false;
 
-    status = sqlite3_open(database, &resultsDB);
-    if (!CheckDBStatus(status, resultsDB)) return false;
-
-    //--- checking whether table exists
-    TString table_query =
-        Form("SELECT name FROM sqlite_master WHERE type='table' AND name='%s'", table.Data());
+    std::cout << query << std::endl;
 
-    status = sqlite3_prepare_v2(resultsDB, table_query, -1, &statement, nullptr);
+    //--- opening data base
+    status = sqlite3_open(database, &resultsDB);
+    std::cout << "SFTools::CreateTable() status#1: " << status << std::endl;
     if (!CheckDBStatus(status, resultsDB)) return false;
 
-    int table_stat = 0;
-
-    while ((sqlite3_step(statement) == SQLITE_ROW))
-    {
-        // table_stat = sqlite3_column_int(statement, 0);
-        table_stat++;
-    }
-
-    std::cout << "Table stat = " << table_stat << std::endl;
-
-    sqlite3_finalize(statement);
-
-    bool      ct_stat   = 0;
-    const int max_tries = 10;
-    int       i_try     = max_tries;
-    float     wait      = 0;
-
-    srand(time(NULL));
-
-    if (table_stat == 0)
-    {
-        do
-        {
-            std::cout << "----- SFTools::SaveResultsDB, trying to create table" << std::endl;
-            std::cout << "----- Try number " << (max_tries - i_try) + 1 << std::endl;
-            ct_stat = CreateTable(database, table);
-
-            if (ct_stat) break;
-
-            --i_try;
-            wait = rand() % 10 + 1;
-            std::cout << "----- SFTools::SaveResultsDB, trying to create table, database locked..."
-                      << std::endl;
-            std::cout << "----- Waiting " << wait << " s" << std::endl;
-            sleep(wait);
-        } while (i_try > 0);
-    }
-
-    //--- executing given query
+    //--- creating table
     status = sqlite3_prepare_v2(resultsDB, query, -1, &statement, nullptr);
+    std::cout << "SFTools::CreateTable() status#2: " << status << std::endl;
     if (!CheckDBStatus(status, resultsDB)) return false;
 
     status = sqlite3_step(statement);
-    if (!CheckDBStatus(status, resultsDB)) return false;
-
-    sqlite3_finalize(statement);
-
-    //--- adding time
-    TString time_query = Form("UPDATE %s SET DATE = %lld WHERE SERIES_ID = %i", table.Data(),
-                              (long long)now, seriesNo);
-
-    status = sqlite3_prepare_v2(resultsDB, time_query, -1, &statement, nullptr);
-    if (!CheckDBStatus(status, resultsDB)) return false;
-
-    status = sqlite3_step(statement);
+    std::cout << "SFTools::CreateTable() status#3: " << status << std::endl;
     if (!CheckDBStatus(status, resultsDB)) return false;
 
     sqlite3_finalize(statement);
 
     //--- closing data base
     status = sqlite3_close_v2(resultsDB);
+    std::cout << "SFTools::CreateTable() status#4: " << status << std::endl;
     if (!CheckDBStatus(status, resultsDB)) return false;
 
-    std::cout << query << std::endl;
-    std::cout << time_query << std::endl;
-
     return true;
 }
 //------------------------------------------------------------------
-/// Adds a table in the given results data base.
-/// \param database - results data base
+/// Returns query creating the given table of the results data base.
+/// If the table is unknown, empty string is returned.
 /// \param table - name of the table
-bool SFTools::CreateTable(TString database, TString table)
+TString SFTools::GetTableSchema(TString table)
 {
 
-    std::cout << "----- Creating new table: " << table << std::endl;
-    std::cout << "----- Data base: " << database << std::endl;
-
-    sqlite3*      resultsDB;
-    int           status = -1;
-    sqlite3_stmt* statement;
-    TString       query;
+    TString query;
 
     if (table == "DATA")
     {
@@ -533,35 +506,12 @@ bool SFTools::CreateTable(TString database, TString table)
     }
     else
     {
-        std::cerr << "##### Error in SFTools::CreateTable()!" << std::endl;
-        std::cerr << "Unknown table!" << std::endl;
-        return false;
+        std::cerr << "##### Error in SFTools::GetTableSchema()!" << std::endl;
+        std::cerr << "Unknown table: " << table << std::endl;
+        return "";
     }
 
-    std::cout << query << std::endl;
-
-    //--- opening data base
-    status = sqlite3_open(database, &resultsDB);
-    std::cout << "SFTools::CreateTable() status#1: " << status << std::endl;
-    if (!CheckDBStatus(status, resultsDB)) return false;
-
-    //--- creating table
-    status = sqlite3_prepare_v2(resultsDB, query, -1, &statement, nullptr);
-    std::cout << "SFTools::CreateTable() status#2: " << status << std::endl;
-    if (!CheckDBStatus(status, resultsDB)) return false;
-
-    status = sqlite3_step(statement);
-    std::cout << "SFTools::CreateTable() status#3: " << status << std::endl;
-    if (!CheckDBStatus(status, resultsDB)) return false;
-
-    sqlite3_finalize(statement);
-
-    //--- closing data base
-    status = sqlite3_close_v2(resultsDB);
-    std::cout << "SFTools::CreateTable() status#4: " << status << std::endl;
-    if (!CheckDBStatus(status, resultsDB)) return false;
-
-    return true;
+    return query;
 }
 //------------------------------------------------------------------
 /// Calculates mean value of numbers stored in a given vector.
@@ -809,96 +759,364 @@ bool SFTools::FitGaussSingle(TH1D* h, float range_in_RMS)
     return true;
 }
 //------------------------------------------------------------------
-/// Fits charge ratio histograms with single gaussian function. 
-/// \param vec - vector containing charge ratio histograms
-/// \param range_in_RMS - fitting range expressed in RMS i.e. value 1
-/// gives fitting range from (mean-1*RMS) to (mean+1*RMS)
-bool SFTools::RatiosFitGauss(std::vector<TH1D*>& vec, float range_in_RMS)
+/// Creates function fitted to the charge ratio histogram, with the starting
+/// values of the parameters. Function is named fGauss or fDGauss, depending on
+/// the model, and it is not added to the global list of functions, so that
+/// functions of many histograms can be fitted concurrently.
+/// \param h - charge ratio histogram
+/// \param model - fitted model
+/// \param range_in_RMS - fitting range expressed in RMS
+/// \param left - if true second component of the double Gaussian model is
+/// expected on the left side of the main peak, otherwise on the right side
+static TF1* CreateRatioFunction(TH1D* h, SFRatioModel model, float range_in_RMS, bool left)
 {
+    double mean    = h->GetMean();
+    double rms     = h->GetRMS();
+    double fit_min = mean - (range_in_RMS * rms);
+    double fit_max = mean + (range_in_RMS * rms);
 
-    std::cout << "\n\n----- SFTools::RatiosFitGauss() fitting...\n" << std::endl;
+    if (model == SFRatioModel::kGauss)
+    {
+        TF1* fun = new TF1("fGauss", "gaus", fit_min, fit_max, TF1::EAddToList::kNo);
+        fun->SetParameters(h->GetBinContent(h->GetMaximumBin()), mean, rms);
+        return fun;
+    }
 
-    std::vector<TF1*> fGauss;
+    TF1* fun = new TF1("fDGauss", "gaus(0)+gaus(3)", fit_min, fit_max, TF1::EAddToList::kNo);
+    fun->SetParameter(0, h->GetBinContent(h->GetMaximumBin()));
+    fun->SetParameter(1, mean);
+    fun->SetParameter(2, 6E-2);
+    fun->SetParameter(3, h->GetBinContent(h->GetMaximumBin()) / 10.);
+    if (left)
+        fun->SetParameter(4, mean - rms);
+    else
+        fun->SetParameter(4, mean + rms);
+    fun->SetParameter(5, 6E-1);
+    fun->SetParLimits(5, 0, 0.5);
 
-    int    nsize   = vec.size();
+    return fun;
+}
+//------------------------------------------------------------------
+/// Fits function to the charge ratio histogram in the range of the function,
+/// like TH1::Fit() with options "RQ". Fit is performed with a separate
+/// ROOT::Fit::Fitter and Minuit2 minimizer, so that it can be called from
+/// many threads for different histograms. Fitted parameters are stored in
+/// the function. Returns false if the fit failed.
+/// \param h - charge ratio histogram
+/// \param fun - fitted function
+static bool FitRatio(TH1D* h, TF1* fun)
+{
     double fit_min = 0;
     double fit_max = 0;
-    double mean    = 0;
-    double rms     = 0;
+    fun->GetRange(fit_min, fit_max);
 
-    for (int i = 0; i < nsize; i++)
+    ROOT::Fit::DataOptions opt;
+    ROOT::Fit::DataRange   range(fit_min, fit_max);
+    ROOT::Fit::BinData     data(opt, range);
+    ROOT::Fit::FillData(data, h, fun);
+
+    ROOT::Math::WrappedMultiTF1 wf(*fun, 1);
+    ROOT::Fit::Fitter           fitter;
+    fitter.Config().SetMinimizer("Minuit2");
+    fitter.SetFunction(wf, false);
+
+    int npar = fun->GetNpar();
+
+    for (int i = 0; i < npar; i++)
     {
-        mean    = vec[i]->GetMean();
-        rms     = vec[i]->GetRMS();
-        fit_min = mean - (range_in_RMS * rms);
-        fit_max = mean + (range_in_RMS * rms);
-        fGauss.push_back(new TF1("fGauss", "gaus", fit_min, fit_max));
-        fGauss[i]->SetParameters(vec[i]->GetBinContent(vec[i]->GetMaximumBin()), mean, rms);
-        vec[i]->Fit(fGauss[i], "RQ+");
-
-        std::cout << "\tFitting histogram " << vec[i]->GetName() << " ..." << std::endl;
-        std::cout << "\t\tConst = " << fGauss[i]->GetParameter(0) << " +/- "
-                  << fGauss[i]->GetParError(0) << "\tMean = " << fGauss[i]->GetParameter(1)
-                  << " +/- " << fGauss[i]->GetParError(1)
-                  << "\tSigma = " << fGauss[i]->GetParameter(2) << " +/- "
-                  << fGauss[i]->GetParError(2) << "\n"
+        double par_min = 0;
+        double par_max = 0;
+        fun->GetParLimits(i, par_min, par_max);
+
+        if (par_min < par_max)
+            fitter.Config().ParSettings(i).SetLimits(par_min, par_max);
+        else if (par_min == par_max && par_min != 0)
+            fitter.Config().ParSettings(i).Fix();
+    }
+
+    bool stat = fitter.Fit(data);
+    fun->SetFitResult(fitter.Result());
+
+    return stat;
+}
+//------------------------------------------------------------------
+/// Checks whether the charge ratio histogram has already been fitted with
+/// the given model in the given range. Fitted function is stored with the
+/// histogram, so the check is never affected by deleted histograms.
+/// \param h - charge ratio histogram
+/// \param model - fitted model
+/// \param range_in_RMS - fitting range expressed in RMS
+static bool IsRatioFitted(TH1D* h, SFRatioModel model, float range_in_RMS)
+{
+    TString fun_name = model == SFRatioModel::kGauss ? "fGauss" : "fDGauss";
+    double  mean     = h->GetMean();
+    double  rms      = h->GetRMS();
+    double  fit_min  = mean - (range_in_RMS * rms);
+    double  fit_max  = mean + (range_in_RMS * rms);
+
+    for (auto obj : *h->GetListOfFunctions())
+    {
+        if (fun_name != obj->GetName() || !obj->InheritsFrom(TF1::Class())) continue;
+
+        double fun_min = 0;
+        double fun_max = 0;
+        ((TF1*)obj)->GetRange(fun_min, fun_max);
+
+        if (fun_min == fit_min && fun_max == fit_max) return true;
+    }
+
+    return false;
+}
+//------------------------------------------------------------------
+/// Prints parameters of the function fitted to the charge ratio histogram.
+/// \param h - charge ratio histogram
+/// \param model - fitted model
+static void PrintRatioFit(TH1D* h, SFRatioModel model)
+{
+    std::cout << "\tFitting histogram " << h->GetName() << " ..." << std::endl;
+
+    if (model == SFRatioModel::kGauss)
+    {
+        TF1* fun = h->GetFunction("fGauss");
+        std::cout << "\t\tConst = " << fun->GetParameter(0) << " +/- "
+                  << fun->GetParError(0) << "\tMean = " << fun->GetParameter(1)
+                  << " +/- " << fun->GetParError(1)
+                  << "\tSigma = " << fun->GetParameter(2) << " +/- "
+                  << fun->GetParError(2) << "\n"
                   << std::endl;
     }
+    else
+    {
+        TF1* fun = h->GetFunction("fDGauss");
+        std::cout << "\tFirst component:" << std::endl;
+        std::cout << "\t\tConst = " << fun->GetParameter(0) << " +/- "
+                  << fun->GetParError(0) << "\tMean = " << fun->GetParameter(1)
+                  << " +/- " << fun->GetParError(1)
+                  << "\tSigma = " << fun->GetParameter(2) << " +/- "
+                  << fun->GetParError(2) << std::endl;
+        std::cout << "\tSecond component:" << std::endl;
+        std::cout << "\t\tConst = " << fun->GetParameter(3) << " +/- "
+                  << fun->GetParError(3) << "\tMean = " << fun->GetParameter(4)
+                  << " +/- " << fun->GetParError(4)
+                  << "\tSigma = " << fun->GetParameter(5) << " +/- "
+                  << fun->GetParError(5) << "\n"
+                  << std::endl;
+    }
+}
+//------------------------------------------------------------------
+/// Fits charge ratio histograms with single gaussian function. 
+/// See SFTools::RatiosFit().
+/// \param vec - vector containing charge ratio histograms
+/// \param range_in_RMS - fitting range expressed in RMS i.e. value 1
+/// gives fitting range from (mean-1*RMS) to (mean+1*RMS)
+bool SFTools::RatiosFitGauss(std::vector<TH1D*>& vec, float range_in_RMS)
+{
+    std::cout << "\n\n----- SFTools::RatiosFitGauss() fitting...\n" << std::endl;
 
-    return true;
+    return RatiosFit(vec, SFRatioModel::kGauss, range_in_RMS);
 }
 //------------------------------------------------------------------
 /// Fits charge ratio histograms with a sum of two gaussian functions. 
+/// See SFTools::RatiosFit().
 /// \param vec - vector containing charge ratio histograms
 /// \param range_in_RMS - fitting range expressed in RMS i.e. value 1
 /// gives fitting range from (mean-1*RMS) to (mean+1*RMS)
 bool SFTools::RatiosFitDoubleGauss(std::vector<TH1D*>& vec, float range_in_RMS)
 {
-
     std::cout << "\n\n----- SFTools::RatiosFitDoubleGauss() fitting...\n" << std::endl;
 
-    std::vector<TF1*> fDGauss;
+    return RatiosFit(vec, SFRatioModel::kDoubleGauss, range_in_RMS);
+}
+//------------------------------------------------------------------
+/// Fits charge ratio histograms with the given model. Histograms which have
+/// already been fitted with the same model and fitting range (see
+/// IsRatioFitted()) are not fitted again. Fits of different histograms are
+/// independent and are distributed between SFTools::GetNThreads() threads;
+/// functions are created and attached to the histograms in the calling
+/// thread. Fitted parameters are printed in order of the histograms once
+/// all fits are done.
+/// \param vec - vector containing charge ratio histograms
+/// \param model - fitted model
+/// \param range_in_RMS - fitting range expressed in RMS i.e. value 1
+/// gives fitting range from (mean-1*RMS) to (mean+1*RMS)
+bool SFTools::RatiosFit(std::vector<TH1D*>& vec, SFRatioModel model, float range_in_RMS)
+{
+    int nsize = vec.size();
 
-    int    nsize   = vec.size();
-    double fit_min = 0;
-    double fit_max = 0;
-    double mean    = 0;
-    double rms     = 0;
+    std::vector<int>  todo;
+    std::vector<TF1*> funs;
 
     for (int i = 0; i < nsize; i++)
     {
-        mean    = vec[i]->GetMean();
-        rms     = vec[i]->GetRMS();
-        fit_min = mean - (range_in_RMS * rms);
-        fit_max = mean + (range_in_RMS * rms);
-        fDGauss.push_back(new TF1("fDGauss", "gaus(0)+gaus(3)", fit_min, fit_max));
-        fDGauss[i]->SetParameter(0, vec[i]->GetBinContent(vec[i]->GetMaximumBin()));
-        fDGauss[i]->SetParameter(1, mean);
-        fDGauss[i]->SetParameter(2, 6E-2);
-        fDGauss[i]->SetParameter(3, vec[i]->GetBinContent(vec[i]->GetMaximumBin()) / 10.);
-        if (i < nsize / 2)
-            fDGauss[i]->SetParameter(4, mean - rms);
-        else
-            fDGauss[i]->SetParameter(4, mean + rms);
-        fDGauss[i]->SetParameter(5, 6E-1);
-        fDGauss[i]->SetParLimits(5, 0, 0.5);
-        vec[i]->Fit(fDGauss[i], "QR+");
-
-        std::cout << "\tFitting histogram " << vec[i]->GetName() << " ..." << std::endl;
-        std::cout << "\tFirst component:" << std::endl;
-        std::cout << "\t\tConst = " << fDGauss[i]->GetParameter(0) << " +/- "
-                  << fDGauss[i]->GetParError(0) << "\tMean = " << fDGauss[i]->GetParameter(1)
-                  << " +/- " << fDGauss[i]->GetParError(1)
-                  << "\tSigma = " << fDGauss[i]->GetParameter(2) << " +/- "
-                  << fDGauss[i]->GetParError(2) << std::endl;
-        std::cout << "\tSecond component:" << std::endl;
-        std::cout << "\t\tConst = " << fDGauss[i]->GetParameter(3) << " +/- "
-                  << fDGauss[i]->GetParError(3) << "\tMean = " << fDGauss[i]->GetParameter(4)
-                  << " +/- " << fDGauss[i]->GetParError(4)
-                  << "\tSigma = " << fDGauss[i]->GetParameter(5) << " +/- "
-                  << fDGauss[i]->GetParError(5) << "\n"
-                  << std::endl;
+        if (vec[i] == nullptr)
+        {
+            std::cerr << "##### Error in SFTools::RatiosFit()! Histogram " << i
+                      << " is a null pointer!" << std::endl;
+            for (auto fun : funs)
+                delete fun;
+            return false;
+        }
+
+        if (IsRatioFitted(vec[i], model, range_in_RMS)) continue;
+
+        todo.push_back(i);
+        funs.push_back(CreateRatioFunction(vec[i], model, range_in_RMS, i < nsize / 2));
     }
 
+    std::vector<int> status(todo.size(), 1);
+
+    ParallelFor(todo.size(), [&](int t) { status[t] = FitRatio(vec[todo[t]], funs[t]); });
+
+    for (size_t t = 0; t < todo.size(); t++)
+    {
+        if (!status[t])
+            std::cout << "##### Warning in SFTools::RatiosFit()! Fit of histogram "
+                      << vec[todo[t]]->GetName() << " failed!" << std::endl;
+
+        // like TH1::Fit() with option "+", function is added to the histogram
+        vec[todo[t]]->GetListOfFunctions()->Add(funs[t]);
+    }
+
+    for (int i = 0; i < nsize; i++)
+        PrintRatioFit(vec[i], model);
+
     return true;
 }
+//------------------------------------------------------------------
+/// Sets number of threads used for processing of independent measurements
+/// of the series, e.g. in SFData::GetSpectra(). Default is 1, i.e. all
+/// measurements are processed sequentially. If 0 is passed, number of
+/// hardware threads is used. ROOT thread safety is enabled when more than
+/// one thread is requested.
+/// \param nthreads - number of threads
+void SFTools::SetNThreads(int nthreads)
+{
+    if (nthreads < 0)
+    {
+        std::cout << "##### Warning in SFTools::SetNThreads()! Negative number of threads: "
+                  << nthreads << ". Using 1 thread." << std::endl;
+        nthreads = 1;
+    }
+
+    if (nthreads == 0) nthreads = std::max(1u, std::thread::hardware_concurrency());
+
+    if (nthreads > 1) ROOT::EnableThreadSafety();
+
+    gNThreads = nthreads;
+}
+//------------------------------------------------------------------
+/// Returns number of threads used for processing of independent measurements.
+int SFTools::GetNThreads(void)
+{
+    return gNThreads;
+}
+//------------------------------------------------------------------
+/// Calls given function for all indices 0, 1, ..., n-1. Indices are
+/// distributed dynamically between SFTools::GetNThreads() threads, so that
+/// threads which finished their task take the next one. Function has to be
+/// safe to call concurrently for different indices. If only one thread is
+/// used, function is called sequentially in the calling thread.
+/// \param n - number of tasks
+/// \param fun - function to be called for each task index
+void SFTools::ParallelFor(int n, std::function<void(int)> fun)
+{
+    int nthreads = std::min(gNThreads, n);
+
+    if (nthreads <= 1)
+    {
+        for (int i = 0; i < n; i++)
+            fun(i);
+        return;
+    }
+
+    std::atomic<int>         next(0);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < nthreads; t++)
+    {
+        workers.emplace_back([&]() {
+            for (int i = next++; i < n; i = next++)
+                fun(i);
+        });
+    }
+
+    for (auto& w : workers)
+        w.join();
+}
+//------------------------------------------------------------------
+/// Solves the system of linear equations m * x = b with Gaussian
+/// elimination. Returns false if the matrix is singular.
+/// \param m - n x n matrix stored by rows (overwritten)
+/// \param b - right hand side, overwritten with the solution
+/// \param n - size of the system
+bool SFTools::SolveLinear(std::vector<double> m, std::vector<double>& b, int n)
+{
+    for (int c = 0; c < n; c++)
+    {
+        int pivot = c;
+        for (int r = c + 1; r < n; r++)
+            if (fabs(m[r * n + c]) > fabs(m[pivot * n + c])) pivot = r;
+
+        if (fabs(m[pivot * n + c]) < 1E-300) return false;
+
+        if (pivot != c)
+        {
+            for (int k = 0; k < n; k++)
+                std::swap(m[c * n + k], m[pivot * n + k]);
+            std::swap(b[c], b[pivot]);
+        }
+
+        for (int r = c + 1; r < n; r++)
+        {
+            double f = m[r * n + c] / m[c * n + c];
+            for (int k = c; k < n; k++)
+                m[r * n + k] -= f * m[c * n + k];
+            b[r] -= f * b[c];
+        }
+    }
+
+    for (int r = n - 1; r >= 0; r--)
+    {
+        for (int k = r + 1; k < n; k++)
+            b[r] -= m[r * n + k] * b[k];
+        b[r] /= m[r * n + r];
+    }
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Restricts reading of the tree to the given branches. All sub-branches
+/// of the objects stored in categories (branches "*.data.*", e.g. fields of
+/// SDDSamples) are switched off, except for the requested ones. Remaining
+/// branches, e.g. headers of the categories, are read as before. TTreeCache
+/// is enlarged and learns only from the first entries, so that the enabled
+/// branches are read in large blocks. If any of the requested branches
+/// doesn't exist the tree is left unchanged and false is returned.
+/// \param tree - tree or chain to be read
+/// \param branches - full names of the branches to be read, e.g.
+/// "SDDSamples.data.signal_l.fPE"
+bool SFTools::SelectBranches(TTree* tree, const std::vector<TString>& branches)
+{
+    if (tree == nullptr) return false;
+
+    for (auto& bname : branches)
+    {
+        if (tree->GetBranch(bname) == nullptr)
+        {
+            std::cerr << "##### Error in SFTools::SelectBranches()! Branch " << bname
+                      << " not found in " << tree->GetName() << std::endl;
+            return false;
+        }
+    }
+
+    tree->SetBranchStatus("*.data.*", false);
+
+    for (auto& bname : branches)
+        tree->SetBranchStatus(bname, true);
+
+    tree->SetCacheSize(gTreeCacheSize);
+    tree->SetCacheLearnEntries(gTreeCacheLearnEntries);
+
+    return true;
+}
+//------------------------------------------------------------------
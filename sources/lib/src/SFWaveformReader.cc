@@ -0,0 +1,152 @@
+// *****************************************
+// *                                       *
+// *          ScintillatingFibers          *
+// *          SFWaveformReader.cc          *
+// *          Katarzyna Rusiecka           *
+// * katarzyna.rusiecka@doctoral.uj.edu.pl *
+// *          Created in 2021              *
+// *                                       *
+// *****************************************
+
+#include "SFWaveformReader.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+ClassImp(SFWaveformReader);
+
+//------------------------------------------------------------------
+/// Standard constructor. Opens and maps the binary file.
+/// \param fname - name of the binary file
+/// \param samples - number of samples per event
+SFWaveformReader::SFWaveformReader(TString fname, int samples) : fFileName(fname),
+                                                                 fSamples(samples),
+                                                                 fEvents(0),
+                                                                 fFD(-1),
+                                                                 fMap(nullptr),
+                                                                 fMapSize(0),
+                                                                 fData(nullptr)
+{
+    if (fSamples <= 0 || !Open())
+    {
+        std::cerr << "##### Error in SFWaveformReader constructor! Cannot open binary file!"
+                  << std::endl;
+        std::cerr << fFileName << std::endl;
+        throw "##### Exception in SFWaveformReader constructor!";
+    }
+}
+//------------------------------------------------------------------
+/// Default destructor. Unmaps and closes the file.
+SFWaveformReader::~SFWaveformReader()
+{
+    Close();
+}
+//------------------------------------------------------------------
+/// Opens the binary file. The file is memory-mapped if possible,
+/// otherwise it is read into the buffer with a single block read.
+bool SFWaveformReader::Open(void)
+{
+    fFD = open(fFileName.Data(), O_RDONLY);
+
+    if (fFD < 0) return false;
+
+    struct stat st;
+    if (fstat(fFD, &st) != 0)
+    {
+        Close();
+        return false;
+    }
+
+    size_t fsize = st.st_size;
+    size_t esize = sizeof(float) * fSamples;
+    fEvents      = fsize / esize;
+
+    if (fsize % esize != 0)
+    {
+        std::cout << "##### Warning in SFWaveformReader::Open()! File size is not a multiple "
+                  << "of the event size. Last " << fsize % esize << " bytes will be ignored."
+                  << std::endl;
+    }
+
+    if (fEvents == 0) return true;
+
+    fMapSize = fEvents * esize;
+    fMap     = mmap(nullptr, fMapSize, PROT_READ, MAP_PRIVATE, fFD, 0);
+
+    if (fMap != MAP_FAILED)
+    {
+        madvise(fMap, fMapSize, MADV_SEQUENTIAL);
+        fData = static_cast<const float*>(fMap);
+        return true;
+    }
+
+    //----- mapping failed, reading whole file at once
+    fMap = nullptr;
+    fBuffer.resize(fMapSize / sizeof(float));
+
+    char*  dest  = reinterpret_cast<char*>(fBuffer.data());
+    size_t nread = 0;
+
+    while (nread < fMapSize)
+    {
+        ssize_t n = read(fFD, dest + nread, fMapSize - nread);
+        if (n <= 0)
+        {
+            Close();
+            return false;
+        }
+        nread += n;
+    }
+
+    close(fFD);
+    fFD   = -1;
+    fData = fBuffer.data();
+
+    return true;
+}
+//------------------------------------------------------------------
+/// Unmaps and closes the file, releases the buffer.
+void SFWaveformReader::Close(void)
+{
+    if (fMap != nullptr) munmap(fMap, fMapSize);
+    if (fFD >= 0) close(fFD);
+
+    fMap     = nullptr;
+    fMapSize = 0;
+    fFD      = -1;
+    fData    = nullptr;
+    fEvents  = 0;
+    std::vector<float>().swap(fBuffer);
+}
+//------------------------------------------------------------------
+/// Returns pointer to the samples of requested event. Number of
+/// available samples is equal to GetNsamples(). If the event number
+/// is out of range nullptr is returned.
+/// \param event - event number
+const float* SFWaveformReader::GetEvent(int event)
+{
+    if (event < 0 || event >= fEvents)
+    {
+        std::cerr << "##### Error in SFWaveformReader::GetEvent()! Event " << event
+                  << " out of range!" << std::endl;
+        std::cerr << "Number of events in " << fFileName << ": " << fEvents << std::endl;
+        return nullptr;
+    }
+
+    return fData + static_cast<size_t>(event) * fSamples;
+}
+//------------------------------------------------------------------
+/// Prints details of the SFWaveformReader class object.
+void SFWaveformReader::Print(void)
+{
+    std::cout << "\n-------------------------------------------" << std::endl;
+    std::cout << "This is print out of SFWaveformReader class object" << std::endl;
+    std::cout << "File: " << fFileName << std::endl;
+    std::cout << "Samples per event: " << fSamples << std::endl;
+    std::cout << "Number of events: " << fEvents << std::endl;
+    std::cout << "Memory-mapped: " << (IsMapped() ? "yes" : "no") << std::endl;
+    std::cout << "-------------------------------------------\n" << std::endl;
+}
+//------------------------------------------------------------------